@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "cowel/util/code_point_names.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/strings.hpp"
 #include "cowel/util/to_chars.hpp"
 #include "cowel/util/transparent_comparison.hpp"
@@ -111,8 +112,20 @@ struct Document {
     /// True when this is a disk-loaded document transiently inserted into `open_docs`
     /// for a validation run; such entries are erased when the run completes.
     bool transient = false;
+    /// The line table of `content`, built on demand by `get_line_table`.
+    std::optional<Line_Table> lines {};
 };
 
+/// @brief Returns the line table of `doc`, building it on first use.
+[[nodiscard]]
+const Line_Table& get_line_table(Document& doc)
+{
+    if (!doc.lines) {
+        doc.lines.emplace(doc.content, std::pmr::get_default_resource());
+    }
+    return *doc.lines;
+}
+
 /// @brief All mutable server state bundled to avoid scattered globals.
 struct Server_State {
 private:
@@ -254,24 +267,39 @@ public:
         shutdown_requested = true;
     }
 
-    /// @brief Converts a UTF-8 byte-offset column to an LSP `character` value.
-    /// @param line_start_byte is the byte offset of the first byte of the line
-    /// (i.e. `loc.begin - loc.column`).
-    /// Uses `use_utf8_positions` to decide whether to return the byte offset unchanged
-    /// or convert it to a UTF-16 code-unit count.
+    /// @brief Converts a byte offset in `bytes` to an LSP `Position`.
+    /// Offsets past the end of `bytes` are clamped.
+    /// Uses `use_utf8_positions` to decide whether `character` is a byte offset
+    /// or a UTF-16 code-unit count.
+    /// @param lines The line table of `bytes`.
     [[nodiscard]]
-    std::size_t column_to_character(
+    lsp::Position offset_to_position(
         const std::u8string_view bytes,
-        const std::size_t line_start_byte,
-        const std::size_t utf8_column
+        const Line_Table& lines,
+        const std::size_t offset
     ) const
     {
-        if (use_utf8_positions) {
-            return utf8_column;
-        }
-        const std::size_t safe_start = std::min(line_start_byte, bytes.size());
-        const std::size_t safe_end = std::min(line_start_byte + utf8_column, bytes.size());
-        return unchecked_utf8_to_utf16_length(bytes.substr(safe_start, safe_end - safe_start));
+        const std::size_t safe_offset = std::min(offset, bytes.size());
+        const std::size_t line = lines.line_at(safe_offset);
+        return {
+            .line = line,
+            .character = use_utf8_positions ? safe_offset - lines.line_start(line)
+                                            : lines.utf16_column_at(bytes, safe_offset),
+        };
+    }
+
+    /// @brief Converts an LSP `Position` to a byte offset in `bytes`.
+    /// Respects the negotiated position encoding (UTF-8 bytes or UTF-16 code units).
+    /// @param lines The line table of `bytes`.
+    [[nodiscard]]
+    std::size_t position_to_offset(
+        const std::u8string_view bytes,
+        const Line_Table& lines,
+        const lsp::Position pos
+    ) const
+    {
+        return use_utf8_positions ? lines.offset_at(pos.line, pos.character)
+                                  : lines.offset_at_utf16(bytes, pos.line, pos.character);
     }
 };
 
@@ -525,35 +553,6 @@ std::optional<lsp::Diagnostic_Severity> cowel_severity_to_lsp_severity(const cow
     return {};
 }
 
-/// @brief Computes the LSP end position by scanning `loc.length` bytes
-/// starting at `loc.begin` in @p bytes, counting newlines
-/// and converting to UTF-8 or UTF-16 code units according to the server's position encoding.
-[[nodiscard]]
-lsp::Position compute_end_position(const std::u8string_view bytes, const Diagnostic_Location& loc)
-{
-    const std::size_t from = std::min(loc.begin, bytes.size());
-    const std::size_t to = std::min(loc.begin + loc.length, bytes.size());
-    const std::size_t line_start_byte = (from >= loc.column) ? from - loc.column : 0;
-    lsp::Position result {
-        loc.line,
-        server_state.column_to_character(bytes, line_start_byte, loc.column),
-    };
-    for (std::size_t i = from; i < to; ++i) {
-        if (bytes[i] == u8'\n') {
-            ++result.line;
-            result.character = 0;
-        }
-        else if (server_state.uses_utf8_positions()) {
-            ++result.character;
-        }
-        else if ((bytes[i] & 0xC0u) != 0x80u) {
-            // Leading byte: count as 1 unit for BMP, 2 for supplementary planes.
-            result.character += (bytes[i] >= char8_t { 0xF0u }) ? 2u : 1u;
-        }
-    }
-    return result;
-}
-
 /// @brief Result of a single `validate_document` call.
 struct Validate_Result {
     /// Diagnostics grouped by document URI.
@@ -600,10 +599,43 @@ Validate_Result validate_document(
         .highlighter = nullptr,
         .highlight_policy = COWEL_SYNTAX_HIGHLIGHT_POLICY_FALL_BACK,
         .preamble = {},
+        .load_cache = nullptr,
+        .load_cache_data = nullptr,
+        .store_cache = nullptr,
+        .store_cache_data = nullptr,
+        .max_call_depth = 0,
+        .write = nullptr,
+        .write_data = nullptr,
+        .write_slices = nullptr,
+        .write_slices_data = nullptr,
     };
 
     cowel_gen_result_u8 gen_result = cowel_generate_html_u8(&opts);
 
+    // Line tables are only built for files that actually have hovers or diagnostics.
+    // Included documents cache their table, so repeated validations reuse it.
+    std::optional<Line_Table> main_lines;
+    const auto range_in_file
+        = [&](const int file_id, const std::size_t begin, const std::size_t length) -> lsp::Range {
+        std::u8string_view bytes = content;
+        const Line_Table* lines = nullptr;
+        if (file_id >= 0 && std::size_t(file_id) < validation_context.includes.size()) {
+            Document& include = *validation_context.includes[std::size_t(file_id)];
+            bytes = include.content;
+            lines = &get_line_table(include);
+        }
+        else {
+            if (!main_lines) {
+                main_lines.emplace(content, std::pmr::get_default_resource());
+            }
+            lines = &*main_lines;
+        }
+        return {
+            server_state.offset_to_position(bytes, *lines, begin),
+            server_state.offset_to_position(bytes, *lines, begin + length),
+        };
+    };
+
     // Collect hover entries and map them by file URI using file_id.
     {
         String_Map<std::vector<Hover_Entry>> hover_by_uri;
@@ -613,30 +645,13 @@ Validate_Result validate_document(
 
                 // Determine which file this hover belongs to.
                 std::u8string hover_uri { uri };
-                std::u8string_view hover_bytes = content;
-
                 if (h.file_id >= 0 && std::size_t(h.file_id) < validation_context.includes.size()) {
-                    const Document* const include
-                        = validation_context.includes[std::size_t(h.file_id)];
-                    hover_uri = include->uri;
-                    hover_bytes = include->content;
+                    hover_uri = validation_context.includes[std::size_t(h.file_id)]->uri;
                 }
 
-                const std::size_t line_start_byte = h.begin - h.column;
-                const lsp::Position start_pos {
-                    .line = h.line,
-                    .character
-                    = server_state.column_to_character(hover_bytes, line_start_byte, h.column),
-                };
-                const lsp::Position end_pos {
-                    .line = h.line,
-                    .character = server_state.column_to_character(
-                        hover_bytes, line_start_byte, h.column + h.length
-                    ),
-                };
                 hover_by_uri[hover_uri].push_back(
                     {
-                        .range = { start_pos, end_pos },
+                        .range = range_in_file(h.file_id, h.begin, h.length),
                         .article = { h.article, h.article_length },
                     }
                 );
@@ -681,7 +696,6 @@ Validate_Result validate_document(
 
         // Determine which document this diagnostic belongs to.
         std::u8string diagnostic_uri { uri };
-        std::u8string_view diagnostic_bytes = content;
 
         if (!diagnostic.stack.empty()) {
             const auto& primary = diagnostic.stack[0];
@@ -690,7 +704,6 @@ Validate_Result validate_document(
                 const Document* const include
                     = validation_context.includes[std::size_t(primary.file_id)];
                 diagnostic_uri = include->uri;
-                diagnostic_bytes = include->content;
             }
             else if (!primary.file_name.empty()) {
                 diagnostic_uri = primary.file_name.starts_with(u8"file://"sv)
@@ -699,21 +712,11 @@ Validate_Result validate_document(
             }
         }
 
-        const auto range = [&] -> lsp::Range {
-            lsp::Position start_pos {};
-            lsp::Position end_pos {};
-            if (!diagnostic.stack.empty()) {
-                const auto& loc = diagnostic.stack[0];
-                const std::size_t line_start_byte
-                    = (loc.begin >= loc.column) ? loc.begin - loc.column : 0;
-                start_pos.line = loc.line;
-                start_pos.character = server_state.column_to_character(
-                    diagnostic_bytes, line_start_byte, loc.column
-                );
-                end_pos = compute_end_position(diagnostic_bytes, loc);
-            }
-            return { start_pos, end_pos };
-        }();
+        const lsp::Range range = diagnostic.stack.empty()
+            ? lsp::Range {}
+            : range_in_file(
+                  diagnostic.stack[0].file_id, diagnostic.stack[0].begin, diagnostic.stack[0].length
+              );
 
         const lsp::Diagnostic lsp_diagnostic {
             .range = range,
@@ -1028,31 +1031,6 @@ void revalidate_from(const std::u8string_view uri, Request_Context& context)
     }
 }
 
-/// @brief Converts an LSP `Position` to a byte offset in `text`.
-/// Respects the server's negotiated position encoding
-/// (UTF-8 bytes or UTF-16 code units).
-[[nodiscard]]
-std::size_t lsp_position_to_byte_offset(const std::u8string_view text, const lsp::Position pos)
-{
-    // Walk to the start of the target line.
-    std::size_t i = 0;
-    for (std::size_t line = 0; line < pos.line && i < text.size(); ++i) {
-        if (text[i] == u8'\n') {
-            ++line;
-        }
-    }
-
-    if (server_state.uses_utf8_positions()) {
-        return std::min(i + pos.character, text.size());
-    }
-    // UTF-16 mode: limit the search to the current line, then convert.
-    std::size_t line_end = i;
-    while (line_end < text.size() && text[line_end] != u8'\n') {
-        ++line_end;
-    }
-    return i + unchecked_utf16_offset_to_utf8_offset(text.substr(i, line_end - i), pos.character);
-}
-
 /// @brief Looks backward from `cursor_byte` in `text` for a named code-point
 /// escape prefix of the form `\'<NAME>`.
 /// @returns The typed prefix (text between `\'` and `cursor_byte`),
@@ -1113,7 +1091,7 @@ void handle_completion(
     static constexpr std::size_t max_name_length = 96;
 
     const std::u8string_view uri = params.text_document.uri;
-    const Document* const doc = server_state.find_open_document(uri);
+    Document* const doc = server_state.find_open_document(uri);
     if (doc == nullptr) {
         write_message(
             lsp::Response_Message {
@@ -1125,7 +1103,8 @@ void handle_completion(
         return;
     }
 
-    const std::size_t cursor_byte = lsp_position_to_byte_offset(doc->content, params.position);
+    const std::size_t cursor_byte
+        = server_state.position_to_offset(doc->content, get_line_table(*doc), params.position);
     const std::optional<std::u8string_view> prefix
         = extract_named_escape_prefix(doc->content, cursor_byte);
     if (!prefix) {
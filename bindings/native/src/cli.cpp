@@ -8,11 +8,13 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "cowel/util/annotated_string.hpp"
 #include "cowel/util/ansi.hpp"
 #include "cowel/util/function_ref.hpp"
 #include "cowel/util/io.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/meta.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
@@ -21,6 +23,7 @@
 #include "cowel/assets.hpp"
 #include "cowel/cowel.h"
 #include "cowel/cowel_lib.hpp"
+#include "cowel/directory_ast_cache.hpp"
 #include "cowel/fwd.hpp"
 #include "cowel/memory_resources.hpp"
 #include "cowel/print.hpp"
@@ -73,6 +76,9 @@ struct Stderr_Logger {
     const Relative_File_Loader& file_loader;
     const std::u8string_view main_file_name;
     const std::u8string_view main_file_source;
+    /// @brief The line table of the main file,
+    /// which is only built once a diagnostic in that file is printed.
+    std::optional<Line_Table> main_file_lines;
     Diagnostic_String out;
     bool any_errors = false;
     bool colors_enabled = true;
@@ -117,6 +123,20 @@ struct Stderr_Logger {
             };
         };
 
+        const auto get_line_table
+            = [&](const cowel_diagnostic_location_u8& location) -> const Line_Table& {
+            if (location.file_id >= 0) {
+                const Line_Table* const result
+                    = file_loader.find_line_table(File_Id(location.file_id));
+                COWEL_ASSERT(result);
+                return *result;
+            }
+            if (!main_file_lines) {
+                main_file_lines.emplace(main_file_source, out.get_memory());
+            }
+            return *main_file_lines;
+        };
+
         const cowel_diagnostic_location_u8* const stack = diagnostic.stack;
         const std::size_t stack_size = diagnostic.stack_size;
         const bool has_primary = stack_size != 0;
@@ -157,7 +177,9 @@ struct Stderr_Logger {
         }
         out.append(u8'\n');
         if (has_primary && stack[0].length != 0) {
-            print_affected_line(out, primary_file_entry.source, *primary_location);
+            print_affected_line(
+                out, primary_file_entry.source, get_line_table(stack[0]), *primary_location
+            );
         }
 
         for (std::size_t i = 1; i < stack_size; ++i) {
@@ -181,7 +203,9 @@ struct Stderr_Logger {
             }
             out.append(u8" Expanded from here.\n");
             if (stack_location.length != 0) {
-                print_affected_line(out, stack_file_entry.source, stack_span);
+                print_affected_line(
+                    out, stack_file_entry.source, get_line_table(stack_location), stack_span
+                );
             }
         }
 
@@ -207,6 +231,7 @@ Options:
                                        warning, error, fatal, none
                               Default: info
       --no-color              Disable colored output
+      --ast-cache <directory> Cache parsed documents in the given directory (run only)
 )";
 
 constexpr std::string_view version_text = "11.0.0-pre\n";
@@ -274,14 +299,50 @@ int run_run_command(
         load_file_ref,
     Stderr_Logger& logger,
     const Function_Ref<void(const cowel_diagnostic_u8*) noexcept> log_ref,
-    const cowel_severity min_log_severity
+    const cowel_severity min_log_severity,
+    Directory_AST_Cache* const ast_cache
 )
 {
+    const auto load_cache_ref = ast_cache
+        ? ast_cache->as_cowel_load_cache_fn()
+        : Function_Ref<cowel_cache_entry(cowel_string_view_u8) noexcept> {};
+    const auto store_cache_ref = ast_cache
+        ? ast_cache->as_cowel_store_cache_fn()
+        : Function_Ref<void(cowel_string_view_u8, cowel_cache_entry) noexcept> {};
+
+    const std::string out_path = std::string(as_string_view(out_path_u8));
+    auto out_file = fopen_unique(out_path.c_str(), "wb");
+    if (!out_file) {
+        log_cli_diagnostic(
+            log_ref, COWEL_SEVERITY_FATAL, u8"Failed to open output file.", u8"run", out_path_u8
+        );
+        return EXIT_FAILURE;
+    }
+
+    // The output is obtained as slices of the buffers that sections were generated into,
+    // and written to the file all at once with gather I/O,
+    // rather than assembling the whole document in memory first.
+    bool any_write_failed = false;
+    const auto write_slices
+        = [&](const cowel_string_view_u8* const slices, const std::size_t slices_size) noexcept {
+              std::vector<std::u8string_view> pieces;
+              pieces.reserve(slices_size);
+              for (std::size_t i = 0; i < slices_size; ++i) {
+                  pieces.emplace_back(slices[i].text, slices[i].length);
+              }
+              if (!write_gathered(out_file.get(), pieces)) {
+                  any_write_failed = true;
+              }
+          };
+    const Function_Ref<void(const cowel_string_view_u8*, std::size_t) noexcept> write_slices_ref
+        = write_slices;
+
     const cowel_options_u8 options {
         .source = as_cowel_string_view(in_source),
         .highlight_theme_json = as_cowel_string_view(assets::wg21_json),
         .mode = COWEL_MODE_DOCUMENT,
-        .flags = 0,
+        // The CLI generates a single document, so all ASTs can be freed wholesale at the end.
+        .flags = COWEL_GEN_FLAGS_AST_ARENA | COWEL_GEN_FLAGS_FOLD_CONSTANTS,
         .min_log_severity = min_log_severity,
         .preserved_variables = nullptr,
         .preserved_variables_size = 0,
@@ -298,12 +359,25 @@ int run_run_command(
         .highlighter = nullptr,
         .highlight_policy = COWEL_SYNTAX_HIGHLIGHT_POLICY_FALL_BACK,
         .preamble = {},
+        .load_cache = load_cache_ref.get_invoker(),
+        .load_cache_data = load_cache_ref.get_entity(),
+        .store_cache = store_cache_ref.get_invoker(),
+        .store_cache_data = store_cache_ref.get_entity(),
+        .max_call_depth = 0,
+        .write = nullptr,
+        .write_data = nullptr,
+        .write_slices = write_slices_ref.get_invoker(),
+        .write_slices_data = write_slices_ref.get_entity(),
     };
 
     cowel_gen_result_u8 result = cowel_generate_html_u8(&options);
+    cowel_free_gen_result_u8(&options, &result);
 
     if (result.status != COWEL_PROCESSING_OK) {
-        cowel_free_gen_result_u8(&options, &result);
+        // Parts of the document may already have been written,
+        // but a partial document is not a useful output.
+        std::fclose(out_file.release());
+        std::remove(out_path.c_str());
 
         const auto status_name = processing_status_name(result.status);
         std::string status_message = "Generation exited with status ";
@@ -316,21 +390,13 @@ int run_run_command(
         return EXIT_FAILURE;
     }
 
-    const std::string out_path = std::string(as_string_view(out_path_u8));
-    const auto out_file = fopen_unique(out_path.c_str(), "wb");
-    if (!out_file) {
-        cowel_free_gen_result_u8(&options, &result);
+    if (any_write_failed) {
         log_cli_diagnostic(
-            log_ref, COWEL_SEVERITY_FATAL, u8"Failed to open output file.", u8"run", out_path_u8
+            log_ref, COWEL_SEVERITY_FATAL, u8"Failed to write output file.", u8"run", out_path_u8
         );
         return EXIT_FAILURE;
     }
 
-    if (result.output.text != nullptr) {
-        std::fwrite(result.output.text, 1, result.output.length, out_file.get());
-    }
-    cowel_free_gen_result_u8(&options, &result);
-
     return logger.any_errors ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
@@ -537,9 +603,15 @@ int main(int argc, const char* const* const argv)
         COWEL_ASSERT_UNREACHABLE(u8"Simple commands should have been handled above.");
     }
     case COWEL_CLI_COMMAND_RUN: {
+        const auto ast_cache_path_u8 = as_u8string_view(opts.ast_cache);
+        std::optional<Directory_AST_Cache> ast_cache;
+        if (!ast_cache_path_u8.empty()) {
+            ast_cache.emplace(std::filesystem::path { ast_cache_path_u8 }, &memory);
+        }
         return run_run_command(
             in_source, in_path_u8, out_path_u8, //
-            alloc_options, load_file_ref, logger, log_ref, opts.min_severity
+            alloc_options, load_file_ref, logger, log_ref, opts.min_severity,
+            ast_cache ? &*ast_cache : nullptr
         );
     }
     case COWEL_CLI_COMMAND_TOKENIZE: {
@@ -161,6 +161,15 @@ void init_options(
         .highlighter = highlighter,
         .highlight_policy = highlight_policy,
         .preamble = preamble,
+        .load_cache = nullptr,
+        .load_cache_data = nullptr,
+        .store_cache = nullptr,
+        .store_cache_data = nullptr,
+        .max_call_depth = 0,
+        .write = nullptr,
+        .write_data = nullptr,
+        .write_slices = nullptr,
+        .write_slices_data = nullptr,
     };
 }
 
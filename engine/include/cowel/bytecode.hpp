@@ -0,0 +1,121 @@
+#ifndef COWEL_BYTECODE_HPP
+#define COWEL_BYTECODE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "cowel/util/result.hpp"
+#include "cowel/util/source_position.hpp"
+
+#include "cowel/content_status.hpp"
+#include "cowel/fwd.hpp"
+#include "cowel/type.hpp"
+#include "cowel/value.hpp"
+
+#include "cowel/syntax/ast_fwd.hpp"
+#include "cowel/syntax/expression_kind.hpp"
+
+namespace cowel {
+
+enum struct Opcode : Default_Underlying {
+    /// @brief Pushes `constants[index]`.
+    push_constant,
+    /// @brief Evaluates `primaries[index]` (e.g. an *id-expression*) and pushes its value.
+    evaluate_primary,
+    /// @brief Evaluates `directives[index]` and pushes its value.
+    evaluate_directive,
+    /// @brief Pops the operand and pushes the result of `unary_operations[index]`.
+    unary,
+    /// @brief Pops the right and the left operand,
+    /// and pushes the result of `binary_operations[index]`.
+    binary,
+    /// @brief Checks that the left operand of `logical_operations[index]`,
+    /// which is on top of the stack, is a `bool`.
+    /// If it equals the terminator of the operation, jumps to the end of the operation,
+    /// leaving the operand on the stack as the result.
+    /// Otherwise, pops the operand.
+    logical_lhs,
+    /// @brief Checks that the right operand of `logical_operations[index]`,
+    /// which is on top of the stack and becomes the result of the operation, is a `bool`.
+    logical_rhs,
+};
+
+struct Bytecode_Instruction {
+    Opcode opcode;
+    /// @brief The index into the table of the `Bytecode_Program` which belongs to `opcode`.
+    std::uint32_t index;
+};
+
+struct Unary_Operation {
+    Unary_Expression_Kind kind;
+    File_Source_Span location;
+};
+
+struct Binary_Operation {
+    /// @brief The dynamically typed operation, such as `plus_dynamic`.
+    Builtin_Operation_Kind kind;
+    File_Source_Span lhs_location;
+    File_Source_Span rhs_location;
+
+    /// @brief The operand types that `resolved_kind` was last resolved for.
+    /// This allows the type check to be skipped when the operation is executed repeatedly
+    /// with the same types of operands, which is the common case.
+    mutable Type_Kind resolved_lhs_type = Type_Kind::nothing;
+    mutable Type_Kind resolved_rhs_type = Type_Kind::nothing;
+    /// @brief The statically typed operation, such as `plus_int_int`.
+    mutable Builtin_Operation_Kind resolved_kind {};
+};
+
+struct Logical_Operation {
+    /// @brief `true` for `||`, `false` for `&&`.
+    bool terminator;
+    File_Source_Span location;
+    /// @brief The index of the first instruction after the operation.
+    std::uint32_t end;
+};
+
+/// @brief An expression compiled into instructions for a stack machine.
+/// Directives and *primary-expression*s whose values are not known in advance
+/// are referenced within the AST,
+/// so a program is only valid while the AST it was compiled from is alive.
+struct Bytecode_Program {
+    std::pmr::vector<Bytecode_Instruction> code;
+    std::pmr::vector<Value> constants;
+    std::pmr::vector<const ast::Primary*> primaries;
+    std::pmr::vector<const ast::Directive*> directives;
+    std::pmr::vector<Unary_Operation> unary_operations;
+    std::pmr::vector<Binary_Operation> binary_operations;
+    std::pmr::vector<Logical_Operation> logical_operations;
+    /// @brief The greatest amount of values on the stack during execution.
+    std::size_t max_stack_size = 0;
+
+    [[nodiscard]]
+    explicit Bytecode_Program(std::pmr::memory_resource* memory)
+        : code { memory }
+        , constants { memory }
+        , primaries { memory }
+        , directives { memory }
+        , unary_operations { memory }
+        , binary_operations { memory }
+        , logical_operations { memory }
+    {
+    }
+};
+
+/// @brief Compiles `expression` into `out`.
+/// The result of executing `out` is the same as that of `evaluate_expression(expression, ...)`,
+/// including any diagnostics.
+void compile_bytecode(Bytecode_Program& out, const ast::Expression& expression);
+
+/// @brief Executes `program`,
+/// where directives and primaries referenced by the program are evaluated in `frame`.
+[[nodiscard]]
+Result<Value, Processing_Status>
+execute_bytecode(const Bytecode_Program& program, Frame_Index frame, Context& context);
+
+} // namespace cowel
+
+#endif
@@ -8,9 +8,20 @@
 #include "cowel/directive_behavior.hpp"
 #include "cowel/fwd.hpp"
 #include "cowel/invocation.hpp"
+#include "cowel/stack_budget.hpp"
+
+#include "cowel/syntax/lex.hpp"
 
 namespace cowel {
 
+/// @brief The default maximum size of the `Call_Stack`,
+/// i.e. the default maximum depth of nested directive invocations.
+/// This is however many invocations at `stack_cost_per_call` fit into the part of
+/// `stack_budget` that is not reserved or taken up by `max_nesting_depth`.
+inline constexpr std::size_t default_max_call_depth
+    = (stack_budget - stack_budget_reserve - max_nesting_depth * stack_cost_per_nesting_level)
+    / stack_cost_per_call;
+
 struct Stack_Frame {
     const Directive_Behavior& behavior;
     const Invocation& invocation;
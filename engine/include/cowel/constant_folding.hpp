@@ -0,0 +1,40 @@
+#ifndef COWEL_CONSTANT_FOLDING_HPP
+#define COWEL_CONSTANT_FOLDING_HPP
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "cowel/fwd.hpp"
+#include "cowel/value.hpp"
+
+#include "cowel/syntax/ast_fwd.hpp"
+
+namespace cowel {
+
+/// @brief Returns the value of `primary` if it is a literal
+/// whose evaluation cannot emit diagnostics, otherwise `std::nullopt`.
+/// Quoted strings are only considered literals if they contain no directives or expressions.
+/// Their characters are stored in `buffer`, which the returned value refers to.
+[[nodiscard]]
+std::optional<Value> try_evaluate_literal(const ast::Primary& primary, std::pmr::u8string& buffer);
+
+/// @brief Replaces unary and binary expressions within `content`
+/// whose operands are literals (or are themselves foldable)
+/// with a single literal holding the result of the expression.
+/// Expressions are evaluated bottom-up, so `\(1 + 2 * 3)` becomes a single `int_literal`.
+///
+/// Only expressions whose evaluation cannot emit diagnostics are folded;
+/// e.g. `1 % 0` or `1 + true` are left intact so that the usual errors are reported
+/// when the expression is actually evaluated.
+/// Directive calls are never folded because the directive they refer to
+/// can be shadowed by aliases or macros defined during processing.
+/// The folded literals retain the source span and source of the original expression,
+/// so diagnostics and hover information still refer to the same locations.
+/// @returns The number of expressions that were replaced.
+std::size_t fold_constants(std::span<ast::Markup_Element> content, Context& context);
+
+} // namespace cowel
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef COWEL_CONTEXT_HPP
 #define COWEL_CONTEXT_HPP
 
+#include <cstddef>
 #include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -14,14 +17,19 @@
 #include "cowel/util/stringify.hpp"
 #include "cowel/util/transparent_comparison.hpp"
 
+#include "cowel/bytecode.hpp"
 #include "cowel/call_stack.hpp"
 #include "cowel/diagnostic.hpp"
 #include "cowel/directive_behavior.hpp"
+#include "cowel/directive_processing.hpp"
 #include "cowel/document_sections.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/services.hpp"
+#include "cowel/symbol.hpp"
 
 #include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/parse.hpp"
 
 namespace cowel {
 
@@ -39,22 +47,56 @@ struct Referred {
     std::u8string_view mask_html;
 };
 
+/// @brief The memoized output of an invocation of a pure macro.
+struct Macro_Expansion {
+    /// @brief The HTML output of the invocation.
+    Captured_HTML html;
+    /// @brief The paragraph split state of the output policy after the invocation.
+    /// This is only meaningful when the output policy is a `Paragraph_Split_Policy`.
+    Paragraph_Split_State split_state;
+};
+
 struct Macro_Definition final : Block_Directive_Behavior {
+public:
+    using Expansion_Map = std::pmr::unordered_map<
+        std::pmr::u8string,
+        Macro_Expansion,
+        Transparent_String_View_Hash8,
+        Transparent_String_View_Equals8>;
+
+    /// @brief The maximum number of expansions memoized for a single pure macro.
+    /// Invocations with distinct arguments beyond this limit are expanded each time,
+    /// which bounds the memory used by macros that are invoked with many different arguments.
+    static constexpr std::size_t max_memoized_expansions = 256;
+
 private:
     std::pmr::u8string m_name;
     std::pmr::u8string m_decl;
-    std::pmr::vector<ast::Markup_Element> m_body;
+    /// @brief The body of the macro, which is not owned,
+    /// but refers to the AST of the document that contains the definition.
+    /// The context ensures that this AST outlives the definition (see `Context::retain_document`).
+    std::span<const ast::Markup_Element> m_body;
+    /// @brief If `true`, the macro has been declared to be pure,
+    /// i.e. its output depends only on its arguments, and expanding it has no side effects.
+    bool m_pure;
+    /// @brief For pure macros, the previous expansions,
+    /// keyed by the invocation arguments and by the paragraph split state at the point of use.
+    /// At most `max_memoized_expansions` are stored.
+    mutable Expansion_Map m_expansions;
 
 public:
     [[nodiscard]]
     explicit Macro_Definition(
-        std::pmr::vector<ast::Markup_Element>&& body,
+        std::span<const ast::Markup_Element> body,
         std::pmr::u8string&& name,
-        std::pmr::u8string&& decl
+        std::pmr::u8string&& decl,
+        const bool pure = false
     )
         : m_name { std::move(name) }
         , m_decl { std::move(decl) }
-        , m_body { std::move(body) }
+        , m_body { body }
+        , m_pure { pure }
+        , m_expansions { m_name.get_allocator() }
     {
         set_tooltip_article(
             Tooltip_Article {
@@ -66,8 +108,18 @@ public:
         );
     }
 
+    [[nodiscard]]
+    bool is_pure() const noexcept
+    {
+        return m_pure;
+    }
+
     [[nodiscard]]
     Processing_Status splice(Content_Policy& out, const Invocation&, Context&) const final;
+
+private:
+    [[nodiscard]]
+    Processing_Status splice_memoized(Content_Policy& out, const Invocation&, Context&) const;
 };
 
 /// @brief A hover entry: source location and Markdown article text.
@@ -83,21 +135,9 @@ public:
     using string_type = std::pmr::u8string;
     using string_view_type = std::u8string_view;
 
-    using Variable_Map = std::pmr::unordered_map<
-        string_type,
-        Value,
-        Transparent_String_View_Hash8,
-        Transparent_String_View_Equals8>;
-    using Macro_Map = std::pmr::unordered_map<
-        std::pmr::u8string,
-        Macro_Definition,
-        Transparent_String_View_Hash8,
-        Transparent_String_View_Equals8>;
-    using Alias_Map = std::pmr::unordered_map<
-        std::pmr::u8string,
-        const Directive_Behavior*,
-        Transparent_String_View_Hash8,
-        Transparent_String_View_Equals8>;
+    using Variable_Map = std::pmr::unordered_map<Symbol, Value>;
+    using Macro_Map = std::pmr::unordered_map<Symbol, Macro_Definition>;
+    using Alias_Map = std::pmr::unordered_map<Symbol, const Directive_Behavior*>;
     using ID_Map = std::pmr::unordered_map<
         std::pmr::u8string,
         Referred,
@@ -139,16 +179,38 @@ private:
     std::pmr::memory_resource* m_transient_memory;
     /// @brief JSON source code of the syntax highlighting theme.
     string_view_type m_highlight_theme_source;
+    /// @brief The names of variables, macros, and aliases,
+    /// which are the keys of `m_variables`, `m_macros`, and `m_aliases`.
+    Symbol_Table m_symbols { m_memory };
     /// @brief Map of ids (as in, `id` attributes in HTML elements)
     /// to information about the reference.
     ID_Map m_id_references { m_transient_memory };
+    /// @brief The ASTs of loaded documents which must be kept alive
+    /// because macros defined in them refer to their content.
+    std::pmr::vector<ast::Pmr_Vector<ast::Markup_Element>> m_retained_documents {
+        m_transient_memory
+    };
     Alias_Map m_aliases { m_transient_memory };
     Macro_Map m_macros { m_transient_memory };
+    /// @brief Changes whenever `m_aliases` or `m_macros` change,
+    /// which invalidates the behaviors cached in `ast::Directive`s.
+    Definition_Epoch m_definition_epoch = make_definition_epoch();
+    /// @brief Identifies the bytecode owned by this context,
+    /// so that bytecode cached in `ast::Expression`s by other contexts is not used.
+    const Definition_Epoch m_bytecode_epoch = make_definition_epoch();
+    /// @brief Identifies the symbols interned by this context,
+    /// so that symbols cached in `ast::Primary`s by other contexts are not used.
+    const Definition_Epoch m_symbol_epoch = make_definition_epoch();
+    /// @brief The bytecode compiled for expressions during processing.
+    std::pmr::vector<GC_Ref<Bytecode_Program>> m_bytecode_programs { m_transient_memory };
+    /// @brief Buffers reused for lexing and parsing all included documents.
+    Parse_Buffers m_parse_buffers { m_transient_memory };
     const Directive_Behavior* m_error_behavior;
 
     const Name_Resolver& m_builtin_name_resolver;
     File_Loader& m_file_loader;
     Logger* m_logger;
+    std::size_t m_emitted_diagnostic_count = 0;
     Syntax_Highlighter& m_syntax_highlighter;
 
     Document_Sections m_sections { m_memory };
@@ -158,6 +220,10 @@ private:
     Small_Vector<Frame_Index, 8> m_active_diagnostic_frames;
     Small_Vector<File_Source_Span, 8> m_diagnostic_stack;
     std::pmr::vector<Hover_Entry>* m_hover_sink = nullptr;
+    GC_Arena* m_ast_arena = nullptr;
+    AST_Cache* m_ast_cache = nullptr;
+    bool m_fold_constants = false;
+    std::size_t m_max_call_depth = default_max_call_depth;
 
 public:
     /// @brief Constructs a new context.
@@ -263,18 +329,54 @@ public:
     }
 
     [[nodiscard]]
-    Value* get_variable(string_view_type key)
+    Symbol_Table& get_symbols()
+    {
+        return m_symbols;
+    }
+    [[nodiscard]]
+    const Symbol_Table& get_symbols() const
+    {
+        return m_symbols;
+    }
+
+    /// @brief Returns the symbol for `name`, interning it if necessary.
+    [[nodiscard]]
+    Symbol intern(string_view_type name)
+    {
+        return m_symbols.intern(name);
+    }
+
+    /// @brief Returns the symbol for the name of the *id-expression* `id`,
+    /// which is interned when it is first requested and cached within `id` afterwards.
+    [[nodiscard]]
+    Symbol intern(const ast::Primary& id);
+
+    [[nodiscard]]
+    Value* get_variable(Symbol key)
     {
         const auto it = m_variables.find(key);
         return it == m_variables.end() ? nullptr : &it->second;
     }
     [[nodiscard]]
-    const Value* get_variable(string_view_type key) const
+    const Value* get_variable(Symbol key) const
     {
         const auto it = m_variables.find(key);
         return it == m_variables.end() ? nullptr : &it->second;
     }
 
+    [[nodiscard]]
+    Value* get_variable(string_view_type key)
+    {
+        const std::optional<Symbol> symbol = m_symbols.find(key);
+        return symbol ? get_variable(*symbol) : nullptr;
+    }
+    [[nodiscard]]
+    const Value* get_variable(string_view_type key) const
+    {
+        const std::optional<Symbol> symbol = m_symbols.find(key);
+        return symbol ? get_variable(*symbol) : nullptr;
+    }
+
     [[nodiscard]]
     Document_Sections& get_sections()
     {
@@ -307,6 +409,76 @@ public:
         return m_transient_memory;
     }
 
+    /// @brief Returns buffers which should be used for lexing and parsing documents
+    /// loaded during processing, such as with `\cowel_include`.
+    /// Since parsing does not recurse into other documents,
+    /// the same buffers can be reused for every document.
+    [[nodiscard]]
+    Parse_Buffers& get_parse_buffers()
+    {
+        return m_parse_buffers;
+    }
+
+    /// @brief Sets the arena in which the ASTs of documents loaded during processing
+    /// are allocated.
+    /// The arena shall outlive this context.
+    void set_ast_arena(GC_Arena& arena) noexcept
+    {
+        m_ast_arena = &arena;
+    }
+
+    /// @brief Returns the arena in which the ASTs of documents loaded during processing
+    /// should be allocated,
+    /// or null if they should be allocated from the transient memory instead.
+    [[nodiscard]]
+    GC_Arena* get_ast_arena() const noexcept
+    {
+        return m_ast_arena;
+    }
+
+    /// @brief Sets the cache from which the ASTs of documents loaded during processing
+    /// are obtained when their source has not changed.
+    /// The cache shall outlive this context.
+    void set_ast_cache(AST_Cache& cache) noexcept
+    {
+        m_ast_cache = &cache;
+    }
+
+    /// @brief Returns the cache of ASTs of documents loaded during processing,
+    /// or null if there is none.
+    [[nodiscard]]
+    AST_Cache* get_ast_cache() const noexcept
+    {
+        return m_ast_cache;
+    }
+
+    /// @brief Sets whether constant expressions in documents loaded during processing
+    /// should be folded.
+    void set_fold_constants(bool fold) noexcept
+    {
+        m_fold_constants = fold;
+    }
+
+    [[nodiscard]]
+    bool get_fold_constants() const noexcept
+    {
+        return m_fold_constants;
+    }
+
+    /// @brief Sets the maximum size of the call stack.
+    /// Invoking a directive when the call stack has reached this size is a fatal error.
+    void set_max_call_depth(std::size_t depth) noexcept
+    {
+        COWEL_ASSERT(depth != 0);
+        m_max_call_depth = depth;
+    }
+
+    [[nodiscard]]
+    std::size_t get_max_call_depth() const noexcept
+    {
+        return m_max_call_depth;
+    }
+
     /// @brief Sets the sink into which hover entries are pushed during processing.
     /// Only used when `collect_hovers` is true in the generation options.
     void set_hover_sink(std::pmr::vector<Hover_Entry>& sink) noexcept
@@ -362,6 +534,16 @@ public:
         COWEL_ASSERT(emits(diagnostic.severity));
         diagnostic.stack = collect_diagnostic_stack();
         (*m_logger)(diagnostic);
+        ++m_emitted_diagnostic_count;
+    }
+
+    /// @brief Returns the number of diagnostics emitted so far.
+    /// By comparing this number before and after some processing,
+    /// it can be determined whether that processing emitted any diagnostics.
+    [[nodiscard]]
+    std::size_t get_emitted_diagnostic_count() const noexcept
+    {
+        return m_emitted_diagnostic_count;
     }
 
     void emit(
@@ -581,6 +763,24 @@ public:
     [[nodiscard]]
     const Directive_Behavior* find_directive(string_view_type name);
 
+    /// @brief Equivalent to `find_directive(directive.get_name())`,
+    /// but reuses the result of a previous lookup for the same `directive`
+    /// if no macros or aliases have been defined since.
+    [[nodiscard]]
+    const Directive_Behavior* find_directive(const ast::Directive& directive);
+
+    [[nodiscard]]
+    Definition_Epoch get_definition_epoch() const
+    {
+        return m_definition_epoch;
+    }
+
+    /// @brief Returns the bytecode for `expression`,
+    /// which is compiled when it is first requested and cached within `expression` afterwards.
+    /// The bytecode is owned by this context.
+    [[nodiscard]]
+    const Bytecode_Program& get_bytecode(const ast::Expression& expression);
+
     [[nodiscard]]
     const Referred* find_id(std::u8string_view id) const
     {
@@ -598,33 +798,67 @@ public:
     [[nodiscard]]
     const Directive_Behavior* find_alias(string_view_type name) const
     {
-        const auto it = m_aliases.find(name);
+        const std::optional<Symbol> symbol = m_symbols.find(name);
+        if (!symbol) {
+            return nullptr;
+        }
+        const auto it = m_aliases.find(*symbol);
         return it == m_aliases.end() ? nullptr : it->second;
     }
 
     [[nodiscard]]
-    bool emplace_alias(std::pmr::u8string&& name, const Directive_Behavior* behavior)
+    bool emplace_alias(string_view_type name, const Directive_Behavior* behavior)
     {
         COWEL_ASSERT(behavior);
-        const auto [_, success] = m_aliases.emplace(std::move(name), behavior);
+        const auto [_, success] = m_aliases.emplace(m_symbols.intern(name), behavior);
+        if (success) {
+            m_definition_epoch = make_definition_epoch();
+        }
         return success;
     }
 
     [[nodiscard]]
     const Macro_Definition* find_macro(std::u8string_view id) const
     {
-        const auto it = m_macros.find(id);
+        const std::optional<Symbol> symbol = m_symbols.find(id);
+        if (!symbol) {
+            return nullptr;
+        }
+        const auto it = m_macros.find(*symbol);
         return it == m_macros.end() ? nullptr : &it->second;
     }
 
+    /// @brief Defines a macro.
+    /// The macro refers to `definition` rather than copying it,
+    /// so `definition` has to outlive this context,
+    /// such as by being part of the main document or of a retained document.
+    /// If `pure` is `true`, the output of the macro is memoized (see `Macro_Definition`).
     [[nodiscard]]
     bool emplace_macro(
-        std::pmr::u8string&& name,
+        std::u8string_view name,
         std::span<const ast::Markup_Element> definition,
-        std::u8string_view macro_source
+        std::u8string_view macro_source,
+        bool pure = false
     );
 
+    [[nodiscard]]
+    std::size_t get_macro_count() const noexcept
+    {
+        return m_macros.size();
+    }
+
+    /// @brief Takes ownership of the AST of a loaded document until this context is destroyed,
+    /// so that macros defined in that document can keep referring to its content.
+    void retain_document(ast::Pmr_Vector<ast::Markup_Element>&& content)
+    {
+        m_retained_documents.push_back(std::move(content));
+    }
+
 private:
+    /// @brief Returns a `Definition_Epoch` which has never been returned before.
+    [[nodiscard]]
+    static Definition_Epoch make_definition_epoch();
+
     [[nodiscard]]
     std::span<const File_Source_Span> collect_diagnostic_stack()
     {
@@ -106,6 +106,18 @@ enum cowel_gen_flags {
     /// @brief Do not show source text alongside CST instructions.
     /// Applicable to `cowel_dump_parse` operations.
     COWEL_GEN_FLAGS_NO_SOURCE = 1 << 3,
+    /// @brief Allocate the ASTs of the document and of all included documents
+    /// within an arena which is freed wholesale once generation has finished.
+    /// This avoids individual allocations and reference counting for AST nodes,
+    /// at the cost of holding on to all ASTs until the end of generation.
+    /// Applicable to `cowel_generate` operations.
+    COWEL_GEN_FLAGS_AST_ARENA = 1 << 4,
+    /// @brief Replace unary and binary expressions whose operands are literals
+    /// with the literal result of the expression before processing,
+    /// so that they are not re-evaluated each time they are processed (e.g. within macros).
+    /// Expressions that would emit diagnostics upon evaluation are left intact.
+    /// Applicable to `cowel_generate` operations.
+    COWEL_GEN_FLAGS_FOLD_CONSTANTS = 1 << 5,
 };
 
 // NOLINTNEXTLINE(performance-enum-size)
@@ -303,6 +315,44 @@ typedef void cowel_log_fn(const void* data, const cowel_diagnostic* diagnostic)
 typedef void
 cowel_log_fn_u8(const void* data, const cowel_diagnostic_u8* diagnostic) COWEL_NOEXCEPT;
 
+/// @brief An entry of an AST cache (see `cowel_options::load_cache`).
+struct cowel_cache_entry {
+    /// @brief The cached data, or null if there is no entry.
+    const void* data;
+    /// @brief The size of `data` in bytes.
+    size_t size;
+};
+
+typedef cowel_cache_entry
+cowel_load_cache_fn(const void* data, cowel_string_view key) COWEL_NOEXCEPT;
+typedef cowel_cache_entry
+cowel_load_cache_fn_u8(const void* data, cowel_string_view_u8 key) COWEL_NOEXCEPT;
+
+typedef void cowel_store_cache_fn(
+    const void* data,
+    cowel_string_view key,
+    cowel_cache_entry entry
+) COWEL_NOEXCEPT;
+typedef void cowel_store_cache_fn_u8(
+    const void* data,
+    cowel_string_view_u8 key,
+    cowel_cache_entry entry
+) COWEL_NOEXCEPT;
+
+typedef void cowel_write_fn(const void* data, cowel_string_view text) COWEL_NOEXCEPT;
+typedef void cowel_write_fn_u8(const void* data, cowel_string_view_u8 text) COWEL_NOEXCEPT;
+
+typedef void cowel_write_slices_fn(
+    const void* data,
+    const cowel_string_view* slices,
+    size_t slices_size
+) COWEL_NOEXCEPT;
+typedef void cowel_write_slices_fn_u8(
+    const void* data,
+    const cowel_string_view_u8* slices,
+    size_t slices_size
+) COWEL_NOEXCEPT;
+
 // NOLINTNEXTLINE(performance-enum-size)
 enum cowel_syntax_highlight_status {
     /// @brief Successful highlighting.
@@ -519,6 +569,68 @@ struct cowel_options {
     /// @brief Additional source which is prepended to `source`.
     /// Importantly, this does not shift line numbers within `source`.
     cowel_string_view preamble;
+
+    /// @brief A (possibly null) pointer to a function which loads a previously stored AST
+    /// from a persistent cache.
+    /// If `load_cache` and `store_cache` are provided,
+    /// the ASTs of `preamble`, `source`, and of any loaded files are looked up in the cache
+    /// instead of being parsed anew,
+    /// and stored in the cache when they are not found.
+    ///
+    /// The `key` is a string of ASCII alphanumeric characters,
+    /// derived from a hash of the parsed source code and the version of the engine,
+    /// which makes it suitable as a file name.
+    /// If there is no entry for `key`, a `cowel_cache_entry` with null `data` shall be returned.
+    /// Otherwise, the returned data has to remain valid until processing completes.
+    /// Data which does not hold a valid AST (e.g. because it was corrupted) is ignored.
+    cowel_load_cache_fn* load_cache;
+    /// @brief Additional data passed into `load_cache`.
+    const void* load_cache_data;
+    /// @brief A (possibly null) pointer to a function which stores an AST in a persistent cache
+    /// under the given `key`, so that it can later be loaded by `load_cache`.
+    /// The data in the `entry` is only valid during the call,
+    /// so it has to be copied.
+    cowel_store_cache_fn* store_cache;
+    /// @brief Additional data passed into `store_cache`.
+    const void* store_cache_data;
+
+    /// @brief The maximum depth of nested directive invocations, including macro expansions.
+    /// Exceeding this depth (e.g. due to a macro which expands itself unconditionally)
+    /// results in a fatal error instead of a stack overflow.
+    /// Since each level of nesting consumes native stack space,
+    /// this should be lowered when generating on threads with small stacks.
+    /// If zero, a default depth of 96 is used,
+    /// with which generation fits into a stack of 1 MiB in optimized builds.
+    size_t max_call_depth;
+
+    /// @brief A (possibly null) pointer to a function which receives the generated HTML.
+    /// If `write` is not null, the output is passed to `write` in consecutive chunks
+    /// as soon as it is final (i.e. once references to other sections have been resolved),
+    /// and the `output` of the `cowel_gen_result` is empty.
+    /// This avoids keeping a second copy of the whole document in memory,
+    /// and allows the caller to start writing the document (e.g. to a file)
+    /// before generation has completed.
+    /// The `text` passed to `write` is only valid during the call.
+    ///
+    /// Note that if generation fails, `write` may already have been invoked.
+    cowel_write_fn* write;
+    /// @brief Additional data passed into `write`.
+    const void* write_data;
+
+    /// @brief A (possibly null) pointer to a function which receives the generated HTML
+    /// as a list of slices, which is similar to the `iovec` array passed to `writev`.
+    /// If `write_slices` is not null, it takes precedence over `write`,
+    /// and is invoked once after processing with slices whose concatenation is the output.
+    /// The `output` of the `cowel_gen_result` is empty.
+    /// Most slices refer directly to the buffers that sections of the document
+    /// were generated into,
+    /// so the document is never assembled into a single string.
+    /// The slices are only valid during the call.
+    ///
+    /// Note that `write_slices` is invoked even if generation fails.
+    cowel_write_slices_fn* write_slices;
+    /// @brief Additional data passed into `write_slices`.
+    const void* write_slices_data;
 };
 
 /// @brief See `cowel_options`.
@@ -547,6 +659,19 @@ struct cowel_options_u8 {
     cowel_syntax_highlight_policy highlight_policy;
 
     cowel_string_view_u8 preamble;
+
+    cowel_load_cache_fn_u8* load_cache;
+    const void* load_cache_data;
+    cowel_store_cache_fn_u8* store_cache;
+    const void* store_cache_data;
+
+    size_t max_call_depth;
+
+    cowel_write_fn_u8* write;
+    const void* write_data;
+
+    cowel_write_slices_fn_u8* write_slices;
+    const void* write_slices_data;
 };
 
 struct cowel_dump_tokens_options {
@@ -805,6 +930,10 @@ struct cowel_parsed_cli_options_u8 {
     /// @brief Human-readable error description.
     /// Valid only when `ok` is false.
     cowel_mutable_string_view_u8 error_message;
+    /// @brief Path to a directory in which parsed ASTs are cached between runs.
+    /// Empty if no caching should take place.
+    /// Valid only when `command` is `COWEL_CLI_COMMAND_RUN`.
+    cowel_mutable_string_view_u8 ast_cache;
 };
 
 /// @brief Parses CLI arguments into a `cowel_parsed_cli_options` struct.
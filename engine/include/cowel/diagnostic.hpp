@@ -134,6 +134,11 @@ inline constexpr std::u8string_view splice = u8"splice";
 /// no variable with that name was found.
 inline constexpr std::u8string_view id_lookup = u8"id.lookup";
 
+/// @brief Directive invocations (including macro expansions) were nested
+/// more deeply than the maximum call depth allows.
+/// This is typically caused by a macro which unconditionally expands itself.
+inline constexpr std::u8string_view call_depth = u8"call.depth";
+
 // DIRECTIVE-SPECIFIC DIAGNOSTICS ==================================================================
 
 /// @brief In an HTML element directive,
@@ -19,6 +19,7 @@
 #include "cowel/value.hpp"
 
 #include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/parse_utils.hpp"
 
 namespace cowel {
 
@@ -215,18 +216,6 @@ evaluate(const ast::Directive& directive, Frame_Index frame, Context& context);
 Result<Value, Processing_Status>
 evaluate(const ast::Primary& value, Frame_Index frame, Context& context);
 
-[[nodiscard]]
-Result<Value, Processing_Status>
-evaluate(const ast::Unary_Expression& expression, Frame_Index frame, Context& context);
-
-[[nodiscard]]
-Result<Value, Processing_Status>
-evaluate(const ast::Binary_Expression& expression, Frame_Index frame, Context& context);
-
-[[nodiscard]]
-Result<Value, Processing_Status>
-evaluate(const ast::Let_Expression& expression, Frame_Index frame, Context& context);
-
 Result<Value, Processing_Status> evaluate_unary(
     Unary_Expression_Kind kind, //
     const Value& value,
@@ -310,6 +299,13 @@ enum struct Paragraphs_State : bool {
     inside,
 };
 
+/// @brief The state of a `Paragraph_Split_Policy` which determines
+/// how subsequent content is split into paragraphs.
+struct Paragraph_Split_State {
+    Paragraphs_State paragraphs = Paragraphs_State::outside;
+    Blank_Line_Initial_State line = Blank_Line_Initial_State::middle;
+};
+
 void diagnose(
     Syntax_Highlight_Error error,
     std::u8string_view lang,
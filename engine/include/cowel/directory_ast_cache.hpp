@@ -0,0 +1,61 @@
+#ifndef COWEL_DIRECTORY_AST_CACHE_HPP
+#define COWEL_DIRECTORY_AST_CACHE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "cowel/util/function_ref.hpp"
+#include "cowel/util/io.hpp"
+
+#include "cowel/cowel.h"
+#include "cowel/fwd.hpp"
+#include "cowel/services.hpp"
+
+namespace cowel {
+
+/// @brief An `AST_Cache` implementation which stores each entry as a file named `<key>.ast`
+/// within a given directory.
+/// Like `Relative_File_Loader`, this can be used both internally
+/// and as an external implementation which is fed into the `cowel.h` top-level API.
+struct Directory_AST_Cache final : AST_Cache {
+private:
+    std::filesystem::path m_directory;
+    /// @brief The loaded entries, which are mapped into memory
+    /// and kept alive for the lifetime of the cache.
+    /// Since `store` replaces entries by renaming a new file over them,
+    /// the mapped contents never change.
+    std::pmr::vector<Mapped_File> m_loaded;
+    bool m_directory_created = false;
+
+public:
+    [[nodiscard]]
+    explicit Directory_AST_Cache(
+        std::filesystem::path&& directory,
+        std::pmr::memory_resource* memory
+    );
+
+    [[nodiscard]]
+    std::span<const std::byte> load(std::u8string_view key) final;
+
+    void store(std::u8string_view key, std::span<const std::byte> data) final;
+
+    [[nodiscard]]
+    Function_Ref<cowel_cache_entry(cowel_string_view_u8) noexcept>
+    as_cowel_load_cache_fn() noexcept;
+
+    [[nodiscard]]
+    Function_Ref<void(cowel_string_view_u8, cowel_cache_entry) noexcept>
+    as_cowel_store_cache_fn() noexcept;
+
+private:
+    [[nodiscard]]
+    std::filesystem::path entry_path(std::u8string_view key) const;
+};
+
+} // namespace cowel
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef COWEL_DOCUMENT_GENERATION_HPP
 #define COWEL_DOCUMENT_GENERATION_HPP
 
+#include <cstddef>
 #include <memory_resource>
 #include <span>
 #include <string_view>
@@ -10,9 +11,11 @@
 
 #include "cowel/policy/content_policy.hpp"
 
+#include "cowel/call_stack.hpp"
 #include "cowel/content_status.hpp"
 #include "cowel/context.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/services.hpp"
 
 namespace cowel {
@@ -43,6 +46,34 @@ struct Generation_Options {
     /// records a `Hover_Entry` here during processing.
     std::pmr::vector<Hover_Entry>* hover_sink = nullptr;
 
+    /// @brief Optional arena in which the ASTs of documents loaded during generation
+    /// (e.g. via `\cowel_include`) are allocated.
+    /// When null, they are allocated from transient memory and reference-counted instead.
+    /// The arena should be released once generation has finished,
+    /// which frees all of these ASTs wholesale.
+    GC_Arena* ast_arena = nullptr;
+
+    /// @brief Optional cache from which the ASTs of documents loaded during generation
+    /// are loaded instead of parsing them, and in which they are stored otherwise.
+    AST_Cache* ast_cache = nullptr;
+
+    /// @brief If `true`, constant expressions in the ASTs of documents loaded during generation
+    /// are folded (see `fold_constants`) before they are processed.
+    bool fold_constants = false;
+
+    /// @brief The maximum depth of nested directive invocations, including macro expansions.
+    /// Exceeding this depth results in a fatal error rather than exhausting the native stack,
+    /// so it should be lowered when generating on threads with small stacks.
+    std::size_t max_call_depth = default_max_call_depth;
+
+    /// @brief Optional heap from which `GC_Node`s (e.g. of strings and groups)
+    /// are allocated during generation.
+    /// When null, a heap is created for the duration of generation,
+    /// whose memory is released in bulk once generation has finished.
+    /// Providing a heap allows inspecting its statistics afterwards,
+    /// or covering other work (such as parsing) with the same heap.
+    GC_Heap* gc_heap = nullptr;
+
     /// @brief A source of memory to be used throughout generation,
     /// emitting diagnostics, etc.
     std::pmr::memory_resource* memory;
@@ -56,8 +87,12 @@ Processing_Status run_generation(
     const Generation_Options& options
 );
 
-/// @brief Resolves references previously written via `reference_section`, recursively.
-bool resolve_references(Text_Sink& out, std::u8string_view text, Context& context, File_Id file);
+/// @brief Writes the text of `section` to `out`,
+/// where references previously written via `Text_Sink::write_section_reference` are replaced
+/// with the text of the referenced sections, recursively.
+/// The text of sections is passed to `out` via `Text_Sink::write_stable`,
+/// so no more text may be written to any section afterwards.
+bool resolve_references(Text_Sink& out, Section_Id section, Context& context, File_Id file);
 
 [[nodiscard]]
 Processing_Status write_head_body_document(
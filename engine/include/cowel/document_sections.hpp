@@ -1,60 +1,156 @@
 #ifndef COWEL_DOCUMENT_WRITER_HPP
 #define COWEL_DOCUMENT_WRITER_HPP
 
+#include <algorithm>
 #include <cstddef>
-#include <map>
+#include <deque>
 #include <memory_resource>
-#include <string>
+#include <optional>
+#include <span>
 #include <string_view>
-#include <utility>
 #include <vector>
 
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
-#include "cowel/util/char_sequence_factory.hpp"
-#include "cowel/util/chars.hpp"
+#include "cowel/util/char_sequence_ops.hpp"
 #include "cowel/util/strings.hpp"
-#include "cowel/util/transparent_comparison.hpp"
 
-#include "cowel/policy/capture.hpp"
 #include "cowel/policy/html.hpp"
 
 #include "cowel/fwd.hpp"
 #include "cowel/output_language.hpp"
+#include "cowel/settings.hpp"
+#include "cowel/symbol.hpp"
 
 namespace cowel {
 
+/// @brief A reference to another section within HTML text, such as the text of a section.
+struct Section_Reference {
+    /// @brief The offset within the text
+    /// at which the contents of the referenced section are inserted.
+    std::size_t offset;
+    /// @brief The referenced section.
+    Section_Id section;
+};
+
+/// @brief HTML text, along with the references to other sections within it.
+/// The references are not part of the text itself,
+/// so no text can be mistaken for a reference.
+struct Captured_HTML {
+    std::pmr::vector<char8_t> text;
+    /// @brief The references within `text`, in ascending order of their offset.
+    std::pmr::vector<Section_Reference> references;
+
+    [[nodiscard]]
+    explicit Captured_HTML(std::pmr::memory_resource* memory)
+        : text { memory }
+        , references { memory }
+    {
+    }
+
+    [[nodiscard]]
+    std::u8string_view str() const
+    {
+        return as_u8string_view(text);
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return text.empty() && references.empty();
+    }
+
+    /// @brief Writes the text within `[begin, end)` to `out`,
+    /// interleaved with the references within that range.
+    /// References outside that range are written at its start or end, respectively.
+    void write_to(Text_Sink& out, std::size_t begin, std::size_t end) const
+    {
+        COWEL_DEBUG_ASSERT(begin <= end && end <= text.size());
+        std::size_t written_length = begin;
+        const auto write_until = [&](const std::size_t offset) {
+            if (offset > written_length) {
+                const std::size_t length = offset - written_length;
+                out.write(str().substr(written_length, length), Output_Language::html);
+                written_length = offset;
+            }
+        };
+        for (const Section_Reference& reference : references) {
+            write_until(std::min(reference.offset, end));
+            out.write_section_reference(reference.section);
+        }
+        write_until(end);
+    }
+
+    /// @brief Writes the text to `out`, interleaved with the references.
+    void write_to(Text_Sink& out) const
+    {
+        write_to(out, 0, text.size());
+    }
+};
+
+/// @brief A text sink which captures HTML and the section references written to it
+/// into a `Captured_HTML`,
+/// so that both can be written elsewhere later.
+struct Capturing_HTML_Sink final : virtual Text_Sink {
+private:
+    Captured_HTML& m_out;
+
+public:
+    [[nodiscard]]
+    explicit Capturing_HTML_Sink(Captured_HTML& out) noexcept
+        : Text_Sink { Text_Sink_Flags::none }
+        , m_out { out }
+    {
+    }
+
+    void write(Char_Sequence8 chars, [[maybe_unused]] const Output_Language language) override
+    {
+        COWEL_DEBUG_ASSERT(language == Output_Language::html);
+        if constexpr (enable_empty_string_assertions) {
+            COWEL_ASSERT(!chars.empty());
+        }
+        append(m_out.text, chars);
+    }
+
+    void write_section_reference(const Section_Id id) override
+    {
+        m_out.references.push_back({ .offset = m_out.text.size(), .section = id });
+    }
+};
+
 struct Section_Content {
 private:
-    std::pmr::vector<char8_t> m_data;
-    Capturing_Ref_Text_Sink m_sink { m_data, Output_Language::html };
+    Captured_HTML m_content;
+    Capturing_HTML_Sink m_sink { m_content };
     HTML_Content_Policy m_policy { m_sink };
 
 public:
     [[nodiscard]]
     explicit Section_Content(std::pmr::memory_resource* memory)
-        : m_data { memory }
+        : m_content { memory }
     {
     }
 
     Section_Content(const Section_Content&) = delete;
     Section_Content& operator=(const Section_Content&) = delete;
 
-    Section_Content(Section_Content&&) = default;
+    Section_Content(Section_Content&&) = delete;
     Section_Content& operator=(Section_Content&&) = delete;
 
     ~Section_Content() = default;
 
+    /// @brief Returns the text of the section, not including any references to other sections.
     [[nodiscard]]
     std::u8string_view text() const
     {
-        return as_u8string_view(m_data);
+        return m_content.str();
     }
 
+    /// @brief Returns the references to other sections, in ascending order of their offset.
     [[nodiscard]]
-    std::pmr::vector<char8_t>& output() &
+    std::span<const Section_Reference> references() const
     {
-        return m_data;
+        return m_content.references;
     }
 
     [[nodiscard]]
@@ -69,23 +165,21 @@ public:
     }
 };
 
+/// @brief The sections of a document,
+/// which are identified by a name, or by the `Section_Id` that the name is interned as.
+///
+/// Referring to sections by `Section_Id` is preferable where possible
+/// because it requires no lookup of the name.
 struct Document_Sections {
 public:
-    // The choice of std::map over std::unordered_map is deliberate:
-    // We require iterator and reference stability in some cases,
-    // and std::unordered_map can invalidate iterators and references on rehashing.
-    using map_type
-        = std::pmr::map<std::pmr::u8string, Section_Content, Transparent_String_View_Less8>;
-    using entry_type = map_type::value_type;
-
     struct [[nodiscard]] Scoped_Section {
     private:
         friend Document_Sections;
 
         Document_Sections& self;
-        entry_type& old;
+        Section_Id old;
 
-        Scoped_Section(Document_Sections& self, entry_type& old)
+        Scoped_Section(Document_Sections& self, Section_Id old)
             : self { self }
             , old { old }
         {
@@ -97,18 +191,33 @@ public:
 
         ~Scoped_Section()
         {
-            self.m_current = &old;
+            self.m_current = old;
         }
     };
 
 private:
-    map_type m_sections;
-    entry_type* m_current = &*m_sections.emplace(std::pmr::u8string {}, get_memory()).first;
+    Symbol_Table m_names;
+    // Section_Content cannot be relocated because its content policy refers to its own sink,
+    // so std::deque is used, which never relocates its elements when growing at the end.
+    // Sections which are only referenced but were never made remain empty.
+    std::pmr::deque<std::optional<Section_Content>> m_contents;
+    Section_Id m_current = make(std::u8string_view {});
+
+    /// @brief Adds an (empty) entry to `m_contents` if `id` was newly interned,
+    /// and returns `id`.
+    Section_Id track_interned(Section_Id id)
+    {
+        if (std::size_t(id) == m_contents.size()) {
+            m_contents.emplace_back();
+        }
+        return id;
+    }
 
 public:
     [[nodiscard]]
     explicit Document_Sections(std::pmr::memory_resource* memory)
-        : m_sections { memory }
+        : m_names { memory }
+        , m_contents { memory }
     {
     }
 
@@ -120,170 +229,206 @@ public:
     [[nodiscard]]
     std::pmr::memory_resource* get_memory() const
     {
-        return m_sections.get_allocator().resource();
+        return m_contents.get_allocator().resource();
     }
 
-    /// @brief Returns a pointer to the section named `section` if one exists;
-    /// otherwise returns null.
-    ///
-    /// No allocations are performed.
+    /// @brief Returns the amount of section IDs that have been assigned,
+    /// i.e. one past the greatest `Section_Id`.
     [[nodiscard]]
-    entry_type* find(std::u8string_view section)
+    std::size_t size() const noexcept
     {
-        const auto existing_iter = m_sections.find(section);
-        return existing_iter != m_sections.end() ? &*existing_iter : nullptr;
+        return m_contents.size();
     }
 
-    /// @brief Returns a pointer to the section named `section` if one exists;
-    /// otherwise returns null.
+    /// @brief Returns the ID of the section named `section`,
+    /// which is assigned if `section` has no ID yet.
+    /// Unlike `make`, this does not create the section.
     ///
-    /// No allocations are performed.
+    /// Allocates a copy of the name if the section has no ID yet.
     [[nodiscard]]
-    const entry_type* find(std::u8string_view section) const
+    Section_Id intern(std::u8string_view section)
     {
-        const auto existing_iter = m_sections.find(section);
-        return existing_iter != m_sections.end() ? &*existing_iter : nullptr;
+        return track_interned(Section_Id(m_names.intern(section)));
     }
 
-    /// @brief Creates a new section named `section` if one doesn't exist yet.
-    /// Returns a reference to the new or existing one.
+    /// @brief Like `intern(std::u8string_view)`,
+    /// but the name of the section is the concatenation of `parts`,
+    /// such as `{ u8"std.bib"sv, u8"."sv, id }`.
+    /// The parts are not joined into a separate string.
+    [[nodiscard]]
+    Section_Id intern(std::span<const std::u8string_view> parts)
+    {
+        return track_interned(Section_Id(m_names.intern(parts)));
+    }
+
+    /// @brief Returns the ID of the section named `section` if one exists;
+    /// otherwise returns `std::nullopt`.
     ///
-    /// Allocates a new key string if the section doesn't exist yet.
-    entry_type& make(std::u8string_view section)
+    /// No allocations are performed.
+    [[nodiscard]]
+    std::optional<Section_Id> find(std::u8string_view section) const
     {
-        if (entry_type* const existing = find(section)) {
-            return *existing;
+        const std::optional<Symbol> symbol = m_names.find(section);
+        if (!symbol || !try_get(Section_Id(*symbol))) {
+            return {};
         }
-        const auto [iter, success]
-            = m_sections.emplace(std::pmr::u8string { section, get_memory() }, get_memory());
-        COWEL_ASSERT(success);
-        return *iter;
+        return Section_Id(*symbol);
+    }
+
+    /// @brief Returns `true` iff `id` has been assigned to some section name,
+    /// i.e. iff `id < size()`.
+    [[nodiscard]]
+    bool contains(Section_Id id) const noexcept
+    {
+        return std::size_t(id) < m_contents.size();
+    }
+
+    /// @brief Returns the name of the section with the given `id`,
+    /// which shall have been assigned (see `contains`).
+    [[nodiscard]]
+    std::u8string_view get_name(Section_Id id) const
+    {
+        COWEL_ASSERT(contains(id));
+        return m_names.get_name(Symbol(id));
     }
 
-    /// @brief Like the overload taking `std::u8string_view`,
-    /// but if the section does not yet exist,
-    /// doesn't allocate a new string for the key name.
-    entry_type& make(std::pmr::u8string&& section)
+    /// @brief Returns a pointer to the section with the given `id` if it exists;
+    /// otherwise returns null.
+    /// This includes the case where `id` has not been assigned at all.
+    [[nodiscard]]
+    Section_Content* try_get(Section_Id id)
     {
-        if (entry_type* const existing = find(section)) {
-            return *existing;
+        if (!contains(id)) {
+            return nullptr;
         }
-        const auto [iter, success] = m_sections.emplace(std::move(section), get_memory());
-        COWEL_ASSERT(success);
-        return *iter;
+        std::optional<Section_Content>& content = m_contents[std::size_t(id)];
+        return content ? &*content : nullptr;
     }
 
-    /// @brief Sets the current section to the given `section` if one already exists,
-    /// and returns a pointer to the section entry;
+    /// @brief Returns a pointer to the section with the given `id` if it exists;
     /// otherwise returns null.
-    ///
-    /// No allocations are performed.
+    /// This includes the case where `id` has not been assigned at all.
     [[nodiscard]]
-    entry_type* try_go_to(std::u8string_view section)
+    const Section_Content* try_get(Section_Id id) const
     {
-        const auto existing_iter = m_sections.find(section);
-        entry_type* const result = existing_iter != m_sections.end() ? &*existing_iter : nullptr;
-        m_current = result;
-        return result;
+        if (!contains(id)) {
+            return nullptr;
+        }
+        const std::optional<Section_Content>& content = m_contents[std::size_t(id)];
+        return content ? &*content : nullptr;
     }
 
-    /// @brief Sets the current section to an existing one or a newly created one named `section`,
-    /// and returns a reference to that section.
+    /// @brief Returns the section with the given `id`, which shall exist.
+    [[nodiscard]]
+    Section_Content& get(Section_Id id)
+    {
+        Section_Content* const result = try_get(id);
+        COWEL_ASSERT(result);
+        return *result;
+    }
+
+    /// @brief Returns the section with the given `id`, which shall exist.
+    [[nodiscard]]
+    const Section_Content& get(Section_Id id) const
+    {
+        const Section_Content* const result = try_get(id);
+        COWEL_ASSERT(result);
+        return *result;
+    }
+
+    /// @brief Creates the section with the given `id` if it doesn't exist yet.
+    /// Returns `id`.
+    Section_Id make(Section_Id id)
+    {
+        COWEL_ASSERT(contains(id));
+        std::optional<Section_Content>& content = m_contents[std::size_t(id)];
+        if (!content) {
+            content.emplace(get_memory());
+        }
+        return id;
+    }
+
+    /// @brief Creates a new section named `section` if one doesn't exist yet.
+    /// Returns the ID of the new or existing one.
     ///
-    /// Allocates a new key string if a section doesn't exist yet.
-    entry_type& go_to(std::u8string_view section)
+    /// Allocates a copy of the name if the section has no ID yet.
+    Section_Id make(std::u8string_view section)
     {
-        entry_type& result = make(section);
-        m_current = &result;
-        return result;
+        return make(intern(section));
     }
 
-    /// @brief Like the overload taking `std::u8string_view`,
-    /// but if the section does not yet exist,
-    /// doesn't allocate a new string for the key name.
-    entry_type& go_to(std::pmr::u8string&& section)
+    /// @brief Sets the current section to the section with the given `id`,
+    /// which is created if it doesn't exist yet.
+    Section_Id go_to(Section_Id id)
     {
-        entry_type& result = make(std::move(section));
-        m_current = &result;
-        return result;
+        m_current = make(id);
+        return id;
     }
 
-    /// @brief Calls `go_to(section)` and returns a `Scoped_Section` which,
+    /// @brief Sets the current section to an existing one or a newly created one named `section`,
+    /// and returns its ID.
+    ///
+    /// Allocates a copy of the name if the section has no ID yet.
+    Section_Id go_to(std::u8string_view section)
+    {
+        return go_to(intern(section));
+    }
+
+    /// @brief Calls `go_to(id)` and returns a `Scoped_Section` which,
     /// upon destruction, sets the current section to the section prior to `go_to`.
     ///
     /// This is useful for temporarily writing content to a different section.
-    Scoped_Section go_to_scoped(std::u8string_view section)
+    Scoped_Section go_to_scoped(Section_Id id)
     {
-        entry_type* const old = m_current;
-        go_to(section);
-        return Scoped_Section { *this, *old };
+        const Section_Id old = m_current;
+        go_to(id);
+        return Scoped_Section { *this, old };
     }
 
     /// @brief Calls `go_to(section)` and returns a `Scoped_Section` which,
     /// upon destruction, sets the current section to the section prior to `go_to`.
     ///
     /// This is useful for temporarily writing content to a different section.
-    Scoped_Section go_to_scoped(std::pmr::u8string&& section)
+    Scoped_Section go_to_scoped(std::u8string_view section)
     {
-        entry_type* const old = m_current;
-        go_to(std::move(section));
-        return Scoped_Section { *this, *old };
+        return go_to_scoped(intern(section));
     }
 
-    /// @brief Returns a reference to the current section.
+    /// @brief Returns the ID of the current section.
     [[nodiscard]]
-    entry_type& current() noexcept
+    Section_Id current_id() const noexcept
     {
-        return *m_current;
+        return m_current;
     }
 
     /// @brief Returns a reference to the current section.
     [[nodiscard]]
-    const entry_type& current() const noexcept
+    Section_Content& current() noexcept
     {
-        return *m_current;
+        return *m_contents[std::size_t(m_current)];
     }
 
+    /// @brief Returns a reference to the current section.
     [[nodiscard]]
-    std::u8string_view current_name() const noexcept
+    const Section_Content& current() const noexcept
     {
-        return current().first;
+        return *m_contents[std::size_t(m_current)];
     }
 
     [[nodiscard]]
-    std::pmr::vector<char8_t>& current_output() noexcept
+    std::u8string_view current_name() const noexcept
     {
-        return current().second.output();
+        return get_name(m_current);
     }
 
-    /// @brief Returns the output characters of the current section.
+    /// @brief Returns the content policy of the current section.
     [[nodiscard]]
     Content_Policy& current_policy() noexcept
     {
-        return current().second.policy();
+        return current().policy();
     }
 };
 
-/// @brief Appends a "section reference" to `out`.
-/// This works by mapping the length onto a code point within the
-/// Supplementary Private Use Area-A block,
-/// and encoding that as UTF-8.
-/// The given name is then appended as is.
-/// @returns `name.size() <= 65635`.
-/// A name beyond that size cannot be encoded as a section reference.
-inline bool reference_section(Text_Sink& out, Char_Sequence8 name)
-{
-    constexpr std::size_t max_length = supplementary_pua_a_max - supplementary_pua_a_min;
-    if (name.size() > max_length) {
-        return false;
-    }
-
-    const char32_t first_point = supplementary_pua_a_min + char32_t(name.size());
-    out.write(make_char_sequence(first_point), Output_Language::html);
-    out.write(name, Output_Language::html);
-    return true;
-}
-
 } // namespace cowel
 
 #endif
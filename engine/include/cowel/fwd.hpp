@@ -16,8 +16,10 @@ using Default_Underlying = unsigned char;
 #define COWEL_ENUM_STRING_CASE8(...)                                                               \
     case __VA_ARGS__: return u8## #__VA_ARGS__
 
+struct Bytecode_Program;
 struct Content_Policy;
 struct Context;
+struct Directive_Behavior;
 
 /// @brief The floating-point type corresponding to COWEL's `float` type.
 using Float = double;
@@ -36,6 +38,23 @@ enum struct File_Id : int { main = -1 }; // NOLINT(performance-enum-size)
 /// i.e. content which is not expanded from any macro.
 enum struct Frame_Index : int { root = -1 }; // NOLINT(performance-enum-size)
 
+/// @brief Identifies the set of macros and aliases defined in a `Context` at some point.
+/// Whenever a macro or alias is defined, the context obtains a new epoch
+/// which is distinct from the epochs of all other contexts,
+/// so a directive name that was resolved in a given epoch resolves to the same behavior
+/// as long as the epoch of the context is unchanged.
+/// The special value `none` is never the epoch of any context.
+enum struct Definition_Epoch : Uint64 { none = 0 };
+
+/// @brief An interned name, such as that of a variable, macro, or alias,
+/// obtained from a `Symbol_Table`.
+/// Symbols from the same table are equal if and only if their names are equal.
+enum struct Symbol : Uint32 { };
+
+/// @brief Identifies a section within `Document_Sections`.
+/// Sections are numbered densely in the order in which their names are first seen.
+enum struct Section_Id : Uint32 { };
+
 } // namespace cowel
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef COWEL_GC_HPP
 #define COWEL_GC_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory_resource>
@@ -16,27 +17,121 @@
 #include "cowel/settings.hpp"
 
 namespace cowel {
+
+/// @brief Statistics about the nodes allocated from a `GC_Heap`.
+struct GC_Heap_Statistics {
+    /// @brief The amount of nodes which are currently alive.
+    std::size_t live_nodes = 0;
+    /// @brief The total size of all live nodes in bytes.
+    std::size_t live_bytes = 0;
+    /// @brief The greatest value that `live_bytes` has ever had.
+    std::size_t peak_live_bytes = 0;
+    /// @brief The total amount of nodes that have been allocated, including dead ones.
+    std::size_t total_nodes = 0;
+};
+
+/// @brief A heap from which reference-counted `GC_Node`s are allocated.
+/// Every node remembers the heap it was allocated from,
+/// and its memory is returned to that heap when it is collected,
+/// regardless of which heap is current at that point.
+///
+/// All memory obtained from the upstream resource is released in bulk
+/// when the heap is destroyed.
+/// Therefore, a heap that lives only as long as a single generation
+/// does not retain the high-water mark of that generation afterwards.
+/// Any `GC_Ref` to a node in the heap is dangling once the heap is destroyed.
+///
+/// A heap is not thread-safe, but its nodes may be handed between threads
+/// as long as the heap is not used by multiple threads at the same time.
+struct GC_Heap {
+private:
+    std::pmr::unsynchronized_pool_resource m_memory;
+    GC_Heap_Statistics m_statistics;
+
+public:
+    [[nodiscard]]
+    explicit GC_Heap(std::pmr::memory_resource* upstream = Global_Memory_Resource::get())
+        : m_memory { upstream }
+    {
+    }
+
+    GC_Heap(const GC_Heap&) = delete;
+    GC_Heap& operator=(const GC_Heap&) = delete;
+
+    [[nodiscard]]
+    const GC_Heap_Statistics& get_statistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    [[nodiscard]]
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        void* const result = m_memory.allocate(size, alignment);
+        ++m_statistics.live_nodes;
+        ++m_statistics.total_nodes;
+        m_statistics.live_bytes += size;
+        m_statistics.peak_live_bytes
+            = std::max(m_statistics.peak_live_bytes, m_statistics.live_bytes);
+        return result;
+    }
+
+    void deallocate(void* p, std::size_t size, std::size_t alignment) noexcept
+    {
+        COWEL_DEBUG_ASSERT(m_statistics.live_nodes != 0);
+        COWEL_DEBUG_ASSERT(m_statistics.live_bytes >= size);
+        --m_statistics.live_nodes;
+        m_statistics.live_bytes -= size;
+        m_memory.deallocate(p, size, alignment);
+    }
+};
+
 namespace detail {
 
 [[nodiscard]]
-inline std::pmr::unsynchronized_pool_resource& get_gc() noexcept
+inline GC_Heap*& get_current_gc_heap() noexcept
 {
-    thread_local std::pmr::unsynchronized_pool_resource gc { Global_Memory_Resource::get() };
-    return gc;
+    thread_local GC_Heap* current = nullptr;
+    return current;
 }
 
 } // namespace detail
 
+/// @brief Returns the heap from which `gc_ref_make` and `gc_ref_from_range`
+/// allocate nodes on the calling thread.
+/// This is the heap installed by the innermost `Scoped_GC_Heap`, if any,
+/// and otherwise a thread-local heap which lives as long as the thread.
 [[nodiscard]]
-inline void* gc_alloc(std::size_t size, std::size_t alignment)
+inline GC_Heap& get_gc_heap() noexcept
 {
-    return detail::get_gc().allocate(size, alignment);
+    if (GC_Heap* const current = detail::get_current_gc_heap()) {
+        return *current;
+    }
+    thread_local GC_Heap fallback;
+    return fallback;
 }
 
-inline void gc_free(void* p, std::size_t size, std::size_t alignment)
-{
-    detail::get_gc().deallocate(p, size, alignment);
-}
+/// @brief Makes a `GC_Heap` the current heap of the calling thread (see `get_gc_heap`)
+/// for the lifetime of this object.
+struct Scoped_GC_Heap {
+private:
+    GC_Heap* m_previous;
+
+public:
+    [[nodiscard]]
+    explicit Scoped_GC_Heap(GC_Heap& heap) noexcept
+        : m_previous { std::exchange(detail::get_current_gc_heap(), &heap) }
+    {
+    }
+
+    Scoped_GC_Heap(const Scoped_GC_Heap&) = delete;
+    Scoped_GC_Heap& operator=(const Scoped_GC_Heap&) = delete;
+
+    ~Scoped_GC_Heap()
+    {
+        detail::get_current_gc_heap() = m_previous;
+    }
+};
 
 using GC_Destructor = Function_Ref<void(void* address, std::size_t extent) noexcept>;
 
@@ -54,6 +149,14 @@ struct GC_Node {
     /// @brief The destructor for this allocation,
     /// invoked with `get_object_pointer()` and `extent` once the node is collected.
     const GC_Destructor destructor;
+    /// @brief The heap from which this node was allocated,
+    /// or null if the node is not owned by a heap (e.g. because it is owned by a `GC_Arena`).
+    GC_Heap* const heap = nullptr;
+    /// @brief If `true`, the lifetime of this node is not managed by reference counting,
+    /// but by its owner (e.g. a `GC_Arena`),
+    /// and `add_reference` and `drop_reference` have no effect.
+    /// The reference count of such a node is always zero.
+    const bool immortal = false;
 
     [[nodiscard]]
     std::uintptr_t get_object_address() const
@@ -88,7 +191,8 @@ struct GC_Node {
         if (destructor) {
             destructor(p, extent);
         }
-        gc_free(this, allocation_size, allocation_alignment);
+        COWEL_ASSERT(heap);
+        heap->deallocate(this, allocation_size, allocation_alignment);
     }
 
     void add_reference() noexcept
@@ -100,9 +204,13 @@ struct GC_Node {
 
     /// @brief Decreases the reference count by one
     /// and returns the remaining reference count.
-    /// The current reference count shall be at least one.
+    /// This has no effect on immortal nodes, for which zero is returned.
+    /// Otherwise, the current reference count shall be at least one.
     std::size_t drop_reference()
     {
+        if (immortal) {
+            return 0;
+        }
         COWEL_ASSERT(reference_count);
         const std::size_t remaining_references = --reference_count;
         if (remaining_references == 0) {
@@ -298,7 +406,8 @@ template <typename T, class... Args>
 GC_Ref<T> gc_ref_make(Args&&... args)
 {
     using Allocation = GC_Allocation<T>;
-    auto* result = static_cast<Allocation*>(gc_alloc(sizeof(Allocation), alignof(Allocation)));
+    GC_Heap& heap = get_gc_heap();
+    auto* result = static_cast<Allocation*>(heap.allocate(sizeof(Allocation), alignof(Allocation)));
     COWEL_ASSERT(result);
 
     result = new (result) Allocation { GC_Node {
@@ -307,6 +416,7 @@ GC_Ref<T> gc_ref_make(Args&&... args)
         .allocation_size = sizeof(Allocation),
         .allocation_alignment = alignof(Allocation),
         .destructor = detail::gc_destructor<T>,
+        .heap = &heap,
     } };
     if constexpr (is_debug_build) {
         const std::uintptr_t computed_address = result->node.get_object_address();
@@ -317,16 +427,19 @@ GC_Ref<T> gc_ref_make(Args&&... args)
     return GC_Ref<T> { &result->node };
 }
 
-template <typename T, class R>
-    requires requires(const R& r) { r.size(); }
+namespace detail {
+
+/// @brief Allocates a node with storage for `extent` objects of type `T` from the current heap,
+/// without constructing these objects.
+template <typename T>
 [[nodiscard]]
-GC_Ref<T> gc_ref_from_range(const R& r)
+GC_Allocation<T>* gc_allocate_array(const std::size_t extent)
 {
     using Allocation = GC_Allocation<T>;
-    const std::size_t extent = r.size();
     const std::size_t allocation_size = sizeof(Allocation) + (extent * sizeof(T));
     const std::size_t allocation_alignment = alignof(Allocation);
-    auto* result = static_cast<Allocation*>(gc_alloc(allocation_size, allocation_alignment));
+    GC_Heap& heap = get_gc_heap();
+    auto* result = static_cast<Allocation*>(heap.allocate(allocation_size, allocation_alignment));
     COWEL_ASSERT(result);
 
     result = new (result) Allocation { GC_Node {
@@ -335,12 +448,25 @@ GC_Ref<T> gc_ref_from_range(const R& r)
         .allocation_size = allocation_size,
         .allocation_alignment = allocation_alignment,
         .destructor = detail::gc_destructor<T>,
+        .heap = &heap,
     } };
     if constexpr (is_debug_build) {
         const std::uintptr_t computed_address = result->node.get_object_address();
         const auto actual_address = reinterpret_cast<std::uintptr_t>(&result->storage);
         COWEL_ASSERT(computed_address == actual_address);
     }
+    return result;
+}
+
+} // namespace detail
+
+template <typename T, class R>
+    requires requires(const R& r) { r.size(); }
+[[nodiscard]]
+GC_Ref<T> gc_ref_from_range(const R& r)
+{
+    const std::size_t extent = r.size();
+    GC_Allocation<T>* const result = detail::gc_allocate_array<T>(extent);
     auto it = r.begin();
     [[maybe_unused]]
     auto end
@@ -353,6 +479,104 @@ GC_Ref<T> gc_ref_from_range(const R& r)
     return GC_Ref<T> { &result->node };
 }
 
+/// @brief Allocates an array of `extent` value-initialized objects of type `T`.
+/// This is useful when the contents of the array are written after allocation,
+/// such as when building a string from multiple pieces.
+template <typename T>
+    requires std::is_default_constructible_v<T>
+[[nodiscard]]
+GC_Ref<T> gc_ref_make_array(const std::size_t extent)
+{
+    GC_Allocation<T>* const result = detail::gc_allocate_array<T>(extent);
+    for (std::size_t i = 0; i < extent; ++i) {
+        void* const address = result->storage + (i * sizeof(T));
+        new (address) T();
+    }
+    return GC_Ref<T> { &result->node };
+}
+
+/// @brief A monotonic arena from which immortal `GC_Node`s can be allocated.
+/// Nodes made by the arena have a reference count of zero,
+/// so copying and destroying `GC_Ref`s to them does not perform any reference counting.
+/// Instead, all nodes are destroyed and their memory is released wholesale
+/// when the arena is released or destroyed.
+///
+/// The arena also acts as a memory resource for other allocations (e.g. vectors within the AST)
+/// that should share its lifetime.
+struct GC_Arena {
+private:
+    struct Destructor_Entry {
+        GC_Node* node;
+        Destructor_Entry* next;
+    };
+
+    std::pmr::monotonic_buffer_resource m_memory;
+    /// @brief Intrusive list of nodes that need to be destroyed, most recent first.
+    /// Nodes of trivially destructible type are not tracked.
+    Destructor_Entry* m_destructors = nullptr;
+
+public:
+    [[nodiscard]]
+    explicit GC_Arena(std::pmr::memory_resource* upstream = Global_Memory_Resource::get())
+        : m_memory { upstream }
+    {
+    }
+
+    GC_Arena(const GC_Arena&) = delete;
+    GC_Arena& operator=(const GC_Arena&) = delete;
+
+    ~GC_Arena()
+    {
+        release();
+    }
+
+    [[nodiscard]]
+    std::pmr::memory_resource* get_memory() noexcept
+    {
+        return &m_memory;
+    }
+
+    /// @brief Destroys all nodes in reverse order of creation and releases all memory.
+    /// Any `GC_Ref` to a node in this arena is dangling afterwards.
+    void release() noexcept
+    {
+        for (const Destructor_Entry* entry = m_destructors; entry; entry = entry->next) {
+            entry->node->destructor(entry->node->get_object_pointer(), entry->node->extent);
+        }
+        m_destructors = nullptr;
+        m_memory.release();
+    }
+
+    /// @brief Like `gc_ref_make`, but allocates an immortal node within this arena.
+    template <typename T, class... Args>
+        requires std::is_constructible_v<T, Args&&...>
+    [[nodiscard]]
+    GC_Ref<T> make(Args&&... args)
+    {
+        using Allocation = GC_Allocation<T>;
+        auto* result = static_cast<Allocation*>(
+            m_memory.allocate(sizeof(Allocation), alignof(Allocation))
+        );
+
+        result = new (result) Allocation { GC_Node {
+            .reference_count = 0,
+            .extent = 1,
+            .allocation_size = sizeof(Allocation),
+            .allocation_alignment = alignof(Allocation),
+            .destructor = detail::gc_destructor<T>,
+            .heap = nullptr,
+            .immortal = true,
+        } };
+        new (result->storage) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            void* const entry
+                = m_memory.allocate(sizeof(Destructor_Entry), alignof(Destructor_Entry));
+            m_destructors = new (entry) Destructor_Entry { &result->node, m_destructors };
+        }
+        return GC_Ref<T> { &result->node };
+    }
+};
+
 } // namespace cowel
 
 #endif
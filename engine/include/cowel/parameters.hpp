@@ -2,6 +2,9 @@
 #define COWEL_PARAMETERS_HPP
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory_resource>
 #include <optional>
 #include <span>
@@ -10,6 +13,7 @@
 
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/function_ref.hpp"
+#include "cowel/util/perfect_hash.hpp"
 #include "cowel/util/small_vector.hpp"
 #include "cowel/util/source_position.hpp"
 #include "cowel/util/strings.hpp"
@@ -765,65 +769,91 @@ struct Group_Pack_Named_Str_Matcher final
     ) override;
 };
 
-struct Parameter {
-private:
-    std::u8string_view m_name;
-    Optionality m_optionality;
-    Value_Matcher& m_value_matcher;
+/// @brief The name and optionality of a parameter.
+/// The matcher for a parameter is provided separately on each call.
+struct Parameter_Declaration {
+    std::u8string_view name;
+    Optionality optionality;
 
-public:
     [[nodiscard]]
-    constexpr explicit Parameter(
-        std::u8string_view name,
-        Optionality optionality,
-        Value_Matcher& value_matcher
-    )
-        : m_name { name }
-        , m_optionality { optionality }
-        , m_value_matcher { value_matcher }
+    constexpr bool is_mandatory() const
     {
-        COWEL_DEBUG_ASSERT(is_identifier(name));
+        return optionality == Optionality::mandatory;
     }
+};
 
-    [[nodiscard]]
-    std::u8string_view get_name() const
-    {
-        return m_name;
-    }
+/// @brief A non-owning view of the declarations in a `Parameter_Schema`.
+struct Parameter_Schema_View {
+    std::span<const Parameter_Declaration> declarations;
+    /// @brief The `fnv1a_64` hashes of the names in `declarations`.
+    std::span<const std::uint64_t> name_hashes;
 
     [[nodiscard]]
-    bool is_optional() const
+    constexpr std::size_t size() const
     {
-        return m_optionality == Optionality::optional;
+        return declarations.size();
     }
 
+    /// @brief Returns a view of the first `n` declarations.
     [[nodiscard]]
-    bool is_mandatory() const
+    constexpr Parameter_Schema_View first(std::size_t n) const
     {
-        return m_optionality == Optionality::mandatory;
+        return { declarations.first(n), name_hashes.first(n) };
     }
 
+    /// @brief Returns the index of the parameter named `name`, or `-1uz` if there is none.
     [[nodiscard]]
-    Value_Matcher& get_value_matcher()
+    constexpr std::size_t index_of(std::u8string_view name) const
     {
-        return m_value_matcher;
+        const std::uint64_t hash = fnv1a_64(name);
+        for (std::size_t i = 0; i < name_hashes.size(); ++i) {
+            if (name_hashes[i] == hash && declarations[i].name == name) {
+                return i;
+            }
+        }
+        return -1uz;
     }
+};
+
+/// @brief A list of parameter declarations, along with precomputed hashes of their names.
+/// A schema does not depend on any matchers,
+/// so it can be built once for each directive behavior as a `static constexpr` variable,
+/// and be passed to `match_call` together with the matchers of the current invocation.
+template <std::size_t N>
+struct Parameter_Schema {
+    std::array<Parameter_Declaration, N> declarations;
+    std::array<std::uint64_t, N> name_hashes;
+
     [[nodiscard]]
-    const Value_Matcher& get_value_matcher() const
+    consteval explicit Parameter_Schema(const Parameter_Declaration (&decls)[N])
+        : declarations {}
+        , name_hashes {}
     {
-        return m_value_matcher;
+        for (std::size_t i = 0; i < N; ++i) {
+            COWEL_ASSERT(is_identifier(decls[i].name));
+            for (std::size_t j = 0; j < i; ++j) {
+                COWEL_ASSERT(decls[i].name != decls[j].name);
+            }
+            declarations[i] = decls[i];
+            name_hashes[i] = fnv1a_64(decls[i].name);
+        }
     }
 
     [[nodiscard]]
-    const Type& get_type() const
+    constexpr operator Parameter_Schema_View() const
     {
-        return m_value_matcher.get_matchable_type();
+        return { declarations, name_hashes };
     }
 };
 
+/// @brief Matches the arguments of `call` to the parameters in `schema`,
+/// where the `i`-th parameter is matched by `matchers[i]`.
+/// @param on_fail Invoked with a diagnostic message when matching fails.
+/// @param on_fail_status The status returned when matching fails.
 [[nodiscard]]
 Processing_Status match_call(
-    std::span<Parameter* const> parameters,
+    Parameter_Schema_View schema,
+    std::span<Value_Matcher* const> matchers,
     const Invocation& call,
     Context& context,
     Fail_Callback on_fail = make_fail_callback(),
@@ -832,13 +862,14 @@ Processing_Status match_call(
 
 [[nodiscard]]
 inline Processing_Status match_call_fatal_error(
-    const std::span<Parameter* const> parameters,
+    const Parameter_Schema_View schema,
+    const std::span<Value_Matcher* const> matchers,
     const Invocation& call,
     Context& context,
     const Fail_Callback on_fail = make_fail_callback<Severity::fatal>()
 )
 {
-    return match_call(parameters, call, context, on_fail, Processing_Status::fatal);
+    return match_call(schema, matchers, call, context, on_fail, Processing_Status::fatal);
 }
 
 } // namespace cowel
@@ -28,6 +28,11 @@ public:
         m_parent.write(chars, language);
     }
 
+    void write_section_reference(Section_Id id) override
+    {
+        m_parent.write_section_reference(id);
+    }
+
     [[nodiscard]]
     Processing_Status consume(const ast::Primary&, Frame_Index, Context&) override
     {
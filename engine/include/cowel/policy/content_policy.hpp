@@ -1,6 +1,7 @@
 #ifndef COWEL_CONTENT_POLICY_HPP
 #define COWEL_CONTENT_POLICY_HPP
 
+#include <string_view>
 #include <variant>
 
 #include "cowel/util/char_sequence.hpp"
@@ -63,6 +64,25 @@ public:
     /// @returns `true` iff the language was accepted.
     /// `get_language()` is always accepted.
     virtual void write(Char_Sequence8 str, Output_Language language) = 0;
+
+    /// @brief Like `write`, but the caller guarantees that the characters of `str`
+    /// remain valid and unchanged until generation has finished.
+    /// This allows sinks to retain `str` rather than copying its characters.
+    virtual void write_stable(std::u8string_view str, Output_Language language)
+    {
+        write(str, language);
+    }
+
+    /// @brief Writes a reference to the given section,
+    /// i.e. HTML which is replaced with the contents of that section
+    /// once the document is assembled.
+    ///
+    /// Sinks which pass their HTML on to another sink pass the reference on as well,
+    /// and sinks which store HTML (such as `Section_Content`) record the reference
+    /// alongside the text rather than within it.
+    /// By default, the reference is discarded,
+    /// which is appropriate for sinks that do not produce HTML.
+    virtual void write_section_reference(Section_Id) { }
 };
 
 /// @brief A content policy can receive different kinds of content as well as text,
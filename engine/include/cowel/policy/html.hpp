@@ -18,8 +18,8 @@ namespace cowel {
 
 namespace detail {
 
-static constexpr auto is_html_escaped
-    = [](char8_t c) { return c == u8'&' || c == u8'<' || c == u8'>'; };
+/// @brief The code units that are escaped when text is written as HTML.
+inline constexpr std::u8string_view html_escaped_chars = u8"&<>";
 
 inline bool write_as_html(Text_Sink& out, Char_Sequence8 chars)
 {
@@ -35,7 +35,7 @@ inline bool write_as_html(Text_Sink& out, Char_Sequence8 chars)
         static_assert(std::is_same_v<char8_t, T> || std::is_same_v<std::u8string_view, T>);
         out.write(x, Output_Language::html);
     };
-    append_html_escaped(adapter, chars, is_html_escaped);
+    append_html_escaped_of(adapter, chars, html_escaped_chars);
     return true;
 }
 
@@ -91,6 +91,11 @@ public:
         }
     }
 
+    void write_section_reference(Section_Id id) override
+    {
+        m_parent.write_section_reference(id);
+    }
+
     [[nodiscard]]
     Processing_Status consume(const ast::Primary& node, Frame_Index, Context& context) override
     {
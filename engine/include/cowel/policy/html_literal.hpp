@@ -35,6 +35,11 @@ struct HTML_Literal_Content_Policy : virtual HTML_Content_Policy {
         }
     }
 
+    void write_section_reference(Section_Id) override
+    {
+        // Like any other HTML, references are discarded.
+    }
+
     [[nodiscard]]
     Processing_Status consume(const ast::Primary& node, Frame_Index, Context& context) override
     {
@@ -203,6 +203,30 @@ public:
         }
     }
 
+    /// @brief Returns `true` iff text which is written to this policy is split into paragraphs.
+    /// This is the case at the top level,
+    /// and inside directives which have called `inherit_paragraph()`.
+    [[nodiscard]]
+    bool is_splitting() const noexcept
+    {
+        return m_directive_depth == 0;
+    }
+
+    [[nodiscard]]
+    Paragraph_Split_State get_split_state() const noexcept
+    {
+        return { .paragraphs = m_state, .line = m_line_state };
+    }
+
+    /// @brief Restores a state previously obtained from `get_split_state()`.
+    /// This writes no tags, so it is only correct if the output written in the meantime
+    /// has already transitioned to `state`.
+    void set_split_state(const Paragraph_Split_State& state) noexcept
+    {
+        m_state = state.paragraphs;
+        m_line_state = state.line;
+    }
+
     void transition(Paragraphs_State state)
     {
         switch (state) {
@@ -36,6 +36,8 @@ protected:
         html,
         highlight,
         phantom,
+        /// @brief A section reference, whose `Section_Id` is stored as the `begin` of the span.
+        section_reference,
     };
 
     struct Output_Span {
@@ -70,6 +72,13 @@ public:
 
     void write(Char_Sequence8 chars, Output_Language language) override;
 
+    void write_section_reference(Section_Id id) override
+    {
+        if (!has_flags(Text_Sink_Flags::discard_html)) {
+            m_spans.push_back({ Span_Type::section_reference, std::size_t(id), 0 });
+        }
+    }
+
     void write_phantom(Char_Sequence8 chars)
     {
         if constexpr (enable_empty_string_assertions) {
@@ -10,6 +10,7 @@
 
 #include "cowel/policy/content_policy.hpp"
 
+#include "cowel/fwd.hpp"
 #include "cowel/output_language.hpp"
 #include "cowel/settings.hpp"
 
@@ -67,6 +68,14 @@ public:
         }
     }
 
+    /// @brief Flushes the buffer so that the reference is written to the parent sink
+    /// after the text that precedes it.
+    void write_section_reference(const Section_Id id) override
+    {
+        this->flush();
+        this->get_sink().parent.write_section_reference(id);
+    }
+
     /// @brief Returns a string view containing what is currently in the buffer.
     /// This view is invalidated by any operation which changes buffer contents.
     [[nodiscard]]
@@ -17,6 +17,7 @@
 #include "cowel/util/annotated_string.hpp"
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/source_position.hpp"
 
 #include "cowel/diagnostic_highlight.hpp"
@@ -77,6 +78,16 @@ void print_affected_line(
 
 void print_affected_line(Diagnostic_String& out, std::u8string_view source, const Source_Span& pos);
 
+/// @brief Like the other overloads,
+/// but uses `lines` to find the affected line instead of searching `source`.
+/// @param lines The line table of `source`.
+void print_affected_line(
+    Diagnostic_String& out,
+    std::u8string_view source,
+    const Line_Table& lines,
+    const Source_Span& pos
+);
+
 void print_assertion_error(Diagnostic_String& out, const Assertion_Error& error);
 
 void print_internal_error_notice(Diagnostic_String& out);
@@ -3,10 +3,12 @@
 
 #include <filesystem>
 #include <memory_resource>
+#include <optional>
 #include <vector>
 
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/io.hpp"
+#include "cowel/util/line_table.hpp"
 
 #include "cowel/cowel.h"
 #include "cowel/fwd.hpp"
@@ -18,6 +20,8 @@ struct Owned_File_Entry {
     std::filesystem::path path;
     std::u8string path_string;
     std::pmr::vector<char8_t> text;
+    /// @brief The line table for `text`, or `std::nullopt` if the file could not be loaded.
+    std::optional<Line_Table> lines;
 };
 
 /// @brief A `File_Loader` implementation which can be used both as
@@ -64,6 +68,16 @@ public:
         return int(id) < int(m_entries.size());
     }
 
+    [[nodiscard]]
+    const Line_Table* find_line_table(File_Id id) const noexcept final
+    {
+        if (int(id) < 0 || !is_valid(id)) {
+            return nullptr;
+        }
+        const std::optional<Line_Table>& lines = at(id).lines;
+        return lines ? &*lines : nullptr;
+    }
+
     [[nodiscard]]
     std::pmr::memory_resource* get_memory() const
     {
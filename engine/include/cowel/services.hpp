@@ -1,6 +1,7 @@
 #ifndef COWEL_SERVICES_HPP
 #define COWEL_SERVICES_HPP
 
+#include <cstddef>
 #include <memory_resource>
 #include <span>
 #include <string_view>
@@ -11,6 +12,7 @@
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/function_ref.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/typo.hpp"
 
@@ -149,6 +151,14 @@ struct File_Loader {
     [[nodiscard]]
     virtual bool is_valid(File_Id) const noexcept
         = 0;
+
+    /// @brief Returns the line table of a successfully loaded file,
+    /// which is built once when the file is loaded,
+    /// or `nullptr` if there is no such file (including `File_Id::main`).
+    /// The result may be invalidated by subsequent calls to `load`.
+    [[nodiscard]]
+    virtual const Line_Table* find_line_table(File_Id) const noexcept
+        = 0;
 };
 
 struct Always_Failing_File_Loader final : File_Loader {
@@ -163,10 +173,34 @@ struct Always_Failing_File_Loader final : File_Loader {
     {
         return id == File_Id::main;
     }
+
+    [[nodiscard]]
+    const Line_Table* find_line_table(File_Id) const noexcept final
+    {
+        return nullptr;
+    }
 };
 
 inline constinit Always_Failing_File_Loader always_failing_file_loader;
 
+/// @brief A persistent store of serialized ASTs,
+/// which allows skipping lexing and parsing of documents
+/// whose source has not changed since a previous run.
+/// Keys are obtained using `ast_cache_key`, and values are produced by `serialize_flat_ast`.
+struct AST_Cache {
+    /// @brief Returns the data previously stored under `key`,
+    /// or an empty span if there is no such entry.
+    /// The returned data shall remain valid until generation has finished.
+    [[nodiscard]]
+    virtual std::span<const std::byte> load(std::u8string_view key)
+        = 0;
+
+    /// @brief Stores `data` under `key`.
+    /// Since storing is merely an optimization for subsequent runs,
+    /// failure to do so is not an error.
+    virtual void store(std::u8string_view key, std::span<const std::byte> data) = 0;
+};
+
 struct Logger {
 private:
     Severity m_min_severity;
@@ -0,0 +1,57 @@
+#ifndef COWEL_STACK_BUDGET_HPP
+#define COWEL_STACK_BUDGET_HPP
+
+#include <cstddef>
+
+namespace cowel {
+
+// Lexing, parsing, building the AST, evaluating expressions, and processing directives
+// all recurse on the native stack.
+// Rather than replacing that recursion with explicit stacks,
+// the depth of the recursion is limited by `max_nesting_depth` (in the syntax)
+// and by `default_max_call_depth` (for directive invocations),
+// and these limits are derived from the constants below,
+// so that generation with default options fits into `stack_budget`:
+//
+//     stack_budget_reserve
+//         + max_nesting_depth * stack_cost_per_nesting_level
+//         + default_max_call_depth * stack_cost_per_call
+//     <= stack_budget
+//
+// Both recursions can be on the stack at the same time,
+// such as when a document included by a deeply nested `\cowel_include` is parsed,
+// so their costs are added up.
+//
+// The costs were measured by nesting each kind of construct and directive invocation
+// and comparing the stack high-water mark at two depths,
+// in an optimized (-O2) x86-64 build with GCC, and then rounded up.
+// Unoptimized builds need more stack space per level and are not covered by this guarantee;
+// they are merely protected against unbounded recursion.
+
+/// @brief The native stack size that generation with default limits is guaranteed to fit into.
+/// This is the default stack size of the main thread on Windows,
+/// which is the smallest among the common desktop platforms.
+/// Threads with smaller stacks need a lower `max_call_depth`.
+inline constexpr std::size_t stack_budget = 1024 * 1024;
+
+/// @brief The part of `stack_budget` that is reserved for everything except the recursion,
+/// such as the caller of cowel and the non-recursive parts of generation.
+/// A trivial document uses 16 to 60 KiB.
+inline constexpr std::size_t stack_budget_reserve = 64 * 1024;
+
+/// @brief The stack space consumed by each level of syntactic nesting.
+/// The most expensive construct is a parenthesized operand of a binary expression
+/// at 3.2 KiB per level, followed by blocks at 2.5 KiB,
+/// covering lexing, parsing, building the AST, and evaluation.
+inline constexpr std::size_t stack_cost_per_nesting_level = 4 * 1024;
+
+/// @brief The stack space consumed by each nested directive invocation.
+/// The most expensive invocation is that of a directive whose quoted string argument
+/// contains the next directive, at 5.3 KiB per invocation,
+/// followed by HTML formatting directives such as `\b` at 3.3 KiB.
+/// Macro expansions cost 0.5 to 1.3 KiB.
+inline constexpr std::size_t stack_cost_per_call = 6 * 1024;
+
+} // namespace cowel
+
+#endif
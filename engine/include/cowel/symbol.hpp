@@ -0,0 +1,116 @@
+#ifndef COWEL_SYMBOL_HPP
+#define COWEL_SYMBOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/transparent_comparison.hpp"
+
+#include "cowel/fwd.hpp"
+
+namespace cowel {
+
+/// @brief Interns names, so that they can be identified by a `Symbol`.
+/// Maps keyed by `Symbol` are cheaper to look up than maps keyed by strings
+/// because the name only has to be hashed once when it is interned,
+/// and symbols can be cached (e.g. in `ast::Primary`).
+struct Symbol_Table {
+private:
+    /// @brief Stores the characters of all interned names.
+    std::pmr::monotonic_buffer_resource m_name_memory;
+    /// @brief The interned names, indexed by symbol.
+    std::pmr::vector<std::u8string_view> m_names;
+    std::pmr::unordered_map<
+        std::u8string_view,
+        Symbol,
+        Transparent_String_View_Hash8,
+        Transparent_String_View_Equals8>
+        m_symbols;
+    /// @brief Reused by `intern` to join the parts of a name.
+    std::pmr::u8string m_join_buffer;
+
+public:
+    [[nodiscard]]
+    explicit Symbol_Table(std::pmr::memory_resource* memory)
+        : m_name_memory { memory }
+        , m_names { memory }
+        , m_symbols { memory }
+        , m_join_buffer { memory }
+    {
+    }
+
+    Symbol_Table(const Symbol_Table&) = delete;
+    Symbol_Table& operator=(const Symbol_Table&) = delete;
+
+    /// @brief Returns the symbol for `name`,
+    /// which is created if `name` has not been interned yet.
+    [[nodiscard]]
+    Symbol intern(std::u8string_view name)
+    {
+        if (const auto it = m_symbols.find(name); it != m_symbols.end()) {
+            return it->second;
+        }
+        COWEL_ASSERT(m_names.size() < std::size_t(Uint32(-1)));
+        auto* const chars = static_cast<char8_t*>(m_name_memory.allocate(name.size(), 1));
+        std::ranges::copy(name, chars);
+        const std::u8string_view stored { chars, name.size() };
+
+        const auto symbol = Symbol(m_names.size());
+        m_names.push_back(stored);
+        m_symbols.emplace(stored, symbol);
+        return symbol;
+    }
+
+    /// @brief Like `intern(std::u8string_view)`,
+    /// but interns the concatenation of `parts` as a name.
+    /// The parts are joined in a buffer that is reused between calls,
+    /// so unlike joining them into a new string,
+    /// this does not allocate if the name has already been interned.
+    [[nodiscard]]
+    Symbol intern(std::span<const std::u8string_view> parts)
+    {
+        m_join_buffer.clear();
+        for (const std::u8string_view part : parts) {
+            m_join_buffer += part;
+        }
+        return intern(std::u8string_view { m_join_buffer });
+    }
+
+    /// @brief Returns the symbol for `name`,
+    /// or `std::nullopt` if `name` has not been interned.
+    /// This is useful for lookups because a name that was never interned
+    /// cannot be the key of any entry in a map keyed by `Symbol`.
+    [[nodiscard]]
+    std::optional<Symbol> find(std::u8string_view name) const
+    {
+        const auto it = m_symbols.find(name);
+        return it == m_symbols.end() ? std::nullopt : std::optional<Symbol> { it->second };
+    }
+
+    /// @brief Returns the name that `symbol` was interned from.
+    [[nodiscard]]
+    std::u8string_view get_name(Symbol symbol) const
+    {
+        COWEL_DEBUG_ASSERT(std::size_t(symbol) < m_names.size());
+        return m_names[std::size_t(symbol)];
+    }
+
+    /// @brief Returns the number of interned names.
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return m_names.size();
+    }
+};
+
+} // namespace cowel
+
+#endif
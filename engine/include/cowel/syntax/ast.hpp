@@ -133,6 +133,7 @@ private:
         std::monostate, // No extra.
         std::size_t, // Length of comment suffix.
         Fixed_String8<4>, // UTF-8 code units for escape sequences.
+        bool, // Value of bool literal.
         Big_Int, // Parsed int value.
         Parsed_Float, // Parsed float value.
         Pmr_Vector<Markup_Element>, // Markup elements of block or quoted string.
@@ -180,13 +181,34 @@ public:
         Pmr_Vector<Group_Member>&& members
     );
 
+    /// @brief Constructs a `bool_literal` which is the result of constant folding.
+    /// The `source_span` and `source` are those of the folded expression,
+    /// so they do not spell out the value.
+    [[nodiscard]]
+    static Primary folded_bool(File_Source_Span source_span, std::u8string_view source, bool value);
+
+    /// @brief Like `folded_bool`, but for an `int_literal`.
+    [[nodiscard]]
+    static Primary
+    folded_integer(File_Source_Span source_span, std::u8string_view source, const Big_Int& value);
+
+    /// @brief Like `folded_bool`, but for a `decimal_float_literal`.
+    [[nodiscard]]
+    static Primary
+    folded_float(File_Source_Span source_span, std::u8string_view source, Float value);
+
 private:
     Primary_Kind m_kind;
     String_Kind m_string_kind;
     File_Source_Span m_source_span;
     std::u8string_view m_source;
     Extra_Variant m_extra;
+    bool m_folded = false;
     mutable bool m_symbolized = false;
+    /// @brief For an *id-expression*, the symbol that its name was interned as,
+    /// which is only valid for the context whose symbol epoch is `m_symbol_epoch`.
+    mutable Symbol m_symbol {};
+    mutable Definition_Epoch m_symbol_epoch = Definition_Epoch::none;
 
     [[nodiscard]]
     Primary(
@@ -194,7 +216,8 @@ private:
         File_Source_Span source_span,
         std::u8string_view source,
         Extra_Variant&& extra,
-        String_Kind string_kind = String_Kind::unknown
+        String_Kind string_kind = String_Kind::unknown,
+        bool folded = false
     );
 
 public:
@@ -248,11 +271,19 @@ public:
         return m_source;
     }
 
+    /// @brief Returns `true` iff this literal is the result of constant folding,
+    /// in which case its source is that of the folded expression.
+    [[nodiscard]]
+    bool is_folded() const
+    {
+        return m_folded;
+    }
+
     [[nodiscard]]
     bool get_bool_value() const
     {
         COWEL_ASSERT(m_kind == Primary_Kind::bool_literal);
-        return m_source == u8"true";
+        return std::get<bool>(m_extra);
     }
 
     [[nodiscard]]
@@ -322,6 +353,8 @@ public:
         );
     }
 
+    [[nodiscard]]
+    std::span<Markup_Element> get_elements();
     [[nodiscard]]
     std::span<const Markup_Element> get_elements() const;
 
@@ -339,6 +372,8 @@ public:
         return get_elements().size();
     }
 
+    [[nodiscard]]
+    std::span<Group_Member> get_members();
     [[nodiscard]]
     std::span<const Group_Member> get_members() const;
 
@@ -367,6 +402,24 @@ public:
         m_symbolized = true;
     }
 
+    /// @brief Returns the symbol previously stored with `cache_symbol` for `epoch`,
+    /// or `std::nullopt` if there is none.
+    [[nodiscard]]
+    std::optional<Symbol> get_cached_symbol(Definition_Epoch epoch) const
+    {
+        return epoch == m_symbol_epoch ? std::optional<Symbol> { m_symbol } : std::nullopt;
+    }
+
+    /// @brief Remembers that the name of this *id-expression* was interned as `symbol`
+    /// by the context with the given symbol `epoch`.
+    void cache_symbol(Symbol symbol, Definition_Epoch epoch) const
+    {
+        COWEL_DEBUG_ASSERT(m_kind == Primary_Kind::id_expression);
+        COWEL_DEBUG_ASSERT(epoch != Definition_Epoch::none);
+        m_symbol = symbol;
+        m_symbol_epoch = epoch;
+    }
+
     void swap(Primary& other) noexcept;
 
 private:
@@ -395,6 +448,16 @@ private:
     std::optional<Primary> m_arguments;
     std::optional<Primary> m_content;
     mutable bool m_symbolized = false;
+    /// @brief The behavior that `m_name` was last resolved to,
+    /// which is only valid while the context is in `m_cached_behavior_epoch`.
+    ///
+    /// This cache is mutated through `const` references without synchronization,
+    /// so the same `Directive` must not be processed from multiple contexts concurrently,
+    /// even if it is only ever accessed as `const`.
+    /// Processing it from multiple contexts sequentially is fine
+    /// because epochs are unique across all contexts.
+    mutable const Directive_Behavior* m_cached_behavior = nullptr;
+    mutable Definition_Epoch m_cached_behavior_epoch = Definition_Epoch::none;
 
 public:
     [[nodiscard]]
@@ -492,6 +555,23 @@ public:
     {
         m_symbolized = true;
     }
+
+    /// @brief Returns the behavior previously stored with `cache_behavior` for `epoch`,
+    /// or null if there is none.
+    [[nodiscard]]
+    const Directive_Behavior* get_cached_behavior(Definition_Epoch epoch) const
+    {
+        return epoch == m_cached_behavior_epoch ? m_cached_behavior : nullptr;
+    }
+
+    /// @brief Remembers that the name of this directive resolves to `behavior` in `epoch`.
+    void cache_behavior(const Directive_Behavior* behavior, Definition_Epoch epoch) const
+    {
+        COWEL_DEBUG_ASSERT(behavior);
+        COWEL_DEBUG_ASSERT(epoch != Definition_Epoch::none);
+        m_cached_behavior = behavior;
+        m_cached_behavior_epoch = epoch;
+    }
 };
 
 static_assert(std::is_copy_constructible_v<Directive>);
@@ -523,6 +603,11 @@ public:
     Unary_Expression& operator=(Unary_Expression&&) noexcept;
     ~Unary_Expression();
 
+    [[nodiscard]]
+    Expression& get_operand()
+    {
+        return *m_operand;
+    }
     [[nodiscard]]
     const Expression& get_operand() const
     {
@@ -579,12 +664,22 @@ public:
     Binary_Expression& operator=(Binary_Expression&&) noexcept;
     ~Binary_Expression();
 
+    [[nodiscard]]
+    Expression& get_lhs()
+    {
+        return *m_lhs;
+    }
     [[nodiscard]]
     const Expression& get_lhs() const
     {
         return *m_lhs;
     }
     [[nodiscard]]
+    Expression& get_rhs()
+    {
+        return *m_rhs;
+    }
+    [[nodiscard]]
     const Expression& get_rhs() const
     {
         return *m_rhs;
@@ -652,6 +747,11 @@ public:
         return m_name_span;
     }
 
+    [[nodiscard]]
+    Expression& get_value()
+    {
+        return *m_value;
+    }
     [[nodiscard]]
     const Expression& get_value() const
     {
@@ -684,6 +784,10 @@ struct Expression : Expression_Variant {
 private:
     File_Source_Span m_source_span;
     std::u8string_view m_source;
+    /// @brief The bytecode that this expression was compiled to,
+    /// which is owned by the context whose bytecode epoch is `m_bytecode_epoch`.
+    mutable const Bytecode_Program* m_bytecode = nullptr;
+    mutable Definition_Epoch m_bytecode_epoch = Definition_Epoch::none;
 
 public:
     // Because we also need the constructors to copy the `m_source_span` member,
@@ -881,6 +985,24 @@ public:
     {
         return m_source;
     }
+
+    /// @brief Returns the bytecode previously stored with `cache_bytecode` for `epoch`,
+    /// or null if there is none.
+    [[nodiscard]]
+    const Bytecode_Program* get_cached_bytecode(Definition_Epoch epoch) const
+    {
+        return epoch == m_bytecode_epoch ? m_bytecode : nullptr;
+    }
+
+    /// @brief Remembers that this expression was compiled to `program`
+    /// by the context with the given bytecode `epoch`.
+    void cache_bytecode(const Bytecode_Program* program, Definition_Epoch epoch) const
+    {
+        COWEL_DEBUG_ASSERT(program);
+        COWEL_DEBUG_ASSERT(epoch != Definition_Epoch::none);
+        m_bytecode = program;
+        m_bytecode_epoch = epoch;
+    }
 };
 
 static_assert(std::is_copy_constructible_v<Expression>);
@@ -905,6 +1027,15 @@ public:
     static Group_Member positional( //
         Expression&& value
     );
+    [[nodiscard]]
+    static Group_Member named( //
+        GC_Ref<Primary> name,
+        GC_Ref<Expression> value
+    );
+    [[nodiscard]]
+    static Group_Member positional( //
+        GC_Ref<Expression> value
+    );
 
 private:
     File_Source_Span m_source_span;
@@ -981,6 +1112,11 @@ public:
         return bool(m_value);
     }
 
+    [[nodiscard]]
+    Expression& get_value()
+    {
+        return *m_value;
+    }
     [[nodiscard]]
     const Expression& get_value() const
     {
@@ -1128,12 +1264,24 @@ inline Directive& Directive::operator=(Directive&&) noexcept = default;
 inline Directive& Directive::operator=(const Directive&) = default;
 inline Directive::~Directive() = default;
 
+inline std::span<Markup_Element> Primary::get_elements()
+{
+    COWEL_DEBUG_ASSERT(m_kind == Primary_Kind::block || m_kind == Primary_Kind::quoted_string);
+    return std::get<Pmr_Vector<Markup_Element>>(m_extra);
+}
+
 inline std::span<const Markup_Element> Primary::get_elements() const
 {
     COWEL_DEBUG_ASSERT(m_kind == Primary_Kind::block || m_kind == Primary_Kind::quoted_string);
     return std::get<Pmr_Vector<Markup_Element>>(m_extra);
 }
 
+inline std::span<Group_Member> Primary::get_members()
+{
+    COWEL_DEBUG_ASSERT(m_kind == Primary_Kind::group);
+    return std::get<Pmr_Vector<Group_Member>>(m_extra);
+}
+
 inline std::span<const Group_Member> Primary::get_members() const
 {
     COWEL_DEBUG_ASSERT(m_kind == Primary_Kind::group);
@@ -0,0 +1,347 @@
+#ifndef COWEL_AST_CACHE_HPP
+#define COWEL_AST_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/fixed_string.hpp"
+#include "cowel/util/line_table.hpp"
+#include "cowel/util/source_position.hpp"
+
+#include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
+#include "cowel/services.hpp"
+
+#include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/expression_kind.hpp"
+#include "cowel/syntax/parse.hpp"
+
+namespace cowel {
+
+/// @brief A 32-bit index into one of the node arrays of a `Flat_AST`.
+using Flat_Index = std::uint32_t;
+
+/// @brief The `Flat_Index` representing the absence of a node,
+/// such as a directive without arguments.
+inline constexpr Flat_Index no_flat_index = Flat_Index(-1);
+
+enum struct Flat_Node_Kind : Default_Underlying {
+    /// @brief Index into `Flat_AST::directives`.
+    directive,
+    /// @brief Index into `Flat_AST::primaries`.
+    primary,
+    /// @brief Index into `Flat_AST::expressions`.
+    expression,
+    /// @brief Index into `Flat_AST::unary_expressions`.
+    unary_expression,
+    /// @brief Index into `Flat_AST::binary_expressions`.
+    binary_expression,
+    /// @brief Index into `Flat_AST::let_expressions`.
+    let_expression,
+};
+
+/// @brief A reference to a node of any kind within a `Flat_AST`.
+struct Flat_Ref {
+    Flat_Node_Kind kind;
+    Flat_Index index;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(Flat_Ref, Flat_Ref)
+        = default;
+};
+
+/// @brief A contiguous range of nodes within one of the arrays of a `Flat_AST`.
+struct Flat_Range {
+    Flat_Index first;
+    std::uint32_t size;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(Flat_Range, Flat_Range)
+        = default;
+};
+
+/// @brief A compact `Source_Span` with 32-bit members.
+/// The file is stored only once within the `Flat_AST`.
+struct Flat_Span {
+    std::uint32_t line;
+    std::uint32_t column;
+    std::uint32_t begin;
+    std::uint32_t length;
+
+    [[nodiscard]]
+    static Flat_Span from(const Source_Span& span)
+    {
+        COWEL_DEBUG_ASSERT(span.begin + span.length <= std::uint32_t(-1));
+        return {
+            .line = std::uint32_t(span.line),
+            .column = std::uint32_t(span.column),
+            .begin = std::uint32_t(span.begin),
+            .length = std::uint32_t(span.length),
+        };
+    }
+
+    [[nodiscard]]
+    File_Source_Span to_file_span(File_Id file) const
+    {
+        return { Source_Position { .line = line, .column = column, .begin = begin }, length, file };
+    }
+
+    [[nodiscard]]
+    friend constexpr bool operator==(Flat_Span, Flat_Span)
+        = default;
+};
+
+struct Flat_Directive {
+    Flat_Span span;
+    /// @brief The offset of the name relative to `span.begin`.
+    std::uint32_t name_offset;
+    std::uint32_t name_length;
+    /// @brief Index into `Flat_AST::primaries` of the group, or `no_flat_index`.
+    Flat_Index arguments;
+    /// @brief Index into `Flat_AST::primaries` of the block, or `no_flat_index`.
+    Flat_Index content;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Directive&, const Flat_Directive&)
+        = default;
+};
+
+struct Flat_Primary {
+    Flat_Span span;
+    ast::Primary_Kind kind;
+    /// @brief For blocks and quoted strings, the range within `Flat_AST::element_refs`.
+    /// For groups, the range within `Flat_AST::members`.
+    /// Empty for all other primaries.
+    Flat_Range children;
+    /// @brief For escapes, the escaped code point,
+    /// or `char32_t(-1)` if a line break is escaped.
+    /// Zero for all other primaries.
+    ///
+    /// Other values, such as those of integer literals, are not stored,
+    /// but computed from the source when the AST is inflated.
+    char32_t code_point;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Primary&, const Flat_Primary&)
+        = default;
+};
+
+struct Flat_Member {
+    Flat_Span span;
+    ast::Member_Kind kind;
+    /// @brief Index into `Flat_AST::primaries` of the name, or `no_flat_index`.
+    Flat_Index name;
+    /// @brief Index into `Flat_AST::expressions` of the value, or `no_flat_index`.
+    Flat_Index value;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Member&, const Flat_Member&)
+        = default;
+};
+
+/// @brief Corresponds to `ast::Expression`,
+/// which may have a different source span than the nested expression.
+struct Flat_Expression {
+    Flat_Span span;
+    /// @brief The nested expression,
+    /// which is a directive, primary, unary, binary, or let expression.
+    Flat_Ref inner;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Expression&, const Flat_Expression&)
+        = default;
+};
+
+struct Flat_Unary_Expression {
+    Flat_Span span;
+    Unary_Expression_Kind kind;
+    /// @brief Index into `Flat_AST::expressions`.
+    Flat_Index operand;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Unary_Expression&, const Flat_Unary_Expression&)
+        = default;
+};
+
+struct Flat_Binary_Expression {
+    Flat_Span span;
+    Binary_Expression_Kind kind;
+    /// @brief Index into `Flat_AST::expressions`.
+    Flat_Index lhs;
+    /// @brief Index into `Flat_AST::expressions`.
+    Flat_Index rhs;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Binary_Expression&, const Flat_Binary_Expression&)
+        = default;
+};
+
+struct Flat_Let_Expression {
+    Flat_Span span;
+    Flat_Span name_span;
+    /// @brief Index into `Flat_AST::expressions`.
+    Flat_Index value;
+
+    [[nodiscard]]
+    friend constexpr bool operator==(const Flat_Let_Expression&, const Flat_Let_Expression&)
+        = default;
+};
+
+static_assert(std::is_trivially_copyable_v<Flat_Ref>);
+static_assert(std::is_trivially_copyable_v<Flat_Directive>);
+static_assert(std::is_trivially_copyable_v<Flat_Primary>);
+static_assert(std::is_trivially_copyable_v<Flat_Member>);
+static_assert(std::is_trivially_copyable_v<Flat_Expression>);
+static_assert(std::is_trivially_copyable_v<Flat_Unary_Expression>);
+static_assert(std::is_trivially_copyable_v<Flat_Binary_Expression>);
+static_assert(std::is_trivially_copyable_v<Flat_Let_Expression>);
+
+/// @brief The form in which an `AST_Cache` stores an AST,
+/// where nodes live in contiguous arrays (one per kind of node)
+/// and refer to each other using 32-bit indices instead of pointers.
+///
+/// This is trivially serializable because all nodes are trivially copyable
+/// and all positions are relative to `source`.
+/// It is only an interchange format;
+/// directive processing operates on the AST in `ast.hpp`,
+/// which is obtained using `inflate_ast`.
+struct Flat_AST {
+    /// @brief The source code that all spans within this AST refer to.
+    /// This is not owned by the AST and has to be set prior to inflating it.
+    std::u8string_view source;
+    File_Id file = File_Id::main;
+    /// @brief The range within `element_refs` of the top-level markup elements.
+    Flat_Range roots {};
+
+    /// @brief References to directives, primaries, and expressions
+    /// that are markup elements within blocks, quoted strings, or the top level.
+    std::pmr::vector<Flat_Ref> element_refs;
+    std::pmr::vector<Flat_Directive> directives;
+    std::pmr::vector<Flat_Primary> primaries;
+    std::pmr::vector<Flat_Member> members;
+    std::pmr::vector<Flat_Expression> expressions;
+    std::pmr::vector<Flat_Unary_Expression> unary_expressions;
+    std::pmr::vector<Flat_Binary_Expression> binary_expressions;
+    std::pmr::vector<Flat_Let_Expression> let_expressions;
+
+    [[nodiscard]]
+    explicit Flat_AST(std::pmr::memory_resource* memory)
+        : element_refs { memory }
+        , directives { memory }
+        , primaries { memory }
+        , members { memory }
+        , expressions { memory }
+        , unary_expressions { memory }
+        , binary_expressions { memory }
+        , let_expressions { memory }
+    {
+    }
+
+    void clear() noexcept
+    {
+        roots = {};
+        element_refs.clear();
+        directives.clear();
+        primaries.clear();
+        members.clear();
+        expressions.clear();
+        unary_expressions.clear();
+        binary_expressions.clear();
+        let_expressions.clear();
+    }
+
+    [[nodiscard]]
+    std::u8string_view get_source(const Flat_Span& span) const
+    {
+        COWEL_DEBUG_ASSERT(span.begin + span.length <= source.length());
+        return source.substr(span.begin, span.length);
+    }
+};
+
+/// @brief Appends the given AST to `out` and sets `out.roots` to the range of `content`.
+/// Every element of `content` shall have been built from `out.source` and `out.file`.
+void flatten_ast(Flat_AST& out, std::span<const ast::Markup_Element> content);
+
+/// @brief Converts the top-level elements of `ast` into the AST representation of `ast.hpp`
+/// and appends them to `out`.
+/// `ast.source` shall be the source code that `ast` was created from.
+/// @param arena If not null, the arena in which expressions are allocated.
+/// Otherwise, they are allocated as reference-counted nodes.
+void inflate_ast(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    const Flat_AST& ast,
+    std::pmr::memory_resource* memory,
+    GC_Arena* arena = nullptr
+);
+
+/// @brief The version of the binary format produced by `serialize_flat_ast`.
+/// This has to be incremented whenever the layout of the format or of any `Flat_AST` node
+/// changes, or when the parser would produce a different AST for the same source.
+inline constexpr std::uint32_t ast_cache_format_version = 1;
+
+/// @brief The length of keys returned by `ast_cache_key`.
+inline constexpr std::size_t ast_cache_key_length = 32;
+
+using AST_Cache_Key = Fixed_String8<ast_cache_key_length>;
+
+/// @brief Returns a key under which the AST of `source` is stored in an `AST_Cache`.
+/// The key is a 128-bit hash of `source`,
+/// the engine version, and `ast_cache_format_version`,
+/// written as lowercase hexadecimal digits,
+/// so it can be used directly as a file name.
+[[nodiscard]]
+AST_Cache_Key ast_cache_key(std::u8string_view source);
+
+/// @brief Appends a binary representation of `ast` to `out`.
+/// The representation consists of a fixed-size header followed by the node arrays of `ast`,
+/// each stored verbatim and aligned to eight bytes,
+/// so that it can be read back with a handful of `std::memcpy` calls
+/// (or accessed in place when the data is memory-mapped).
+///
+/// `ast.source` and `ast.file` are not stored; only the length of `ast.source` is.
+void serialize_flat_ast(std::pmr::vector<std::byte>& out, const Flat_AST& ast);
+
+/// @brief Replaces the contents of `out` with the AST stored in `data`,
+/// which shall have been produced by `serialize_flat_ast` for the source `out.source`.
+/// `out.source` and `out.file` are left unchanged.
+///
+/// Every index and span in `data` is validated,
+/// as are the code points of escapes and the sources of literals,
+/// so that the resulting AST can be safely inflated even if `data` is corrupted.
+/// @returns `true` on success, `false` if `data` is not a valid AST for `out.source`,
+/// in which case `out` is left in an unspecified but valid state.
+[[nodiscard]]
+bool deserialize_flat_ast(Flat_AST& out, std::span<const std::byte> data);
+
+/// @brief Like `lex_and_parse_and_build`,
+/// but first tries to load the AST from `cache`,
+/// and stores the AST in `cache` on a cache miss if parsing succeeds.
+/// On a cache hit, no lexing or parsing takes place, and `on_error` is never invoked,
+/// given that only ASTs of sources without errors are stored.
+/// @param lines The line table of `source`, or null if a new one should be built.
+/// @param cache The cache, or null if caching should not take place,
+/// in which case this is equivalent to `lex_and_parse_and_build`.
+/// @param memory The memory used for the AST if `arena` is null, and for temporary buffers.
+/// @param arena If not null, the arena in which the AST is allocated.
+[[nodiscard]]
+bool lex_and_parse_and_build_cached(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    std::u8string_view source,
+    const Line_Table* lines,
+    File_Id file,
+    AST_Cache* cache,
+    std::pmr::memory_resource* memory,
+    GC_Arena* arena,
+    Parse_Error_Consumer on_error = {}
+);
+
+} // namespace cowel
+
+#endif
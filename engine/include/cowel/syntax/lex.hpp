@@ -1,14 +1,18 @@
 #ifndef COWEL_LEX_HPP
 #define COWEL_LEX_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
 #include <vector>
 
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/function_ref.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/source_position.hpp"
 
 #include "cowel/fwd.hpp"
+#include "cowel/stack_budget.hpp"
 
 namespace cowel {
 
@@ -69,6 +73,9 @@ enum struct Token_Kind : Default_Underlying {
     COWEL_TOKEN_KIND_ENUM_DATA(COWEL_TOKEN_KIND_ENUMERATOR)
 };
 
+/// @brief A token in the lexed source.
+/// To keep the token stream compact, tokens only store their offset and length;
+/// line and column numbers can be obtained from a `Line_Table` when needed.
 struct Token {
     static constexpr auto no_code_point = char32_t(-1);
     /// @brief The kind of token.
@@ -77,10 +84,48 @@ struct Token {
     /// or `no_code_point` to indicate that there is no code point
     /// (in the case of whitespace escapes).
     char32_t code_point;
-    /// @brief The location of the token in the lexed source.
-    Source_Span location;
+    /// @brief The offset of the first code unit of the token in the lexed source.
+    std::uint32_t begin;
+    /// @brief The length of the token, in code units.
+    std::uint32_t length;
+
+    /// @brief Returns the one-past-the-end offset of the token in the lexed source.
+    [[nodiscard]]
+    constexpr std::size_t end() const
+    {
+        return std::size_t(begin) + length;
+    }
+
+    /// @brief Returns the location of the token in the lexed source.
+    [[nodiscard]]
+    Source_Span location(const Line_Table& lines) const
+    {
+        return lines.span_at(begin, length);
+    }
 };
 
+static_assert(sizeof(Token) == 16);
+
+/// @brief The greatest source length that can be lexed,
+/// limited by the size of offsets stored in `Token`.
+inline constexpr std::size_t max_lex_source_length = std::uint32_t(-1);
+
+/// @brief The greatest depth to which syntactic constructs can be nested.
+/// `lex` limits the nesting of blocks and quoted strings,
+/// and `parse` limits the nesting of groups and expressions.
+///
+/// Since lexing, parsing, and all later traversals of the AST are recursive,
+/// this bounds the native stack space they need, no matter how deeply a document is nested.
+/// At `stack_cost_per_nesting_level`, this takes up half of the `stack_budget`
+/// which remains after the reserve,
+/// and the other half is left to `default_max_call_depth`.
+inline constexpr std::size_t max_nesting_depth = 96;
+
+static_assert(
+    max_nesting_depth * stack_cost_per_nesting_level
+    <= (stack_budget - stack_budget_reserve) / 2
+);
+
 using Lex_Error_Consumer = Function_Ref<
     void(std::u8string_view id, const Source_Span& location, Char_Sequence8 message)>;
 
@@ -90,6 +135,14 @@ std::u8string_view token_kind_name(Token_Kind kind);
 [[nodiscard]]
 std::u8string_view token_kind_source(Token_Kind kind);
 
+/// @brief Lexes `source`, appending the resulting tokens to `out`.
+/// If `source` is longer than `max_lex_source_length`, reports an error and emits no tokens.
+/// If blocks and quoted strings are nested more deeply than `max_nesting_depth`,
+/// reports an error and stops lexing at the construct that is too deep.
+/// @param on_error If not empty, invoked whenever a lex error is encountered.
+/// Since tokens don't store line and column numbers,
+/// these are only computed (using a `Line_Table`) when an error actually occurs.
+/// @return `true` iff lexing succeeded without errors.
 bool lex(
     std::pmr::vector<Token>& out, //
     std::u8string_view source,
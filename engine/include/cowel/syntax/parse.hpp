@@ -12,6 +12,7 @@
 #include "cowel/util/function_ref.hpp"
 
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 
 #include "cowel/syntax/ast.hpp"
 #include "cowel/syntax/lex.hpp"
@@ -153,24 +154,77 @@ bool cst_instruction_kind_advances(CST_Instruction_Kind);
 using Parse_Error_Consumer = Function_Ref<
     void(std::u8string_view id, const Source_Span& location, Char_Sequence8 message)>;
 
+/// @brief Invoked by `parse_incrementally` with the instructions for a single
+/// markup element at the top level of the document.
+/// @param first_token The index of the first token that belongs to the markup element.
+using Markup_Element_Instructions_Consumer
+    = Function_Ref<void(std::size_t first_token, std::span<const CST_Instruction> instructions)>;
+
+/// @brief Counts the work done by `parse`,
+/// which is useful for verifying that parsing takes linear time.
+struct Parse_Statistics {
+    /// @brief The number of times that the parser advanced past a token,
+    /// including tokens that were parsed again after backtracking.
+    std::size_t tokens_consumed = 0;
+};
+
 /// @brief Parses the COWEL document.
 /// This process does not result in an AST,
 /// but a vector of instructions that can be used to construct an CST.
 /// In essence, this is a serialized and/or linearized CST.
 /// @param out A vector where instructions for constructing a syntax tree are emitted.
+/// @param source The source from which `tokens` were obtained.
+/// This is only used to determine line and column numbers for diagnostics.
 /// @param tokens The input tokens.
 /// These shall be obtained from a successful call to `lex`.
 /// @param on_error If not empty, invoked whenever a parse error is encountered.
+/// @param statistics If not null, the work done by the parser is added to it.
 /// @returns `true` iff parsing succeeded without any errors.
 [[nodiscard]]
 bool parse(
     std::pmr::vector<CST_Instruction>& out,
+    std::u8string_view source,
+    std::span<const Token> tokens,
+    Parse_Error_Consumer on_error = {},
+    Parse_Statistics* statistics = nullptr
+);
+
+/// @brief Like `parse`, but instead of emitting the instructions for the whole document,
+/// passes the instructions for each top-level markup element to `on_element`
+/// as soon as that element has been parsed.
+/// The `push_document` and `pop_document` instructions are not emitted.
+///
+/// Once an error has been encountered, `on_element` is no longer invoked,
+/// but parsing continues so that all errors are reported.
+/// @param buffer A buffer which holds the instructions of the current markup element.
+/// It is cleared after each element,
+/// so it only ever grows as large as the largest top-level markup element requires.
+/// @returns `true` iff parsing succeeded without any errors.
+[[nodiscard]]
+bool parse_incrementally(
+    std::pmr::vector<CST_Instruction>& buffer,
+    std::u8string_view source,
     std::span<const Token> tokens,
+    Markup_Element_Instructions_Consumer on_element,
     Parse_Error_Consumer on_error = {}
 );
 
 /// @brief Builds an AST from a span of instructions,
 /// usually obtained from `parse`.
+/// @param lines The line table of `source`,
+/// which is used to determine the line and column of each AST node.
+void build_ast(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    std::u8string_view source,
+    const Line_Table& lines,
+    File_Id file,
+    std::span<const Token> tokens,
+    std::span<const CST_Instruction> instructions,
+    std::pmr::memory_resource* memory
+);
+
+/// @brief Like the other overload,
+/// but builds a new line table for `source`.
 void build_ast(
     ast::Pmr_Vector<ast::Markup_Element>& out,
     std::u8string_view source,
@@ -191,19 +245,120 @@ ast::Pmr_Vector<ast::Markup_Element> build_ast(
     std::pmr::memory_resource* memory
 );
 
-/// @brief Parses a document via `parse(out, tokens, on_error)`.
-/// If `parse` returns `true`, runs `build_ast` on the resulting parse instructions.
-/// Otherwise, returns `false`.
+/// @brief Reusable buffers for `lex_and_parse_and_build`.
+/// Reusing the same buffers when loading multiple documents (e.g. for each `\cowel_include`)
+/// avoids allocating and growing new buffers for each document.
+struct Parse_Buffers {
+    std::pmr::vector<Token> tokens;
+    std::pmr::vector<CST_Instruction> instructions;
+
+    [[nodiscard]]
+    explicit Parse_Buffers(std::pmr::memory_resource* memory)
+        : tokens { memory }
+        , instructions { memory }
+    {
+    }
+};
+
+/// @brief Parses a document and builds an AST from it in a single pass.
+/// Unlike running `parse` followed by `build_ast`,
+/// this never materializes the parse instructions for the whole document;
+/// each top-level markup element is built as soon as it has been parsed
+/// (see `parse_incrementally`).
+///
+/// If parsing fails, returns `false` and leaves `out` unchanged.
 [[nodiscard]]
 bool parse_and_build(
     ast::Pmr_Vector<ast::Markup_Element>& out,
     std::u8string_view source,
+    const Line_Table& lines,
     std::span<const Token> tokens,
     File_Id file,
     std::pmr::memory_resource* memory,
     Parse_Error_Consumer on_error = {}
 );
 
+/// @brief Like the other overload,
+/// but builds a new line table for `source`.
+[[nodiscard]]
+bool parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    std::u8string_view source,
+    std::span<const Token> tokens,
+    File_Id file,
+    std::pmr::memory_resource* memory,
+    Parse_Error_Consumer on_error = {}
+);
+
+/// @brief Lexes `source` and runs `parse_and_build` on the resulting tokens.
+/// @param buffers Buffers which are cleared and then used for tokens and instructions.
+/// @param lines The line table of `source`,
+/// usually obtained from `File_Loader::find_line_table`.
+[[nodiscard]]
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    std::u8string_view source,
+    const Line_Table& lines,
+    File_Id file,
+    std::pmr::memory_resource* memory,
+    Parse_Error_Consumer on_error = {}
+);
+
+/// @brief Like the other overload,
+/// but builds a new line table for `source`.
+[[nodiscard]]
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    std::u8string_view source,
+    File_Id file,
+    std::pmr::memory_resource* memory,
+    Parse_Error_Consumer on_error = {}
+);
+
+/// @brief Like the other overloads,
+/// but allocates the entire AST within `arena`.
+/// Expressions held by the AST are immortal nodes within the arena,
+/// so copying and destroying the AST performs no reference counting.
+/// The AST shall not be used once the arena has been released.
+[[nodiscard]]
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    std::u8string_view source,
+    const Line_Table& lines,
+    File_Id file,
+    GC_Arena& arena,
+    Parse_Error_Consumer on_error = {}
+);
+
+/// @brief Like the other overload,
+/// but builds a new line table for `source`.
+[[nodiscard]]
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    std::u8string_view source,
+    File_Id file,
+    GC_Arena& arena,
+    Parse_Error_Consumer on_error = {}
+);
+
+/// @brief Like the other overloads,
+/// but uses temporary buffers.
+[[nodiscard]]
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    std::u8string_view source,
+    const Line_Table& lines,
+    File_Id file,
+    std::pmr::memory_resource* memory,
+    Parse_Error_Consumer on_error = {}
+);
+
+/// @brief Like the other overload,
+/// but builds a new line table for `source`.
 [[nodiscard]]
 bool lex_and_parse_and_build(
     ast::Pmr_Vector<ast::Markup_Element>& out,
@@ -59,6 +59,13 @@ public:
 #endif
     }
 
+    /// @brief Returns the sink to which the contents of the buffer are flushed.
+    [[nodiscard]]
+    constexpr const Sink& get_sink() const noexcept
+    {
+        return m_sink;
+    }
+
     /// @brief Returns the amount of elements that can be appended to the buffer before
     /// flushing.
     [[nodiscard]]
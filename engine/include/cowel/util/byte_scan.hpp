@@ -0,0 +1,67 @@
+#ifndef COWEL_BYTE_SCAN_HPP
+#define COWEL_BYTE_SCAN_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace cowel {
+
+/// @brief The maximum amount of distinct bytes that can be searched for at once
+/// using `find_first_of_bytes` and similar functions.
+inline constexpr std::size_t max_byte_set_size = 8;
+
+/// @brief The implementation used by byte scanning functions.
+/// The best available kernel is selected at runtime, based on CPU support.
+enum struct Byte_Scan_Kernel : unsigned char {
+    /// @brief Portable implementation, processing one byte at a time.
+    scalar,
+    /// @brief x86 implementation, processing 16 bytes at a time.
+    sse2,
+    /// @brief x86 implementation, processing 32 bytes at a time.
+    avx2,
+};
+
+[[nodiscard]]
+std::u8string_view byte_scan_kernel_name(Byte_Scan_Kernel kernel);
+
+/// @brief Returns `true` iff `kernel` can be used on the current CPU.
+[[nodiscard]]
+bool byte_scan_kernel_is_supported(Byte_Scan_Kernel kernel);
+
+/// @brief Returns the kernel that is used by default,
+/// i.e. the most efficient kernel supported by the current CPU.
+[[nodiscard]]
+Byte_Scan_Kernel default_byte_scan_kernel();
+
+/// @brief Returns the index of the first byte in `str` that is equal to any of the bytes in `set`,
+/// or `str.length()` if there is no such byte.
+/// @param set A set of at most `max_byte_set_size` bytes.
+[[nodiscard]]
+std::size_t find_first_of_bytes(std::u8string_view str, std::u8string_view set);
+
+/// @brief Like `find_first_of_bytes(str, set)`,
+/// but uses the given kernel, or the scalar kernel if `kernel` is unsupported.
+[[nodiscard]]
+std::size_t
+find_first_of_bytes(std::u8string_view str, std::u8string_view set, Byte_Scan_Kernel kernel);
+
+/// @brief Returns the index of the last byte in `str` that is equal to any of the bytes in `set`,
+/// or `std::u8string_view::npos` if there is no such byte.
+/// @param set A set of at most `max_byte_set_size` bytes.
+[[nodiscard]]
+std::size_t find_last_of_bytes(std::u8string_view str, std::u8string_view set);
+
+[[nodiscard]]
+std::size_t
+find_last_of_bytes(std::u8string_view str, std::u8string_view set, Byte_Scan_Kernel kernel);
+
+/// @brief Returns the amount of bytes in `str` that are equal to `byte`.
+[[nodiscard]]
+std::size_t count_byte(std::u8string_view str, char8_t byte);
+
+[[nodiscard]]
+std::size_t count_byte(std::u8string_view str, char8_t byte, Byte_Scan_Kernel kernel);
+
+} // namespace cowel
+
+#endif
@@ -7,6 +7,8 @@
 
 #include "ulight/impl/ascii_algorithm.hpp"
 
+#include "cowel/util/assert.hpp"
+#include "cowel/util/byte_scan.hpp"
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/html_entities.hpp"
 #include "cowel/util/string_or_char_consumer.hpp"
@@ -66,17 +68,48 @@ struct Charset_Contains_Predicate {
 /// are replaced with their corresponding HTML entities.
 /// For example, if `charset` includes `&`, `&amp;` is appended in its stead.
 ///
+/// Unlike `append_html_escaped`, the code units to be escaped are found using
+/// `find_first_of_bytes`, which examines multiple code units at once if the CPU supports it,
+/// and the text between them is appended in bulk.
+///
 /// `charset` shall be a subset of the entities supported by `html_entity_of`.
 template <string_or_char_consumer Out>
 void append_html_escaped_of(Out& out, std::u8string_view text, std::u8string_view charset)
 {
-    append_html_escaped(out, text, detail::Charset_Contains_Predicate { charset });
+    if (charset.size() > max_byte_set_size) {
+        append_html_escaped(out, text, detail::Charset_Contains_Predicate { charset });
+        return;
+    }
+    while (!text.empty()) {
+        const std::size_t safe_length = find_first_of_bytes(text, charset);
+        if (safe_length != 0) {
+            out(text.substr(0, safe_length));
+            text.remove_prefix(safe_length);
+            if (text.empty()) {
+                break;
+            }
+        }
+        COWEL_DEBUG_ASSERT(charset.contains(text.front()));
+        out(html_entity_of(text.front()));
+        text.remove_prefix(1);
+    }
 }
 
 template <string_or_char_consumer Out>
 void append_html_escaped_of(Out& out, Char_Sequence8 text, std::u8string_view charset)
 {
-    append_html_escaped(out, text, detail::Charset_Contains_Predicate { charset });
+    if (text.empty()) {
+        return;
+    }
+    if (const std::u8string_view sv = text.as_string_view(); !sv.empty()) {
+        append_html_escaped_of(out, sv, charset);
+        return;
+    }
+    char8_t buffer[default_char_sequence_buffer_size];
+    while (!text.empty()) {
+        const std::size_t n = text.extract(buffer);
+        append_html_escaped_of(out, std::u8string_view { buffer, n }, charset);
+    }
 }
 
 } // namespace cowel
@@ -138,6 +138,70 @@ Result<void, IO_Error_Code> file_to_bytes(std::vector<Byte, Alloc>& out, std::u8
     );
 }
 
+/// @brief The read-only contents of a file, as obtained by `map_file`.
+/// On POSIX systems, the file is mapped into memory,
+/// so that only the pages which are actually accessed are read from disk.
+/// Elsewhere, the contents are read into a heap buffer.
+struct [[nodiscard]] Mapped_File {
+private:
+    const std::byte* m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    constexpr Mapped_File() = default;
+
+    constexpr Mapped_File(Mapped_File&& other) noexcept
+        : m_data { std::exchange(other.m_data, nullptr) }
+        , m_size { std::exchange(other.m_size, 0) }
+    {
+    }
+
+    Mapped_File(const Mapped_File&) = delete;
+    Mapped_File& operator=(const Mapped_File&) = delete;
+
+    Mapped_File& operator=(Mapped_File&& other) noexcept
+    {
+        swap(*this, other);
+        other.close();
+        return *this;
+    }
+
+    constexpr friend void swap(Mapped_File& x, Mapped_File& y) noexcept
+    {
+        std::swap(x.m_data, y.m_data);
+        std::swap(x.m_size, y.m_size);
+    }
+
+    void close() noexcept;
+
+    [[nodiscard]]
+    constexpr std::span<const std::byte> bytes() const noexcept
+    {
+        return { m_data, m_size };
+    }
+
+    ~Mapped_File()
+    {
+        close();
+    }
+
+private:
+    friend Result<Mapped_File, IO_Error_Code> map_file(std::u8string_view path);
+
+    constexpr Mapped_File(const std::byte* data, std::size_t size) noexcept
+        : m_data { data }
+        , m_size { size }
+    {
+    }
+};
+
+/// @brief Makes the contents of the file at `path` available as a `Mapped_File`.
+/// An empty file results in a `Mapped_File` with no bytes.
+/// The file should not be modified while the result is alive;
+/// replacing it (e.g. via `std::filesystem::rename`) is fine.
+[[nodiscard]]
+Result<Mapped_File, IO_Error_Code> map_file(std::u8string_view path);
+
 [[nodiscard]]
 Result<void, IO_Error_Code> load_utf8_file(std::pmr::vector<char8_t>& out, std::u8string_view path);
 
@@ -168,5 +232,13 @@ bytes_to_file(std::span<const char8_t> data, std::u8string_view path)
     return bytes_to_file(data.data(), data.size_bytes(), path);
 }
 
+/// @brief Writes the concatenation of `pieces` to `file`.
+/// On POSIX systems, this uses `writev`,
+/// which hands multiple buffers to the operating system at once,
+/// rather than copying them into the buffer of `file` first.
+[[nodiscard]]
+Result<void, IO_Error_Code>
+write_gathered(std::FILE* file, std::span<const std::u8string_view> pieces);
+
 } // namespace cowel
 #endif
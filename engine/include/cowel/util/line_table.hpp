@@ -0,0 +1,114 @@
+#ifndef COWEL_LINE_TABLE_HPP
+#define COWEL_LINE_TABLE_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "cowel/util/source_position.hpp"
+
+namespace cowel {
+
+/// @brief Maps offsets within a source file to line and column numbers.
+/// This lets tokens and other syntactical elements store only their offset and length,
+/// with line and column being computed on demand (e.g. for diagnostics).
+///
+/// The computed positions are identical to those obtained by calling `advance`
+/// for each character up to the offset,
+/// i.e. a line feed starts a new line and a carriage return resets the column.
+///
+/// Additionally, the table can convert between offsets and line-relative UTF-16 columns,
+/// as used by the Language Server Protocol.
+/// Such columns are always counted from the start of the line,
+/// even if the line contains carriage returns.
+///
+/// The table does not keep a view of the source,
+/// so member functions which need to examine the source text take it as a parameter.
+/// It shall be the same source that the table was constructed from.
+struct Line_Table {
+private:
+    /// @brief The offset of the first character in each line.
+    /// The first element is always zero.
+    std::pmr::vector<std::size_t> m_line_starts;
+    /// @brief The offsets of all carriage returns in the source.
+    std::pmr::vector<std::size_t> m_carriage_returns;
+    std::size_t m_source_length;
+
+public:
+    [[nodiscard]]
+    explicit Line_Table(std::u8string_view source, std::pmr::memory_resource* memory);
+
+    /// @brief Returns the amount of lines in the source.
+    /// This is always at least one, even for empty sources.
+    [[nodiscard]]
+    std::size_t line_count() const
+    {
+        return m_line_starts.size();
+    }
+
+    /// @brief Returns the offset of the first character in the line with the given index.
+    [[nodiscard]]
+    std::size_t line_start(std::size_t line) const
+    {
+        COWEL_ASSERT(line < m_line_starts.size());
+        return m_line_starts[line];
+    }
+
+    /// @brief Returns the one-past-the-end offset of the line with the given index,
+    /// not including the terminating line feed.
+    [[nodiscard]]
+    std::size_t line_end(std::size_t line) const
+    {
+        COWEL_ASSERT(line < m_line_starts.size());
+        return line + 1 < m_line_starts.size() ? m_line_starts[line + 1] - 1 : m_source_length;
+    }
+
+    /// @brief Returns the text of the line with the given index,
+    /// not including the terminating line feed.
+    [[nodiscard]]
+    std::u8string_view line_text(std::u8string_view source, std::size_t line) const
+    {
+        COWEL_DEBUG_ASSERT(source.length() == m_source_length);
+        const std::size_t start = line_start(line);
+        return source.substr(start, line_end(line) - start);
+    }
+
+    /// @brief Returns the index of the line containing the given offset.
+    /// @param offset An offset within the source, or the source length.
+    [[nodiscard]]
+    std::size_t line_at(std::size_t offset) const;
+
+    /// @brief Returns the position at the given offset.
+    /// @param offset An offset within the source, or the source length.
+    [[nodiscard]]
+    Source_Position position_at(std::size_t offset) const;
+
+    /// @brief Returns the amount of UTF-16 code units between the start of the line
+    /// containing `offset` and `offset`.
+    [[nodiscard]]
+    std::size_t utf16_column_at(std::u8string_view source, std::size_t offset) const;
+
+    /// @brief Returns the offset of the given `line` and `column`,
+    /// where `column` is counted in code units from the start of the line.
+    /// If `line` is past the last line, returns the source length.
+    /// If `column` is past the end of the line, returns the end of the line.
+    [[nodiscard]]
+    std::size_t offset_at(std::size_t line, std::size_t column) const;
+
+    /// @brief Like `offset_at`, but `column` is counted in UTF-16 code units.
+    [[nodiscard]]
+    std::size_t
+    offset_at_utf16(std::u8string_view source, std::size_t line, std::size_t utf16_column) const;
+
+    /// @brief Equivalent to `Source_Span { position_at(begin), length }`.
+    [[nodiscard]]
+    Source_Span span_at(std::size_t begin, std::size_t length) const
+    {
+        return { position_at(begin), length };
+    }
+};
+
+} // namespace cowel
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef COWEL_PERFECT_HASH_HPP
+#define COWEL_PERFECT_HASH_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <string_view>
+#include <utility>
+
+#include "cowel/util/assert.hpp"
+
+namespace cowel {
+
+/// @brief Returns the 64-bit FNV-1a hash of `str`.
+[[nodiscard]]
+constexpr std::uint64_t fnv1a_64(std::u8string_view str) noexcept
+{
+    std::uint64_t result = 0xcbf29ce484222325;
+    for (const char8_t c : str) {
+        result ^= std::uint64_t(c);
+        result *= 0x100000001b3;
+    }
+    return result;
+}
+
+/// @brief Returns `x` with its bits thoroughly mixed, using the SplitMix64 finalizer.
+[[nodiscard]]
+constexpr std::uint64_t mix_bits_64(std::uint64_t x) noexcept
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+/// @brief A perfect hash table for a fixed set of `N` strings,
+/// which is meant to be built at compile time from a constant array of `T`s,
+/// where `Proj` obtains the string key of each `T`.
+/// If multiple elements have the same key, only the first of them can be found,
+/// just like with a lower-bound search in a sorted array.
+///
+/// `find` takes constant time:
+/// it hashes the key once, reads two table entries,
+/// and compares the key to at most one string from the array.
+/// By comparison, a binary search over thousands of strings
+/// performs a dozen comparisons with poor locality.
+///
+/// The table is built using the "hash and displace" technique:
+/// keys are distributed into buckets of one or two keys on average,
+/// and for each bucket (largest first),
+/// a seed is found which places all of its keys into free slots.
+template <typename T, std::size_t N, typename Proj = std::identity>
+struct Perfect_Hash_Table {
+    static_assert(N < 0xffff, "Indices and seeds are stored as 16-bit integers.");
+
+    using index_type = std::uint16_t;
+
+    static constexpr std::size_t bucket_count = std::bit_ceil(N / 2 + 1);
+    /// @brief The number of slots.
+    /// The load factor is kept below 2/3 so that seeds are found quickly.
+    static constexpr std::size_t slot_count = std::bit_ceil(N + N / 2 + 1);
+    /// @brief Marks a slot which contains no key.
+    static constexpr index_type empty_slot = N;
+
+private:
+    const T* m_keys;
+    [[no_unique_address]]
+    Proj m_proj;
+    std::array<index_type, bucket_count> m_seeds {};
+    std::array<index_type, slot_count> m_slots {};
+
+public:
+    /// @brief Builds a perfect hash table for `keys`.
+    /// `keys` shall have static storage duration since the table refers to it.
+    [[nodiscard]]
+    constexpr explicit Perfect_Hash_Table(const T (&keys)[N], Proj proj = {})
+        : m_keys { keys }
+        , m_proj { std::move(proj) }
+    {
+        std::array<std::uint64_t, N> hashes {};
+        for (std::size_t i = 0; i < N; ++i) {
+            hashes[i] = hash(get_key(i));
+        }
+
+        // Group the keys by bucket, like in a counting sort.
+        // Keys which are equal to a previous key in the same bucket are dropped.
+        std::array<std::size_t, bucket_count + 1> bucket_begin {};
+        for (const std::uint64_t h : hashes) {
+            ++bucket_begin[bucket_of(h) + 1];
+        }
+        std::partial_sum(bucket_begin.begin(), bucket_begin.end(), bucket_begin.begin());
+        std::array<index_type, N> members {};
+        std::array<std::size_t, bucket_count> bucket_end {};
+        std::copy_n(bucket_begin.begin(), bucket_count, bucket_end.begin());
+        for (std::size_t i = 0; i < N; ++i) {
+            const std::size_t b = bucket_of(hashes[i]);
+            const bool is_duplicate = std::any_of(
+                members.data() + bucket_begin[b], members.data() + bucket_end[b],
+                [&](const index_type other) {
+                    return hashes[other] == hashes[i] && get_key(other) == get_key(i);
+                }
+            );
+            if (!is_duplicate) {
+                members[bucket_end[b]++] = index_type(i);
+            }
+        }
+
+        // Buckets with many keys are the hardest to place, so they are placed first,
+        // while the table is still mostly empty.
+        std::array<index_type, bucket_count> order {};
+        std::iota(order.begin(), order.end(), index_type(0));
+        const auto bucket_size = [&](const std::size_t b) -> std::size_t {
+            return bucket_end[b] - bucket_begin[b];
+        };
+        std::ranges::sort(order, [&](const index_type x, const index_type y) {
+            return bucket_size(x) > bucket_size(y);
+        });
+
+        m_slots.fill(empty_slot);
+        for (const index_type b : order) {
+            if (bucket_size(b) == 0) {
+                break;
+            }
+            const index_type* const first = members.data() + bucket_begin[b];
+            const index_type* const last = members.data() + bucket_end[b];
+            for (std::size_t seed = 0;; ++seed) {
+                // This could only fail for keys with equal hashes, which is astronomically unlikely.
+                COWEL_ASSERT(seed < 0xffff);
+                if (try_place(first, last, hashes, seed)) {
+                    m_seeds[b] = index_type(seed);
+                    break;
+                }
+            }
+        }
+    }
+
+    /// @brief Returns a pointer to the element in the array of keys
+    /// whose projected key equals `key`, or null if there is none.
+    [[nodiscard]]
+    constexpr const T* find(std::u8string_view key) const
+    {
+        const std::uint64_t h = hash(key);
+        const index_type index = m_slots[slot_of(h, m_seeds[bucket_of(h)])];
+        if (index == empty_slot || get_key(index) != key) {
+            return nullptr;
+        }
+        return m_keys + index;
+    }
+
+private:
+    [[nodiscard]]
+    constexpr std::u8string_view get_key(std::size_t index) const
+    {
+        return std::u8string_view(std::invoke(m_proj, m_keys[index]));
+    }
+
+    [[nodiscard]]
+    static constexpr std::uint64_t hash(std::u8string_view key) noexcept
+    {
+        // FNV-1a alone leaves the upper bits poorly distributed for short keys.
+        return mix_bits_64(fnv1a_64(key));
+    }
+
+    [[nodiscard]]
+    static constexpr std::size_t bucket_of(std::uint64_t hash) noexcept
+    {
+        return std::size_t(hash >> 32) & (bucket_count - 1);
+    }
+
+    [[nodiscard]]
+    static constexpr std::size_t slot_of(std::uint64_t hash, std::size_t seed) noexcept
+    {
+        const std::uint64_t x = mix_bits_64(hash + (std::uint64_t(seed) * 0x9e3779b97f4a7c15));
+        return std::size_t(x) & (slot_count - 1);
+    }
+
+    /// @brief Places the keys with the indices in `[first, last)` into the slots given by `seed`.
+    /// If any of these slots are already occupied, the table is left unchanged.
+    /// @returns `true` iff the keys were placed.
+    [[nodiscard]]
+    constexpr bool try_place(
+        const index_type* first,
+        const index_type* last,
+        const std::array<std::uint64_t, N>& hashes,
+        std::size_t seed
+    )
+    {
+        for (const index_type* it = first; it != last; ++it) {
+            index_type& slot = m_slots[slot_of(hashes[*it], seed)];
+            if (slot != empty_slot) {
+                for (const index_type* placed = first; placed != it; ++placed) {
+                    m_slots[slot_of(hashes[*placed], seed)] = empty_slot;
+                }
+                return false;
+            }
+            slot = *it;
+        }
+        return true;
+    }
+};
+
+} // namespace cowel
+
+#endif
@@ -6,6 +6,7 @@
 #include <type_traits>
 
 #include "cowel/util/assert.hpp"
+#include "cowel/util/byte_scan.hpp"
 
 #include "cowel/fwd.hpp"
 
@@ -52,8 +53,24 @@ constexpr void advance(Source_Position& pos, char8_t c)
     pos.begin += 1;
 }
 
+/// @brief Advances `pos` past `str`.
+/// For long strings, this counts line breaks in bulk instead of examining each character.
 constexpr void advance(Source_Position& pos, std::u8string_view str)
 {
+    // Below this length, the overhead of calling the byte scanning functions
+    // likely outweighs their benefits.
+    constexpr std::size_t bulk_threshold = 32;
+
+    if !consteval {
+        if (str.length() >= bulk_threshold) {
+            const std::size_t last_break = find_last_of_bytes(str, u8"\r\n");
+            pos.line += count_byte(str, u8'\n');
+            pos.column = last_break == std::u8string_view::npos ? pos.column + str.length()
+                                                                 : str.length() - last_break - 1;
+            pos.begin += str.length();
+            return;
+        }
+    }
     for (const char8_t c : str) {
         advance(pos, c);
     }
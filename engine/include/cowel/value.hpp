@@ -1,6 +1,7 @@
 #ifndef COWEL_VALUE_HPP
 #define COWEL_VALUE_HPP
 
+#include <cstddef>
 #include <string_view>
 
 #include "cowel/util/assert.hpp"
@@ -33,6 +34,16 @@ struct Unit {
 
 using Short_String_Value = Fixed_String8<56>;
 
+/// @brief A string that is stored directly within a `Value`, without any allocation.
+/// This is deliberately shorter than `Short_String_Value`
+/// because it determines the size of every `Value`.
+///
+/// Notably, strings of 25 to 56 code units (such as results of `Short_String_Value`
+/// that do not fit) require a GC allocation when stored in a `Value`.
+/// That is the price for halving the size of `Value`,
+/// which makes every other value cheaper to copy.
+using Inline_String_Value = Fixed_String8<24>;
+
 struct String_With_Meta {
     std::u8string_view data;
     String_Kind kind;
@@ -50,6 +61,10 @@ struct Directive_And_Frame {
 
 using Dynamic_String_Value = GC_Ref<char8_t>;
 
+struct Rope_String_Node;
+
+using Rope_String_Value = GC_Ref<Rope_String_Node>;
+
 struct Group_Member_Value;
 
 using Group_Value = GC_Ref<Group_Member_Value>;
@@ -64,6 +79,11 @@ using Group_Value = GC_Ref<Group_Member_Value>;
 /// - `Value` is used in a huge amount of places,
 ///   so it's worth optimizing its layout somewhat
 ///
+/// In particular, `Value` is kept at 32 bytes because it is constantly copied
+/// (e.g. through `Result<Value, Processing_Status>`) and stored in bulk (e.g. in groups).
+/// The largest alternatives are `Big_Int` and `Inline_String_Value`;
+/// longer strings and huge integers are allocated separately.
+///
 /// For values of basic type (`int`, `str`, etc.),
 /// the type reference is to a static `Type` object.
 /// For values of group type,
@@ -81,6 +101,7 @@ private:
         static_string_index,
         short_string_index,
         dynamic_string_index,
+        rope_string_index,
         regex_index,
         block_index,
         directive_index,
@@ -94,8 +115,9 @@ private:
         Big_Int integer;
         Float floating;
         std::u8string_view static_string;
-        Short_String_Value::array_type short_string;
+        Inline_String_Value::array_type short_string;
         Dynamic_String_Value dynamic_string;
+        Rope_String_Value rope_string;
         Reg_Exp regex;
         Block_And_Frame block;
         Directive_And_Frame directive;
@@ -157,14 +179,24 @@ public:
     /// because it gives this string reference semantics.
     [[nodiscard]]
     static constexpr Value static_string(std::u8string_view value, String_Kind kind) noexcept;
-    /// @brief Creates a value of type `str` from a string that fits into `Short_String_Value`.
+    /// @brief Creates a value of type `str` from a string that fits into `Inline_String_Value`.
     [[nodiscard]]
-    static constexpr Value short_string(const Short_String_Value& value, String_Kind kind) noexcept;
+    static constexpr Value
+    short_string(const Inline_String_Value& value, String_Kind kind) noexcept;
     /// @brief Creates a value of type `str` with dynamic storage duration.
     /// Unlike for `static_string`, the contents of `value` are copied
     /// and kept alive using garbage collection.
     [[nodiscard]]
     static Value dynamic_string_forced(std::u8string_view value, String_Kind kind);
+    /// @brief Creates a value of type `str` holding the concatenation of `lhs` and `rhs`,
+    /// which shall both be strings.
+    /// Long strings are not copied, but concatenated by forming a rope,
+    /// which is only flattened into a contiguous string once `as_string` is called.
+    /// Ropes are rebalanced once they become too deep,
+    /// but only their unbalanced parts are visited while doing so.
+    /// Therefore, building a string by repeatedly appending to it takes linear time.
+    [[nodiscard]]
+    static Value string_concat(const Value& lhs, const Value& rhs);
 
     [[nodiscard]]
     static Value regex(const Reg_Exp&);
@@ -219,6 +251,7 @@ public:
     {
         static_assert(std::is_nothrow_copy_constructible_v<Big_Int>);
         static_assert(std::is_nothrow_copy_constructible_v<Dynamic_String_Value>);
+        static_assert(std::is_nothrow_copy_constructible_v<Rope_String_Value>);
         static_assert(std::is_nothrow_copy_constructible_v<Group_Value>);
     }
 
@@ -233,6 +266,7 @@ public:
     {
         static_assert(std::is_nothrow_move_constructible_v<Big_Int>);
         static_assert(std::is_nothrow_move_constructible_v<Dynamic_String_Value>);
+        static_assert(std::is_nothrow_move_constructible_v<Rope_String_Value>);
         static_assert(std::is_nothrow_move_constructible_v<Group_Value>);
     }
 
@@ -250,7 +284,7 @@ public:
     constexpr const Type& get_type() const noexcept
     {
         static constexpr auto types = [] {
-            std::array<const Type*, 12> result;
+            std::array<const Type*, 13> result;
             result[unit_index] = &Type::unit;
             result[null_index] = &Type::null;
             result[boolean_index] = &Type::boolean;
@@ -259,6 +293,7 @@ public:
             result[static_string_index] = &Type::str;
             result[short_string_index] = &Type::str;
             result[dynamic_string_index] = &Type::str;
+            result[rope_string_index] = &Type::str;
             result[regex_index] = &Type::regex;
             result[block_index] = &Type::block;
             result[directive_index] = &Type::block;
@@ -273,7 +308,7 @@ public:
     constexpr Type_Kind get_type_kind() const noexcept
     {
         static constexpr auto kinds = [] {
-            std::array<Type_Kind, 12> result;
+            std::array<Type_Kind, 13> result;
             result[unit_index] = Type_Kind::unit;
             result[null_index] = Type_Kind::null;
             result[boolean_index] = Type_Kind::boolean;
@@ -282,6 +317,7 @@ public:
             result[static_string_index] = Type_Kind::str;
             result[short_string_index] = Type_Kind::str;
             result[dynamic_string_index] = Type_Kind::str;
+            result[rope_string_index] = Type_Kind::str;
             result[regex_index] = Type_Kind::regex;
             result[block_index] = Type_Kind::block;
             result[directive_index] = Type_Kind::block;
@@ -433,10 +469,19 @@ public:
         case short_string_index:
             return std::u8string_view { m_value.short_string.data(), m_short_string_length };
         case dynamic_string_index: return as_u8string_view(m_value.dynamic_string.as_span());
+        case rope_string_index: return flatten(m_value.rope_string);
         default: break;
         }
         COWEL_ASSERT_UNREACHABLE(u8"Value is not a string.");
     }
+    /// @brief Returns the length of the string in code units.
+    /// Unlike `as_string().size()`, this does not flatten ropes.
+    [[nodiscard]]
+    std::size_t get_string_length() const;
+    /// @brief Returns the depth of the string as a rope,
+    /// or zero if the string is not a rope or has been flattened already.
+    [[nodiscard]]
+    std::size_t get_rope_depth() const;
     [[nodiscard]]
     constexpr String_With_Meta as_string_with_meta() const
     {
@@ -478,6 +523,26 @@ public:
 
     [[nodiscard]]
     Processing_Status splice_block(Content_Policy& out, Context& context) const;
+
+private:
+    /// @brief Returns the node of a rope which has not been flattened yet, or null.
+    [[nodiscard]]
+    const Rope_String_Node* get_rope_node() const;
+
+    [[nodiscard]]
+    static Value make_rope(const Value& lhs, const Value& rhs, String_Kind kind);
+
+    /// @brief Like `make_rope`, but never rebalances.
+    [[nodiscard]]
+    static Value make_rope_node(const Value& lhs, const Value& rhs, String_Kind kind);
+
+    [[nodiscard]]
+    static Value rebalance_rope(const Value& rope);
+
+    /// @brief Flattens `rope` into a contiguous string on first use,
+    /// and returns that string.
+    [[nodiscard]]
+    static std::u8string_view flatten(const Rope_String_Value& rope);
 };
 
 struct Group_Member_Value {
@@ -488,6 +553,21 @@ struct Group_Member_Value {
     Value value;
 };
 
+/// @brief The concatenation of two strings (see `Value::string_concat`).
+/// This forms a binary tree whose leaves are contiguous strings.
+struct Rope_String_Node {
+    /// @brief The left operand, or `Value::null` once the node has been flattened.
+    mutable Value lhs;
+    /// @brief The right operand, or `Value::null` once the node has been flattened.
+    mutable Value rhs;
+    /// @brief The total length of the string in code units.
+    std::size_t length;
+    /// @brief The height of this node within the tree, where leaves have a depth of zero.
+    std::size_t depth;
+    /// @brief The flattened string, or null if the node has not been flattened yet.
+    mutable Dynamic_String_Value flat;
+};
+
 // NOLINTNEXTLINE(readability-make-member-function-const)
 inline std::span<Group_Member_Value> Value::get_group_members()
 {
@@ -518,7 +598,7 @@ constexpr Value::Value(
     //            This is fine only because every alternative is movable,
     //            so its resources are grabbed by `Union::make` and don't get leaked.
     static_assert(std::is_same_v<std::remove_cvref_t<T>, Union>);
-    COWEL_ASSERT(short_string_length <= Short_String_Value::max_size_v);
+    COWEL_ASSERT(short_string_length <= Inline_String_Value::max_size_v);
 }
 
 template <typename T>
@@ -536,6 +616,7 @@ constexpr Value::Union Value::Union::make(T&& other, const Index other_index) no
     case static_string_index: return { .static_string = other.static_string };
     case short_string_index: return { .short_string = other.short_string };
     case dynamic_string_index: return { .dynamic_string = std::forward<T>(other).dynamic_string };
+    case rope_string_index: return { .rope_string = std::forward<T>(other).rope_string };
     case regex_index: return { .regex = std::forward<T>(other).regex };
     case block_index: return { .block = other.block };
     case directive_index: return { .directive = other.directive };
@@ -578,6 +659,16 @@ Value::Union::assign(const Index self_index, T&& other, const Index other_index)
         }
         break;
     }
+    case rope_string_index: {
+        if (self_index == rope_string_index) {
+            rope_string = std::forward<T>(other).rope_string;
+        }
+        else {
+            destroy(self_index);
+            std::construct_at(&rope_string, std::forward<T>(other).rope_string);
+        }
+        break;
+    }
     case regex_index: {
         if (self_index == regex_index) {
             regex = std::forward<T>(other).regex;
@@ -614,7 +705,7 @@ constexpr void Value::Union::destroy(const Index index) noexcept
     case directive_index: {
         static_assert(std::is_trivially_destructible_v<Unit>);
         static_assert(std::is_trivially_destructible_v<Null>);
-        static_assert(std::is_trivially_destructible_v<Short_String_Value>);
+        static_assert(std::is_trivially_destructible_v<Inline_String_Value>);
         static_assert(std::is_trivially_destructible_v<Block_And_Frame>);
         static_assert(std::is_trivially_destructible_v<Directive_And_Frame>);
         break;
@@ -627,6 +718,10 @@ constexpr void Value::Union::destroy(const Index index) noexcept
         dynamic_string.~Dynamic_String_Value();
         break;
     }
+    case rope_string_index: {
+        rope_string.~Rope_String_Value();
+        break;
+    }
     case regex_index: {
         regex.~Reg_Exp();
         break;
@@ -644,6 +739,7 @@ constexpr Value& Value::operator=(const Value& other) noexcept
 {
     static_assert(std::is_nothrow_copy_assignable_v<Big_Int>);
     static_assert(std::is_nothrow_copy_assignable_v<Dynamic_String_Value>);
+    static_assert(std::is_nothrow_copy_assignable_v<Rope_String_Value>);
     static_assert(std::is_nothrow_copy_assignable_v<Group_Value>);
     if (this != &other) {
         m_value.assign(m_index, other.m_value, other.m_index);
@@ -658,6 +754,7 @@ constexpr Value& Value::operator=(Value&& other) noexcept
 {
     static_assert(std::is_nothrow_move_assignable_v<Big_Int>);
     static_assert(std::is_nothrow_move_assignable_v<Dynamic_String_Value>);
+    static_assert(std::is_nothrow_move_assignable_v<Rope_String_Value>);
     static_assert(std::is_nothrow_move_assignable_v<Group_Value>);
     m_value.assign(m_index, std::move(other).m_value, other.m_index);
     m_index = other.m_index;
@@ -693,7 +790,7 @@ Value::static_string(const std::u8string_view value, const String_Kind kind) noe
     return Value { Union { .static_string = value }, static_string_index, kind };
 }
 constexpr Value
-Value::short_string(const Short_String_Value& value, const String_Kind kind) noexcept
+Value::short_string(const Inline_String_Value& value, const String_Kind kind) noexcept
 {
     return Value {
         Union { .short_string = value.as_array() },
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "cowel/util/html_names.hpp"
+#include "cowel/util/perfect_hash.hpp"
 #include "cowel/util/typo.hpp"
 
 #include "cowel/builtin_directive_set.hpp"
@@ -351,8 +352,11 @@ constexpr Macro_Behavior cowel_macro {
   Tooltip_Article {
     .kind = Tooltip_Kind::builtin_directive,
     .subject = u8"cowel_macro"sv,
-    .declaration = u8R"md(cowel_macro(names: pack str, content: block): unit)md"sv,
-    .description = u8R"md(Defines one or more macros.)md"sv,
+    .declaration = u8R"md(cowel_macro(names: pack str, pure: bool = false, content: block): unit)md"sv,
+    .description = u8R"md(Defines one or more macros.
+If `pure` is `true`, the macro promises that its output depends only on its arguments,
+and that it has no side effects.
+Its output is then memoized for invocations with directive-free arguments.)md"sv,
     .example = u8R"md(```cowel
 \: Define macro named "m"
 \cowel_macro("m"){Hello}
@@ -2318,6 +2322,8 @@ constexpr Name_And_Behavior behaviors_by_name[] {
 
 static_assert(std::ranges::is_sorted(behaviors_by_name, {}, &Name_And_Behavior::name));
 
+constexpr Perfect_Hash_Table behaviors_table { behaviors_by_name, &Name_And_Behavior::name };
+
 } // namespace
 
 struct Builtin_Directive_Set::Impl {
@@ -2358,12 +2364,8 @@ Builtin_Directive_Set::fuzzy_lookup_name(std::u8string_view name, Context& conte
 
 const Directive_Behavior* Builtin_Directive_Set::operator()(std::u8string_view name) const
 {
-    const auto* const it
-        = std::ranges::lower_bound(behaviors_by_name, name, {}, &Name_And_Behavior::name);
-    if (it == std::end(behaviors_by_name) || it->name != name) {
-        return nullptr;
-    }
-    return it->behavior;
+    const Name_And_Behavior* const entry = behaviors_table.find(name);
+    return entry ? entry->behavior : nullptr;
 }
 
 } // namespace cowel
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/char_sequence_factory.hpp"
+#include "cowel/util/result.hpp"
+#include "cowel/util/small_vector.hpp"
+
+#include "cowel/bytecode.hpp"
+#include "cowel/constant_folding.hpp"
+#include "cowel/content_status.hpp"
+#include "cowel/context.hpp"
+#include "cowel/diagnostic.hpp"
+#include "cowel/directive_processing.hpp"
+#include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
+#include "cowel/string_kind.hpp"
+#include "cowel/type.hpp"
+#include "cowel/value.hpp"
+
+#include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/expression_kind.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+struct Bytecode_Compiler {
+    Bytecode_Program& out;
+    std::size_t stack_size = 0;
+
+    void compile(const ast::Expression& expression)
+    {
+        if (const auto* const directive = expression.try_as_directive()) {
+            emit(Opcode::evaluate_directive, out.directives.size());
+            out.directives.push_back(directive);
+            grow_stack();
+            return;
+        }
+        if (const auto* const primary = expression.try_as_primary()) {
+            compile(*primary);
+            return;
+        }
+        if (const auto* const unary = expression.try_as_unary()) {
+            compile(unary->get_operand());
+            emit(Opcode::unary, out.unary_operations.size());
+            out.unary_operations.push_back({ unary->get_kind(), unary->get_source_span() });
+            return;
+        }
+        if (const auto* const binary = expression.try_as_binary()) {
+            compile(*binary);
+            return;
+        }
+        const ast::Let_Expression& let = expression.as_let();
+        emit_constant(Value::static_string(let.get_name(), String_Kind::ascii));
+        compile(let.get_value());
+        emit_binary(Builtin_Operation_Kind::let_dynamic, let.get_source_span(), let.get_source_span());
+    }
+
+private:
+    void compile(const ast::Primary& primary)
+    {
+        std::pmr::u8string buffer { out.constants.get_allocator().resource() };
+        if (const std::optional<Value> literal = try_evaluate_literal(primary, buffer)) {
+            // String literals refer to the buffer,
+            // so they need to be copied into a value which owns its characters.
+            emit_constant(
+                literal->is_str()
+                    ? Value::string(literal->as_string(), literal->get_string_kind())
+                    : *literal
+            );
+            return;
+        }
+        emit(Opcode::evaluate_primary, out.primaries.size());
+        out.primaries.push_back(&primary);
+        grow_stack();
+    }
+
+    void compile(const ast::Binary_Expression& binary)
+    {
+        const Binary_Expression_Kind kind = binary.get_kind();
+        if (kind == Binary_Expression_Kind::logical_or || kind == Binary_Expression_Kind::logical_and) {
+            const std::size_t index = out.logical_operations.size();
+            out.logical_operations.push_back({
+                .terminator = kind == Binary_Expression_Kind::logical_or,
+                .location = binary.get_source_span(),
+                .end = 0,
+            });
+            compile(binary.get_lhs());
+            emit(Opcode::logical_lhs, index);
+            // The left operand is popped unless the right operand is skipped.
+            --stack_size;
+            compile(binary.get_rhs());
+            emit(Opcode::logical_rhs, index);
+            out.logical_operations[index].end = std::uint32_t(out.code.size());
+            return;
+        }
+        compile(binary.get_lhs());
+        compile(binary.get_rhs());
+        emit_binary(
+            binary_expression_kind_builtin_operation_kind(kind), binary.get_lhs().get_source_span(),
+            binary.get_rhs().get_source_span()
+        );
+    }
+
+    void emit(Opcode opcode, std::size_t index)
+    {
+        COWEL_ASSERT(index <= UINT32_MAX);
+        out.code.push_back({ opcode, std::uint32_t(index) });
+    }
+
+    void emit_constant(const Value& value)
+    {
+        emit(Opcode::push_constant, out.constants.size());
+        out.constants.push_back(value);
+        grow_stack();
+    }
+
+    void emit_binary(
+        Builtin_Operation_Kind kind,
+        const File_Source_Span& lhs_location,
+        const File_Source_Span& rhs_location
+    )
+    {
+        emit(Opcode::binary, out.binary_operations.size());
+        out.binary_operations.push_back({
+            .kind = kind,
+            .lhs_location = lhs_location,
+            .rhs_location = rhs_location,
+        });
+        COWEL_ASSERT(stack_size >= 2);
+        --stack_size;
+    }
+
+    void grow_stack()
+    {
+        ++stack_size;
+        out.max_stack_size = std::max(out.max_stack_size, stack_size);
+    }
+};
+
+/// @brief Returns `true` iff the statically typed operation
+/// that a dynamically typed operation resolves to for an operand of this `type`
+/// depends on nothing but `type`.
+[[nodiscard]]
+constexpr bool type_kind_determines_operation(Type_Kind type)
+{
+    switch (type) {
+    case Type_Kind::unit:
+    case Type_Kind::null:
+    case Type_Kind::boolean:
+    case Type_Kind::integer:
+    case Type_Kind::floating:
+    case Type_Kind::str: return true;
+    default: return false;
+    }
+}
+
+[[nodiscard]]
+Result<Value, Processing_Status>
+execute_binary(const Binary_Operation& operation, const Value& lhs, const Value& rhs, Context& context)
+{
+    const Type_Kind lhs_type = lhs.get_type_kind();
+    const Type_Kind rhs_type = rhs.get_type_kind();
+    if (lhs_type != operation.resolved_lhs_type || rhs_type != operation.resolved_rhs_type) {
+        if (!type_kind_determines_operation(lhs_type)
+            || !type_kind_determines_operation(rhs_type)) {
+            return evaluate_builtin(
+                operation.kind, lhs, rhs, operation.lhs_location, operation.rhs_location, context
+            );
+        }
+        const Result<Builtin_Operation_Kind, Processing_Status> resolved
+            = check_dynamically_typed_operation(
+                operation.kind, lhs.get_type(), rhs.get_type(), operation.lhs_location,
+                operation.rhs_location, context
+            );
+        if (!resolved) {
+            return resolved.error();
+        }
+        COWEL_DEBUG_ASSERT(!builtin_operation_kind_is_dynamically_typed(*resolved));
+        operation.resolved_kind = *resolved;
+        operation.resolved_lhs_type = lhs_type;
+        operation.resolved_rhs_type = rhs_type;
+    }
+    return evaluate_builtin(
+        operation.resolved_kind, lhs, rhs, operation.lhs_location, operation.rhs_location, context
+    );
+}
+
+[[nodiscard]]
+bool expect_logical_operand(const Value& operand, const Logical_Operation& operation, Context& context)
+{
+    if (operand.is_bool()) {
+        return true;
+    }
+    context.try_error(
+        diagnostic::type_mismatch, operation.location,
+        joined_char_sequence(
+            {
+                u8"Expected a value of type "sv,
+                Type::boolean.get_display_name(),
+                u8", but got "sv,
+                operand.get_type().get_display_name(),
+                u8"."sv,
+            }
+        )
+    );
+    return false;
+}
+
+} // namespace
+
+void compile_bytecode(Bytecode_Program& out, const ast::Expression& expression)
+{
+    Bytecode_Compiler compiler { out };
+    compiler.compile(expression);
+    COWEL_ASSERT(compiler.stack_size == 1);
+}
+
+Result<Value, Processing_Status>
+execute_bytecode(const Bytecode_Program& program, const Frame_Index frame, Context& context)
+{
+    const auto diagnostic_frame = context.push_diagnostic_frame(frame);
+
+    Small_Vector<Value, 8> stack;
+    stack.reserve(program.max_stack_size);
+
+    std::size_t pc = 0;
+    while (pc < program.code.size()) {
+        const Bytecode_Instruction instruction = program.code[pc++];
+        switch (instruction.opcode) {
+        case Opcode::push_constant: {
+            stack.push_back(program.constants[instruction.index]);
+            break;
+        }
+        case Opcode::evaluate_primary: {
+            Result<Value, Processing_Status> result
+                = evaluate(*program.primaries[instruction.index], frame, context);
+            if (!result) {
+                return result;
+            }
+            stack.push_back(std::move(*result));
+            break;
+        }
+        case Opcode::evaluate_directive: {
+            Result<Value, Processing_Status> result
+                = evaluate(*program.directives[instruction.index], frame, context);
+            if (!result) {
+                return result;
+            }
+            stack.push_back(std::move(*result));
+            break;
+        }
+        case Opcode::unary: {
+            const Unary_Operation& operation = program.unary_operations[instruction.index];
+            Result<Value, Processing_Status> result
+                = evaluate_unary(operation.kind, stack.back(), operation.location, context);
+            if (!result) {
+                return result;
+            }
+            stack.back() = std::move(*result);
+            break;
+        }
+        case Opcode::binary: {
+            const Binary_Operation& operation = program.binary_operations[instruction.index];
+            const Value rhs = std::move(stack.back());
+            stack.pop_back();
+            Result<Value, Processing_Status> result
+                = execute_binary(operation, stack.back(), rhs, context);
+            if (!result) {
+                return result;
+            }
+            stack.back() = std::move(*result);
+            break;
+        }
+        case Opcode::logical_lhs: {
+            const Logical_Operation& operation = program.logical_operations[instruction.index];
+            if (!expect_logical_operand(stack.back(), operation, context)) {
+                return Processing_Status::error;
+            }
+            if (stack.back().as_boolean() == operation.terminator) {
+                pc = operation.end;
+            }
+            else {
+                stack.pop_back();
+            }
+            break;
+        }
+        case Opcode::logical_rhs: {
+            const Logical_Operation& operation = program.logical_operations[instruction.index];
+            if (!expect_logical_operand(stack.back(), operation, context)) {
+                return Processing_Status::error;
+            }
+            break;
+        }
+        }
+    }
+
+    COWEL_ASSERT(stack.size() == 1);
+    return std::move(stack.back());
+}
+
+const Bytecode_Program& Context::get_bytecode(const ast::Expression& expression)
+{
+    if (const Bytecode_Program* const cached = expression.get_cached_bytecode(m_bytecode_epoch)) {
+        return *cached;
+    }
+    GC_Ref<Bytecode_Program> program = gc_ref_make<Bytecode_Program>(m_transient_memory);
+    compile_bytecode(*program, expression);
+    expression.cache_bytecode(&*program, m_bytecode_epoch);
+    return *m_bytecode_programs.emplace_back(std::move(program));
+}
+
+} // namespace cowel
@@ -35,6 +35,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = false,
             .no_source = false,
             .error_message = {},
+            .ast_cache = {},
         };
     }
 
@@ -70,6 +71,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
     cowel_severity severity = COWEL_SEVERITY_INFO;
     bool no_indent = false;
     bool no_source = false;
+    std::string ast_cache_path;
     std::string subparser_error_msg;
 
     args::Command run_cmd {
@@ -89,6 +91,12 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
                 severity_arg_map,
                 COWEL_SEVERITY_INFO,
             };
+            args::ValueFlag<std::string> ast_cache_arg {
+                sub,
+                "directory",
+                "Directory in which parsed documents are cached between runs",
+                { "ast-cache" },
+            };
             sub.Parse();
             if (sub.GetError() != args::Error::None) {
                 subparser_error_msg = sub.GetErrorMsg();
@@ -97,6 +105,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             input_path = args::get(input_arg);
             output_path = args::get(output_arg);
             severity = args::get(severity_arg);
+            ast_cache_path = args::get(ast_cache_arg);
         },
     };
 
@@ -203,6 +212,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = false,
             .no_source = false,
             .error_message = {},
+            .ast_cache = {},
         };
     }
     if (version_arg.Matched()) {
@@ -216,6 +226,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = false,
             .no_source = false,
             .error_message = {},
+            .ast_cache = {},
         };
     }
     if (parser.GetError() != args::Error::None) {
@@ -231,6 +242,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = false,
             .no_source = false,
             .error_message = cowel::alloc_str(msg),
+            .ast_cache = {},
         };
     }
 
@@ -245,6 +257,8 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = false,
             .no_source = false,
             .error_message = {},
+            .ast_cache = ast_cache_path.empty() ? cowel_mutable_string_view_u8 {}
+                                                 : cowel::alloc_str(ast_cache_path),
         };
     }
     if (tokenize_cmd) {
@@ -258,6 +272,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = false,
             .no_source = false,
             .error_message = {},
+            .ast_cache = {},
         };
     }
     if (parse_cmd) {
@@ -271,6 +286,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
             .no_indent = no_indent,
             .no_source = no_source,
             .error_message = {},
+            .ast_cache = {},
         };
     }
 
@@ -284,6 +300,7 @@ cowel_parse_cli_options_u8(const char* const* const args, const std::size_t arg_
         .no_indent = false,
         .no_source = false,
         .error_message = {},
+        .ast_cache = {},
     };
 }
 
@@ -301,6 +318,7 @@ void cowel_free_cli_options_u8(cowel_parsed_cli_options_u8* const options) noexc
     free_str(options->input);
     free_str(options->output);
     free_str(options->error_message);
+    free_str(options->ast_cache);
 }
 
 } // extern "C"
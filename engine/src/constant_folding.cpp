@@ -0,0 +1,295 @@
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/result.hpp"
+#include "cowel/util/strings.hpp"
+
+#include "cowel/constant_folding.hpp"
+#include "cowel/content_status.hpp"
+#include "cowel/context.hpp"
+#include "cowel/directive_processing.hpp"
+#include "cowel/fwd.hpp"
+#include "cowel/string_kind.hpp"
+#include "cowel/type.hpp"
+#include "cowel/value.hpp"
+
+#include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/expression_kind.hpp"
+
+namespace cowel {
+
+std::optional<Value> try_evaluate_literal(const ast::Primary& primary, std::pmr::u8string& buffer)
+{
+    switch (primary.get_kind()) {
+    case ast::Primary_Kind::unit_literal: {
+        return Value::unit;
+    }
+    case ast::Primary_Kind::null_literal: {
+        return Value::null;
+    }
+    case ast::Primary_Kind::bool_literal: {
+        return Value::boolean(primary.get_bool_value());
+    }
+    case ast::Primary_Kind::int_literal: {
+        return Value::integer(primary.get_int_value());
+    }
+    case ast::Primary_Kind::decimal_float_literal: {
+        // Out-of-range literals are diagnosed upon evaluation.
+        const ast::Parsed_Float parsed = primary.get_float_value();
+        if (parsed.status != ast::Float_Literal_Status::ok) {
+            return {};
+        }
+        return Value::floating(parsed.value);
+    }
+    case ast::Primary_Kind::infinity: {
+        return Value::floating(primary.get_float_value().value);
+    }
+    case ast::Primary_Kind::quoted_string: {
+        for (const ast::Markup_Element& element : primary.get_elements()) {
+            const auto* const e = std::get_if<ast::Primary>(&element);
+            if (!e) {
+                return {};
+            }
+            switch (e->get_kind()) {
+            case ast::Primary_Kind::text: {
+                buffer += e->get_source();
+                break;
+            }
+            case ast::Primary_Kind::escape: {
+                buffer += e->get_escaped_code_units();
+                break;
+            }
+            case ast::Primary_Kind::comment:
+            case ast::Primary_Kind::empty_splice: break;
+            default: return {};
+            }
+        }
+        const auto kind = is_all_ascii(buffer) ? String_Kind::ascii : String_Kind::unicode;
+        return Value::static_string(buffer, kind);
+    }
+    default: break;
+    }
+    return {};
+}
+
+namespace {
+
+/// @brief Returns `true` iff the `kind` of expression can be evaluated for `lhs` and `rhs`
+/// without emitting any diagnostics.
+[[nodiscard]]
+bool is_foldable(Binary_Expression_Kind kind, const Value& lhs, const Value& rhs)
+{
+    if (lhs.get_type_kind() != rhs.get_type_kind()) {
+        return false;
+    }
+    const Type_Kind type = lhs.get_type_kind();
+
+    using enum Binary_Expression_Kind;
+    switch (kind) {
+    case assign: {
+        return false;
+    }
+    case logical_or:
+    case logical_and: {
+        return type == Type_Kind::boolean;
+    }
+    case eq:
+    case ne: {
+        return type == Type_Kind::unit || type == Type_Kind::null || type == Type_Kind::boolean
+            || type == Type_Kind::integer || type == Type_Kind::floating || type == Type_Kind::str;
+    }
+    case lt:
+    case gt:
+    case le:
+    case ge: {
+        return type == Type_Kind::integer || type == Type_Kind::floating || type == Type_Kind::str;
+    }
+    case plus:
+    case minus:
+    case multiply: {
+        return type == Type_Kind::integer || type == Type_Kind::floating;
+    }
+    case divide: {
+        return type == Type_Kind::floating;
+    }
+    case remainder: {
+        return type == Type_Kind::integer && !rhs.as_integer().is_zero();
+    }
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Invalid expression kind.");
+}
+
+/// @brief Returns `true` iff the `kind` of expression can be evaluated for `operand`
+/// without emitting any diagnostics.
+[[nodiscard]]
+bool is_foldable(Unary_Expression_Kind kind, const Value& operand)
+{
+    switch (kind) {
+    case Unary_Expression_Kind::bitwise_not: return operand.is_int();
+    case Unary_Expression_Kind::logical_not: return operand.is_bool();
+    case Unary_Expression_Kind::plus:
+    case Unary_Expression_Kind::minus: return operand.is_int() || operand.is_float();
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Invalid expression kind.");
+}
+
+[[nodiscard]]
+ast::Primary
+to_literal(const Value& value, const File_Source_Span& source_span, std::u8string_view source)
+{
+    switch (value.get_type_kind()) {
+    case Type_Kind::boolean: return ast::Primary::folded_bool(source_span, source, value.as_boolean());
+    case Type_Kind::integer:
+        return ast::Primary::folded_integer(source_span, source, value.as_integer());
+    case Type_Kind::floating: return ast::Primary::folded_float(source_span, source, value.as_float());
+    default: break;
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Folded expressions should only produce bool, int, or float.");
+}
+
+struct Constant_Folder {
+    Context& context;
+    std::size_t count = 0;
+
+    void operator()(std::span<ast::Markup_Element> content)
+    {
+        for (ast::Markup_Element& element : content) {
+            if (auto* const d = std::get_if<ast::Directive>(&element)) {
+                (*this)(*d);
+            }
+            else if (auto* const p = std::get_if<ast::Primary>(&element)) {
+                (*this)(*p);
+            }
+            else {
+                (*this)(std::get<ast::Expression>(element));
+            }
+        }
+    }
+
+    void operator()(ast::Directive& directive)
+    {
+        if (ast::Primary* const args = directive.get_arguments()) {
+            (*this)(*args);
+        }
+        if (ast::Primary* const content = directive.get_content()) {
+            (*this)(*content);
+        }
+    }
+
+    void operator()(ast::Primary& primary)
+    {
+        switch (primary.get_kind()) {
+        case ast::Primary_Kind::block:
+        case ast::Primary_Kind::quoted_string: {
+            (*this)(primary.get_elements());
+            break;
+        }
+        case ast::Primary_Kind::group: {
+            for (ast::Group_Member& member : primary.get_members()) {
+                if (member.has_value()) {
+                    (*this)(member.get_value());
+                }
+            }
+            break;
+        }
+        default: break;
+        }
+    }
+
+    void operator()(ast::Expression& expression)
+    {
+        if (auto* const d = std::get_if<ast::Directive>(&expression)) {
+            (*this)(*d);
+            return;
+        }
+        if (auto* const p = std::get_if<ast::Primary>(&expression)) {
+            (*this)(*p);
+            return;
+        }
+        if (auto* const let = std::get_if<ast::Let_Expression>(&expression)) {
+            (*this)(let->get_value());
+            return;
+        }
+        std::optional<ast::Primary> folded;
+        if (auto* const unary = std::get_if<ast::Unary_Expression>(&expression)) {
+            (*this)(unary->get_operand());
+            folded = fold(*unary);
+        }
+        else {
+            auto& binary = std::get<ast::Binary_Expression>(expression);
+            (*this)(binary.get_lhs());
+            (*this)(binary.get_rhs());
+            folded = fold(binary);
+        }
+        if (folded) {
+            // The outer expression may span more than the folded one (e.g. parentheses),
+            // so its own source span is kept.
+            expression = ast::Expression { ast::Expression { std::move(*folded) },
+                                           expression.get_source_span(), expression.get_source() };
+            ++count;
+        }
+    }
+
+    [[nodiscard]]
+    std::optional<ast::Primary> fold(const ast::Unary_Expression& expression)
+    {
+        const ast::Primary* const operand_primary = expression.get_operand().try_as_primary();
+        if (!operand_primary) {
+            return {};
+        }
+        std::pmr::u8string buffer { context.get_transient_memory() };
+        const std::optional<Value> operand = try_evaluate_literal(*operand_primary, buffer);
+        if (!operand || !is_foldable(expression.get_kind(), *operand)) {
+            return {};
+        }
+        const Result<Value, Processing_Status> result = evaluate_unary(
+            expression.get_kind(), *operand, expression.get_source_span(), context
+        );
+        COWEL_ASSERT(result);
+        return to_literal(*result, expression.get_source_span(), expression.get_source());
+    }
+
+    [[nodiscard]]
+    std::optional<ast::Primary> fold(const ast::Binary_Expression& expression)
+    {
+        const ast::Primary* const lhs_primary = expression.get_lhs().try_as_primary();
+        const ast::Primary* const rhs_primary = expression.get_rhs().try_as_primary();
+        if (!lhs_primary || !rhs_primary) {
+            return {};
+        }
+        std::pmr::u8string lhs_buffer { context.get_transient_memory() };
+        std::pmr::u8string rhs_buffer { context.get_transient_memory() };
+        const std::optional<Value> lhs = try_evaluate_literal(*lhs_primary, lhs_buffer);
+        if (!lhs) {
+            return {};
+        }
+        const std::optional<Value> rhs = try_evaluate_literal(*rhs_primary, rhs_buffer);
+        if (!rhs || !is_foldable(expression.get_kind(), *lhs, *rhs)) {
+            return {};
+        }
+        const Result<Value, Processing_Status> result = evaluate_builtin(
+            binary_expression_kind_builtin_operation_kind(expression.get_kind()), *lhs, *rhs,
+            expression.get_lhs().get_source_span(), expression.get_rhs().get_source_span(), context
+        );
+        COWEL_ASSERT(result);
+        return to_literal(*result, expression.get_source_span(), expression.get_source());
+    }
+};
+
+} // namespace
+
+std::size_t fold_constants(std::span<ast::Markup_Element> content, Context& context)
+{
+    Constant_Folder folder { context };
+    folder(content);
+    return folder.count;
+}
+
+} // namespace cowel
@@ -207,6 +207,10 @@ Syntax_Highlight_Policy::dump_html_to(Text_Sink& out, Context& context, std::u8s
                 buffer.write(snippet, Output_Language::html);
                 break;
             }
+            case Span_Type::section_reference: {
+                buffer.write_section_reference(Section_Id(span.begin));
+                break;
+            }
             case Span_Type::highlight: {
                 generate_highlighted(
                     buffer, code_string, span.begin, span.length, highlights, false
@@ -232,6 +236,10 @@ Syntax_Highlight_Policy::dump_html_to(Text_Sink& out, Context& context, std::u8s
                 out.write(snippet, Output_Language::html);
                 break;
             }
+            case Span_Type::section_reference: {
+                out.write_section_reference(Section_Id(span.begin));
+                break;
+            }
             case Span_Type::highlight: {
                 generate_highlighted(out, code_string, span.begin, span.length, highlights, true);
                 break;
@@ -4,20 +4,29 @@
 #include <exception>
 #include <memory_resource>
 #include <new>
+#include <optional>
 #include <span>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
+#include "cowel/util/char_sequence_ops.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
+#include "cowel/util/to_chars.hpp"
 
 #include "cowel/policy/capture.hpp"
+#include "cowel/policy/content_policy.hpp"
 #include "cowel/policy/html.hpp"
 
 #include "cowel/assets.hpp"
 #include "cowel/builtin_directive_set.hpp"
+#include "cowel/call_stack.hpp"
+#include "cowel/constant_folding.hpp"
 #include "cowel/context.hpp"
 #include "cowel/cowel.h"
 #include "cowel/cowel_lib.hpp"
@@ -25,6 +34,7 @@
 #include "cowel/directive_processing.hpp"
 #include "cowel/document_generation.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/memory_resources.hpp"
 #include "cowel/output_language.hpp"
 #include "cowel/print.hpp"
@@ -32,6 +42,7 @@
 #include "cowel/ulight_highlighter.hpp"
 
 #include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/ast_cache.hpp"
 #include "cowel/syntax/lex.hpp"
 #include "cowel/syntax/parse.hpp"
 
@@ -123,6 +134,7 @@ private:
     cowel_load_file_fn_u8* m_load_file;
     const void* m_load_file_data;
     std::pmr::vector<char8_t> m_buffer;
+    std::pmr::unordered_map<File_Id, Line_Table> m_line_tables;
     cowel_file_id m_max_valid_file_id = COWEL_FILE_ID_MAIN;
 
 public:
@@ -134,6 +146,7 @@ public:
         : m_load_file { load_file }
         , m_load_file_data { load_file_data }
         , m_buffer { memory }
+        , m_line_tables { memory }
     {
     }
 
@@ -167,6 +180,11 @@ public:
         if (result.status != COWEL_IO_OK) {
             return io_status_to_load_error(result.status);
         }
+        // Hosts may hand out the same id when a file is loaded repeatedly,
+        // in which case the existing line table is reused.
+        m_line_tables.try_emplace(
+            File_Id(result.id), as_u8string_view(result.data), m_buffer.get_allocator().resource()
+        );
         return File_Entry { .id = File_Id(result.id),
                             .source = as_u8string_view(result.data),
                             .name = as_u8string_view(path) };
@@ -177,6 +195,48 @@ public:
     {
         return id <= File_Id(m_max_valid_file_id);
     }
+
+    [[nodiscard]]
+    const Line_Table* find_line_table(File_Id id) const noexcept final
+    {
+        const auto it = m_line_tables.find(id);
+        return it == m_line_tables.end() ? nullptr : &it->second;
+    }
+};
+
+struct AST_Cache_From_Options final : AST_Cache {
+private:
+    cowel_load_cache_fn_u8* m_load_cache;
+    const void* m_load_cache_data;
+    cowel_store_cache_fn_u8* m_store_cache;
+    const void* m_store_cache_data;
+
+public:
+    [[nodiscard]]
+    explicit AST_Cache_From_Options(const cowel_options_u8& options)
+        : m_load_cache { options.load_cache }
+        , m_load_cache_data { options.load_cache_data }
+        , m_store_cache { options.store_cache }
+        , m_store_cache_data { options.store_cache_data }
+    {
+        COWEL_ASSERT(m_load_cache && m_store_cache);
+    }
+
+    [[nodiscard]]
+    std::span<const std::byte> load(std::u8string_view key) final
+    {
+        const cowel_cache_entry entry = m_load_cache(m_load_cache_data, as_cowel_string_view(key));
+        if (entry.data == nullptr) {
+            return {};
+        }
+        return { static_cast<const std::byte*>(entry.data), entry.size };
+    }
+
+    void store(std::u8string_view key, std::span<const std::byte> data) final
+    {
+        const cowel_cache_entry entry { .data = data.data(), .size = data.size() };
+        m_store_cache(m_store_cache_data, as_cowel_string_view(key), entry);
+    }
 };
 
 struct Logger_From_Options final : Logger {
@@ -268,6 +328,125 @@ public:
     }
 };
 
+/// @brief Passes the text written to it on to `cowel_options_u8::write`.
+/// Text is accumulated in a buffer first,
+/// so that `write` is not invoked for every tiny piece of text.
+struct Text_Sink_From_Options final : virtual Text_Sink {
+private:
+    static constexpr std::size_t chunk_size = 64 * 1024;
+
+    cowel_write_fn_u8* m_write;
+    const void* m_write_data;
+    std::pmr::vector<char8_t> m_buffer;
+
+public:
+    [[nodiscard]]
+    explicit Text_Sink_From_Options(
+        const cowel_options_u8& options,
+        std::pmr::memory_resource* memory
+    )
+        : Text_Sink { Text_Sink_Flags::none }
+        , m_write { options.write }
+        , m_write_data { options.write_data }
+        , m_buffer { memory }
+    {
+        COWEL_ASSERT(m_write);
+        m_buffer.reserve(chunk_size);
+    }
+
+    void write(Char_Sequence8 chars, const Output_Language language) override
+    {
+        COWEL_DEBUG_ASSERT(language == Output_Language::html);
+        // Large pieces of contiguous text (e.g. the text of whole sections)
+        // are passed on directly rather than being copied into the buffer.
+        if (const std::u8string_view str = chars.as_string_view(); str.size() >= chunk_size) {
+            flush();
+            m_write(m_write_data, { str.data(), str.size() });
+            return;
+        }
+        append(m_buffer, chars);
+        if (m_buffer.size() >= chunk_size) {
+            flush();
+        }
+    }
+
+    /// @brief Passes any buffered text to `write`.
+    void flush()
+    {
+        if (!m_buffer.empty()) {
+            m_write(m_write_data, { m_buffer.data(), m_buffer.size() });
+            m_buffer.clear();
+        }
+    }
+};
+
+/// @brief Collects the text written to it as a list of slices,
+/// which is passed on to `cowel_options_u8::write_slices` upon `flush`.
+/// Text written via `write_stable` (such as the text of document sections) is not copied;
+/// any other text is copied into memory owned by the sink.
+struct Slice_Text_Sink_From_Options final : virtual Text_Sink {
+private:
+    cowel_write_slices_fn_u8* m_write_slices;
+    const void* m_write_slices_data;
+    std::pmr::monotonic_buffer_resource m_copies;
+    std::pmr::vector<cowel_string_view_u8> m_slices;
+
+public:
+    [[nodiscard]]
+    explicit Slice_Text_Sink_From_Options(
+        const cowel_options_u8& options,
+        std::pmr::memory_resource* memory
+    )
+        : Text_Sink { Text_Sink_Flags::none }
+        , m_write_slices { options.write_slices }
+        , m_write_slices_data { options.write_slices_data }
+        , m_copies { memory }
+        , m_slices { memory }
+    {
+        COWEL_ASSERT(m_write_slices);
+    }
+
+    void write(Char_Sequence8 chars, const Output_Language language) override
+    {
+        COWEL_DEBUG_ASSERT(language == Output_Language::html);
+        const std::size_t size = chars.size();
+        if (size == 0) {
+            return;
+        }
+        auto* const copy = static_cast<char8_t*>(m_copies.allocate(size, alignof(char8_t)));
+        chars.extract({ copy, size });
+        push_slice({ copy, size });
+    }
+
+    void write_stable(const std::u8string_view str, const Output_Language language) override
+    {
+        COWEL_DEBUG_ASSERT(language == Output_Language::html);
+        if (!str.empty()) {
+            push_slice(str);
+        }
+    }
+
+    /// @brief Passes all slices to `write_slices`.
+    /// This has to happen while the text written via `write_stable` is still alive.
+    void flush()
+    {
+        m_write_slices(m_write_slices_data, m_slices.data(), m_slices.size());
+        m_slices.clear();
+    }
+
+private:
+    void push_slice(const std::u8string_view str)
+    {
+        // Consecutive copies are usually adjacent in memory,
+        // so they can be merged into a single slice.
+        if (!m_slices.empty() && m_slices.back().text + m_slices.back().length == str.data()) {
+            m_slices.back().length += str.size();
+            return;
+        }
+        m_slices.push_back({ str.data(), str.size() });
+    }
+};
+
 struct Syntax_Highlighter_From_Options final : Syntax_Highlighter {
 private:
     std::pmr::vector<std::u8string_view> m_supported_languages;
@@ -489,7 +668,10 @@ cowel_dump_parse_result_u8 do_dump_parse(const cowel_dump_parse_options_u8& opti
     }
 
     std::pmr::vector<CST_Instruction> instructions { memory };
-    if (!parse(instructions, std::span<const Token> { tokens }, on_error)) {
+    if (!parse(
+            instructions, as_u8string_view(options.source), std::span<const Token> { tokens },
+            on_error
+        )) {
         return {
             .status = COWEL_PROCESSING_ERROR,
             .output = {},
@@ -539,8 +721,33 @@ cowel_gen_result_u8 do_generate_html(const cowel_options_u8& options)
         ? static_cast<std::pmr::memory_resource*>(&pointer_memory)
         : static_cast<std::pmr::memory_resource*>(&global_memory);
 
+    // All GC nodes created while parsing and processing the document are allocated
+    // from this heap, which is released in bulk once generation has finished.
+    // It has to be declared prior to the AST so that it outlives the AST.
+    GC_Heap gc_heap { memory };
+    const Scoped_GC_Heap gc_heap_scope { gc_heap };
+
+    // If the output is passed to options.write_slices or streamed through options.write,
+    // html_sink remains empty and the output of the result is empty as well.
     Vector_Text_Sink html_sink { Output_Language::html, memory };
-    HTML_Content_Policy html_policy { html_sink };
+    std::optional<Slice_Text_Sink_From_Options> slice_sink;
+    std::optional<Text_Sink_From_Options> write_sink;
+    if (options.write_slices) {
+        slice_sink.emplace(options, memory);
+    }
+    else if (options.write) {
+        write_sink.emplace(options, memory);
+    }
+    Text_Sink& output_sink = [&] -> Text_Sink& {
+        if (slice_sink) {
+            return *slice_sink;
+        }
+        if (write_sink) {
+            return *write_sink;
+        }
+        return html_sink;
+    }();
+    HTML_Content_Policy html_policy { output_sink };
 
     const Builtin_Directive_Set builtin_behavior {};
 
@@ -595,10 +802,26 @@ cowel_gen_result_u8 do_generate_html(const cowel_options_u8& options)
               const File_Source_Span file_pos { pos, File_Id::main };
               logger(Diagnostic { Severity::error, id, file_pos, message, {} });
           };
-    ast::Pmr_Vector<ast::Markup_Element> root_content;
-    const bool preamble_parse_success = lex_and_parse_and_build(
-        root_content, preamble_source, File_Id::main, memory, on_parse_error
-    );
+    // The arena has to be declared prior to the AST so that it outlives the AST.
+    std::optional<GC_Arena> ast_arena;
+    if (options.flags & COWEL_GEN_FLAGS_AST_ARENA) {
+        ast_arena.emplace(memory);
+    }
+    ast::Pmr_Vector<ast::Markup_Element> root_content { ast_arena ? ast_arena->get_memory()
+                                                                  : memory };
+    std::optional<AST_Cache_From_Options> ast_cache;
+    if (options.load_cache && options.store_cache) {
+        ast_cache.emplace(options);
+    }
+    Parse_Buffers parse_buffers { memory };
+    const auto parse_into_root = [&](std::u8string_view source) -> bool {
+        return lex_and_parse_and_build_cached(
+            root_content, parse_buffers, source, nullptr, File_Id::main,
+            ast_cache ? &*ast_cache : nullptr, memory, ast_arena ? &*ast_arena : nullptr,
+            on_parse_error
+        );
+    };
+    const bool preamble_parse_success = parse_into_root(preamble_source);
     if (!preamble_parse_success) {
         return {
             .status = COWEL_PROCESSING_ERROR,
@@ -608,8 +831,7 @@ cowel_gen_result_u8 do_generate_html(const cowel_options_u8& options)
         };
     }
 
-    const bool main_parse_success
-        = lex_and_parse_and_build(root_content, main_source, File_Id::main, memory, on_parse_error);
+    const bool main_parse_success = parse_into_root(main_source);
     if (!main_parse_success) {
         return {
             .status = COWEL_PROCESSING_ERROR,
@@ -658,19 +880,54 @@ cowel_gen_result_u8 do_generate_html(const cowel_options_u8& options)
         .logger = logger,
         .highlighter = highlighter,
         .hover_sink = (options.flags & COWEL_GEN_FLAGS_COLLECT_HOVERS) ? &hover_entries : nullptr,
+        .ast_arena = ast_arena ? &*ast_arena : nullptr,
+        .ast_cache = ast_cache ? &*ast_cache : nullptr,
+        .fold_constants = (options.flags & COWEL_GEN_FLAGS_FOLD_CONSTANTS) != 0,
+        .max_call_depth = options.max_call_depth == 0 ? default_max_call_depth
+                                                      : options.max_call_depth,
+        .gc_heap = &gc_heap,
         .memory = memory,
     };
 
     const Processing_Status status = run_generation(
         [&](Context& context) -> Processing_Status {
-            if (options.mode == COWEL_MODE_MINIMAL) {
-                return splice_all(html_policy, root_content, Frame_Index::root, context);
+            if (context.get_fold_constants()) {
+                fold_constants(root_content, context);
             }
-            COWEL_ASSERT(options.mode == COWEL_MODE_DOCUMENT);
-            return write_wg21_document(html_policy, root_content, context);
+            const Processing_Status result = [&] {
+                if (options.mode == COWEL_MODE_MINIMAL) {
+                    return splice_all(html_policy, root_content, Frame_Index::root, context);
+                }
+                COWEL_ASSERT(options.mode == COWEL_MODE_DOCUMENT);
+                // The HTML policy would merely forward the resolved document to output_sink,
+                // so output_sink is used directly, which lets the text of sections
+                // reach the sink via write_stable.
+                return write_wg21_document(output_sink, root_content, context);
+            }();
+            // The slices refer to the text of sections, which is owned by the context.
+            if (slice_sink) {
+                slice_sink->flush();
+            }
+            return result;
         },
         gen_options
     );
+    if (write_sink) {
+        write_sink->flush();
+    }
+
+    if (cowel_severity(Severity::trace) >= options.min_log_severity) {
+        const GC_Heap_Statistics& gc_statistics = gc_heap.get_statistics();
+        std::pmr::u8string message { memory };
+        message += u8"GC heap: "sv;
+        message += std::u8string_view(to_characters8(gc_statistics.total_nodes));
+        message += u8" nodes allocated, "sv;
+        message += std::u8string_view(to_characters8(gc_statistics.peak_live_bytes));
+        message += u8" bytes alive at peak, "sv;
+        message += std::u8string_view(to_characters8(gc_statistics.live_nodes));
+        message += u8" nodes alive after processing."sv;
+        try_log(message, Severity::trace);
+    }
 
     // Build the flat hover buffer when requested.
     cowel_hover_u8* hovers_ptr = nullptr;
@@ -1,13 +1,17 @@
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
 #include "cowel/util/assert.hpp"
+#include "cowel/util/char_sequence_factory.hpp"
 #include "cowel/util/code_point_names.hpp"
 #include "cowel/util/html_writer.hpp"
 #include "cowel/util/result.hpp"
@@ -20,6 +24,7 @@
 #include "cowel/policy/paragraph_split.hpp"
 #include "cowel/policy/plaintext.hpp"
 
+#include "cowel/bytecode.hpp"
 #include "cowel/content_status.hpp"
 #include "cowel/context.hpp"
 #include "cowel/diagnostic.hpp"
@@ -202,7 +207,7 @@ Short_String_Directive_Behavior::evaluate(const Invocation& call, Context& conte
     if (!result) {
         return result.error();
     }
-    return Value::short_string(*result, String_Kind::unknown);
+    return Value::string(result->as_string(), String_Kind::unknown);
 }
 
 Processing_Status Short_String_Directive_Behavior::splice(
@@ -242,7 +247,7 @@ const Type& get_static_type(const ast::Expression& v, Context& context)
 [[nodiscard]]
 const Type& get_static_type(const ast::Directive& directive, Context& context)
 {
-    const Directive_Behavior* const behavior = context.find_directive(directive.get_name());
+    const Directive_Behavior* const behavior = context.find_directive(directive);
     return behavior ? behavior->get_static_type() : Type::any;
 }
 
@@ -286,24 +291,56 @@ const Directive_Behavior* Context::find_directive(std::u8string_view name)
     return m_builtin_name_resolver(name);
 }
 
+const Directive_Behavior* Context::find_directive(const ast::Directive& directive)
+{
+    const Directive_Behavior* const cached = directive.get_cached_behavior(m_definition_epoch);
+    if (cached) {
+        return cached;
+    }
+    const Directive_Behavior* const result = find_directive(directive.get_name());
+    if (result) {
+        directive.cache_behavior(result, m_definition_epoch);
+    }
+    return result;
+}
+
+Symbol Context::intern(const ast::Primary& id)
+{
+    COWEL_DEBUG_ASSERT(id.get_kind() == ast::Primary_Kind::id_expression);
+    if (const std::optional<Symbol> cached = id.get_cached_symbol(m_symbol_epoch)) {
+        return *cached;
+    }
+    const Symbol result = m_symbols.intern(id.get_source());
+    id.cache_symbol(result, m_symbol_epoch);
+    return result;
+}
+
+Definition_Epoch Context::make_definition_epoch()
+{
+    // Epochs are unique across all contexts rather than per context
+    // because the same AST may be processed by multiple contexts,
+    // such as when a document is regenerated in the language server.
+    static std::atomic<Uint64> next_epoch = 1;
+    return Definition_Epoch(next_epoch.fetch_add(1, std::memory_order_relaxed));
+}
+
 bool Context::emplace_macro(
-    std::pmr::u8string&& name,
+    const std::u8string_view name,
     const std::span<const ast::Markup_Element> definition,
-    const std::u8string_view macro_source
+    const std::u8string_view macro_source,
+    const bool pure
 )
 {
     std::pmr::memory_resource* const memory = m_macros.get_allocator().resource();
-    // TODO: once available, upgrade this to std::from_range construction
-    std::pmr::vector<ast::Markup_Element> body {
-        definition.begin(),
-        definition.end(),
-        memory,
-    };
+    const Symbol symbol = m_symbols.intern(name);
     std::pmr::u8string name_copy { name, memory };
     std::pmr::u8string decl_str { macro_source, memory };
     const auto [_, success] = m_macros.try_emplace(
-        std::move(name), std::move(body), std::move(name_copy), std::move(decl_str)
+        symbol, definition, std::move(name_copy), std::move(decl_str), pure
     );
+    if (success) {
+        m_definition_epoch = make_definition_epoch();
+    }
     return success;
 }
 
@@ -361,6 +398,27 @@ void try_lookup_error(const ast::Directive& directive, Context& context)
     );
 }
 
+/// @brief Checks whether another directive can be invoked
+/// without exceeding the maximum call depth,
+/// and emits a fatal error if not.
+/// This turns runaway recursion (e.g. a macro which expands itself)
+/// into a diagnostic rather than exhausting the native stack.
+[[nodiscard]]
+bool check_call_depth(const ast::Directive& directive, Context& context)
+{
+    const std::size_t max_depth = context.get_max_call_depth();
+    if (context.get_call_stack().size() < max_depth) {
+        return true;
+    }
+    context.try_fatal_f(
+        diagnostic::call_depth, directive.get_name_span(),
+        u8"Invoking \\{} exceeds the maximum call depth of {}. "
+        u8"This is likely caused by a macro which expands itself unconditionally."sv,
+        directive.get_name(), max_depth
+    );
+    return false;
+}
+
 } // namespace
 
 Processing_Status splice_to_plaintext(
@@ -433,13 +491,18 @@ Processing_Status splice_primary(
         return Processing_Status::ok;
     }
     case ast::Primary_Kind::null_literal:
-    case ast::Primary_Kind::bool_literal:
     case ast::Primary_Kind::unquoted_member_name: {
         out.write(primary.get_source(), Output_Language::text);
         return Processing_Status::ok;
     }
+    case ast::Primary_Kind::bool_literal: {
+        // The source of folded literals is that of the original expression,
+        // so it cannot be used here.
+        out.write(primary.get_bool_value() ? u8"true"sv : u8"false"sv, Output_Language::text);
+        return Processing_Status::ok;
+    }
     case ast::Primary_Kind::id_expression: {
-        const Value* const var = context.get_variable(primary.get_source());
+        const Value* const var = context.get_variable(context.intern(primary));
         if (!var) {
             context.try_error(
                 diagnostic::id_lookup, primary.get_source_span(),
@@ -671,8 +734,20 @@ Processing_Status splice_expression_to_plaintext(
 Result<Value, Processing_Status>
 evaluate_expression(const ast::Expression& value, Frame_Index frame, Context& context)
 {
+    // Compound expressions are compiled once and then executed,
+    // rather than walking the tree and re-dispatching on each node whenever they are evaluated.
+    if (value.is_unary() || value.is_binary() || value.is_let()) {
+        return execute_bytecode(context.get_bytecode(value), frame, context);
+    }
     const auto diagnostic_frame = context.push_diagnostic_frame(frame);
-    const auto visitor = [&](const auto& v) { return evaluate(v, frame, context); };
+    const auto visitor = [&]<typename T>(const T& v) -> Result<Value, Processing_Status> {
+        if constexpr (std::is_same_v<T, ast::Directive> || std::is_same_v<T, ast::Primary>) {
+            return evaluate(v, frame, context);
+        }
+        else {
+            COWEL_ASSERT_UNREACHABLE(u8"Compound expressions are executed as bytecode.");
+        }
+    };
     return std::visit(visitor, value);
 }
 
@@ -688,7 +763,7 @@ evaluate(const ast::Directive& directive, Frame_Index frame, Context& context)
         .content_frame = frame,
         .call_frame = {},
     };
-    const Directive_Behavior* const behavior = context.find_directive(call.name);
+    const Directive_Behavior* const behavior = context.find_directive(directive);
     if (!behavior) {
         try_lookup_error(directive, context);
         call.call_frame = context.get_call_stack().get_top_index();
@@ -705,120 +780,14 @@ evaluate(const ast::Directive& directive, Frame_Index frame, Context& context)
         directive.mark_symbolized();
     }
 
+    if (!check_call_depth(directive, context)) {
+        return Processing_Status::fatal;
+    }
     const Scoped_Frame scope = context.get_call_stack().push_scoped({ *behavior, call });
     call.call_frame = scope.get_index();
     return behavior->evaluate(call, context);
 }
 
-[[nodiscard]]
-Result<Value, Processing_Status> evaluate(
-    const ast::Unary_Expression& expression, //
-    const Frame_Index frame,
-    Context& context
-)
-{
-    Result<Value, Processing_Status> result
-        = evaluate_expression(expression.get_operand(), frame, context);
-    if (!result) {
-        return result;
-    }
-    return evaluate_unary(expression.get_kind(), *result, expression.get_source_span(), context);
-}
-
-[[nodiscard]]
-Result<Value, Processing_Status>
-evaluate(const ast::Binary_Expression& expression, const Frame_Index frame, Context& context)
-{
-    const Binary_Expression_Kind kind = expression.get_kind();
-    const File_Source_Span& span = expression.get_source_span();
-
-    // Short-circuit logical operators: evaluate LHS first;
-    // if the result determines the outcome, skip RHS evaluation.
-    if (kind == Binary_Expression_Kind::logical_or || kind == Binary_Expression_Kind::logical_and) {
-        const bool terminator = kind == Binary_Expression_Kind::logical_or;
-
-        auto lhs_result = evaluate_expression(expression.get_lhs(), frame, context);
-        if (!lhs_result) {
-            return lhs_result;
-        }
-        if (!lhs_result->is_bool()) {
-            context.try_error(
-                diagnostic::type_mismatch, span,
-                joined_char_sequence(
-                    {
-                        u8"Expected a value of type "sv,
-                        Type::boolean.get_display_name(),
-                        u8", but got "sv,
-                        lhs_result->get_type().get_display_name(),
-                        u8"."sv,
-                    }
-                )
-            );
-            return Processing_Status::error;
-        }
-        if (lhs_result->as_boolean() == terminator) {
-            return Value::boolean(terminator);
-        }
-
-        auto rhs_result = evaluate_expression(expression.get_rhs(), frame, context);
-        if (!rhs_result) {
-            return rhs_result;
-        }
-        if (!rhs_result->is_bool()) {
-            context.try_error(
-                diagnostic::type_mismatch, span,
-                joined_char_sequence(
-                    {
-                        u8"Expected a value of type "sv,
-                        Type::boolean.get_display_name(),
-                        u8", but got "sv,
-                        rhs_result->get_type().get_display_name(),
-                        u8"."sv,
-                    }
-                )
-            );
-            return Processing_Status::error;
-        }
-        return Value::boolean(rhs_result->as_boolean());
-    }
-
-    // For all other operators, evaluate both operands unconditionally.
-    auto lhs_result = evaluate_expression(expression.get_lhs(), frame, context);
-    if (!lhs_result) {
-        return lhs_result;
-    }
-    auto rhs_result = evaluate_expression(expression.get_rhs(), frame, context);
-    if (!rhs_result) {
-        return rhs_result;
-    }
-
-    const Value& lhs = *lhs_result;
-    const Value& rhs = *rhs_result;
-
-    const auto dynamic_operation = binary_expression_kind_builtin_operation_kind(kind);
-    return evaluate_builtin(
-        dynamic_operation, lhs, rhs, expression.get_lhs().get_source_span(),
-        expression.get_rhs().get_source_span(), context
-    );
-}
-
-[[nodiscard]]
-Result<Value, Processing_Status>
-evaluate(const ast::Let_Expression& expression, const Frame_Index frame, Context& context)
-{
-    Result<Value, Processing_Status> rhs_result
-        = evaluate_expression(expression.get_value(), frame, context);
-    if (!rhs_result) {
-        return rhs_result;
-    }
-    const Value lhs = Value::static_string(expression.get_name(), String_Kind::ascii);
-
-    return evaluate_builtin(
-        Builtin_Operation_Kind::let_dynamic, lhs, *rhs_result, expression.get_source_span(),
-        expression.get_source_span(), context
-    );
-}
-
 Result<Value, Processing_Status> evaluate_unary(
     Unary_Expression_Kind kind, //
     const Value& value,
@@ -962,6 +931,55 @@ struct Evaluate_Member_Values {
     }
 };
 
+/// @brief Evaluates a *quoted-string*.
+/// Variables of type `str` that are interpolated into the string (e.g. `"\(s)..."`)
+/// are concatenated via `Value::string_concat` rather than being copied into a buffer,
+/// so that repeatedly appending to a string variable does not copy its contents each time.
+[[nodiscard]]
+Result<Value, Processing_Status>
+evaluate_quoted_string(const ast::Primary& value, Frame_Index frame, Context& context)
+{
+    COWEL_DEBUG_ASSERT(value.get_kind() == ast::Primary_Kind::quoted_string);
+    Vector_Text_Sink text { Output_Language::text, context.get_transient_memory() };
+    Text_Only_Policy policy { text };
+    Value result = Value::empty_string;
+    const auto flush_text = [&] {
+        if (text->empty()) {
+            return;
+        }
+        const auto text_str = as_u8string_view(*text);
+        const auto kind = is_all_ascii(text_str) ? String_Kind::ascii : String_Kind::unicode;
+        result = Value::string_concat(result, Value::string(text_str, kind));
+        text->clear();
+    };
+
+    const auto consume = [&](const ast::Markup_Element& element) -> Processing_Status {
+        const auto* const expression = std::get_if<ast::Expression>(&element);
+        const ast::Primary* const primary = expression ? expression->try_as_primary() : nullptr;
+        if (!primary || primary->get_kind() != ast::Primary_Kind::id_expression) {
+            return policy.consume_content(element, frame, context);
+        }
+        const Result<Value, Processing_Status> variable
+            = evaluate_expression(*expression, frame, context);
+        if (!variable) {
+            return variable.error();
+        }
+        if (!variable->is_str()) {
+            return splice_value(policy, *variable, primary->get_source_span(), context);
+        }
+        flush_text();
+        result = Value::string_concat(result, *variable);
+        return Processing_Status::ok;
+    };
+
+    const Processing_Status status = process_greedy(value.get_elements(), consume);
+    if (status != Processing_Status::ok) {
+        return status;
+    }
+    flush_text();
+    return result;
+}
+
 } // namespace
 
 [[nodiscard]]
@@ -1030,7 +1048,7 @@ evaluate(const ast::Primary& value, Frame_Index frame, Context& context)
         return Value::static_string(value.get_source(), value.get_string_kind());
     }
     case ast::Primary_Kind::id_expression: {
-        const Value* const var = context.get_variable(value.get_source());
+        const Value* const var = context.get_variable(context.intern(value));
         if (!var) {
             context.try_error(
                 diagnostic::id_lookup, value.get_source_span(),
@@ -1051,15 +1069,7 @@ evaluate(const ast::Primary& value, Frame_Index frame, Context& context)
         //       or only a single escape sequence,
         //       we don't need an extra dynamic buffer for splicing.
         //       We also don't need to re-compute the string kind then.
-        Vector_Text_Sink text { Output_Language::text, context.get_transient_memory() };
-        Text_Only_Policy policy { text };
-        const Processing_Status result = splice_primary(policy, value, frame, context);
-        if (result != Processing_Status::ok) {
-            return result;
-        }
-        const auto result_str = as_u8string_view(*text);
-        const auto kind = is_all_ascii(result_str) ? String_Kind::ascii : String_Kind::unicode;
-        return Value::string(result_str, kind);
+        return evaluate_quoted_string(value, frame, context);
     }
     case ast::Primary_Kind::block: {
         return Value::block(value, frame);
@@ -1100,7 +1110,11 @@ Processing_Status splice_invocation( //
         .content_frame = content_frame,
         .call_frame = {},
     };
-    const Directive_Behavior* const behavior = context.find_directive(name);
+    // When invoked through cowel_invoke, the name differs from that of the directive,
+    // so the behavior cached in the directive cannot be used.
+    const Directive_Behavior* const behavior = name == directive.get_name()
+        ? context.find_directive(directive)
+        : context.find_directive(name);
     if (!behavior) {
         try_lookup_error(directive, context);
         call.call_frame = context.get_call_stack().get_top_index();
@@ -1117,6 +1131,9 @@ Processing_Status splice_invocation( //
         directive.mark_symbolized();
     }
 
+    if (!check_call_depth(directive, context)) {
+        return Processing_Status::fatal;
+    }
     const Scoped_Frame scope = context.get_call_stack().push_scoped({ *behavior, call });
     call.call_frame = scope.get_index();
     return behavior->splice(out, call, context);
@@ -1,3 +1,5 @@
+#include "cowel/util/char_sequence_factory.hpp"
+
 #include "cowel/builtin_directive_set.hpp"
 #include "cowel/context.hpp"
 #include "cowel/directive_processing.hpp"
@@ -9,13 +11,17 @@ namespace cowel {
 
 Processing_Status Alias_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"names"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Of_Type_Matcher names { Type::pack_of(&Type::str) };
-    Parameter names_param { u8"names"sv, Optionality::optional, names };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &names_param, &content_param };
+    Value_Matcher* const matchers[] { &names, &content_matcher };
 
-    const Processing_Status match_status = match_call_fatal_error(parameters, call, context);
+    const Processing_Status match_status = match_call_fatal_error(schema, matchers, call, context);
     switch (match_status) {
     case Processing_Status::ok: break;
     case Processing_Status::brk:
@@ -141,9 +147,7 @@ Processing_Status Alias_Behavior::do_evaluate(const Invocation& call, Context& c
             );
             return Processing_Status::fatal;
         }
-        const bool success = context.emplace_alias(
-            std::pmr::u8string { alias_name, context.get_transient_memory() }, target_behavior
-        );
+        const bool success = context.emplace_alias(alias_name, target_behavior);
         COWEL_ASSERT(success);
     }
 
@@ -17,6 +17,8 @@
 #include "cowel/content_status.hpp"
 #include "cowel/context.hpp"
 #include "cowel/diagnostic.hpp"
+#include "cowel/document_sections.hpp"
+#include "cowel/fwd.hpp"
 #include "cowel/invocation.hpp"
 #include "cowel/parameters.hpp"
 #include "cowel/services.hpp"
@@ -130,28 +132,37 @@ void write_bibliography_entry(
 Processing_Status
 Bibliography_Add_Behavior::splice(Content_Policy&, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"id"sv, Optionality::mandatory },
+        { u8"title"sv, Optionality::optional },
+        { u8"date"sv, Optionality::optional },
+        { u8"publisher"sv, Optionality::optional },
+        { u8"link"sv, Optionality::optional },
+        { u8"long_link"sv, Optionality::optional },
+        { u8"author"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     auto* memory = context.get_transient_memory();
 
     Spliceable_To_String_Matcher id_string { memory };
-    Parameter id_param { u8"id", Optionality::mandatory, id_string };
     Spliceable_To_String_Matcher title_string { memory };
-    Parameter title_param { u8"title", Optionality::optional, title_string };
     Spliceable_To_String_Matcher date_string { memory };
-    Parameter date_param { u8"date", Optionality::optional, date_string };
     Spliceable_To_String_Matcher publisher_string { memory };
-    Parameter publisher_param { u8"publisher", Optionality::optional, publisher_string };
     Spliceable_To_String_Matcher link_string { memory };
-    Parameter link_param { u8"link", Optionality::optional, link_string };
     Spliceable_To_String_Matcher long_link_string { memory };
-    Parameter long_link_param { u8"long_link", Optionality::optional, long_link_string };
     Spliceable_To_String_Matcher author_string { memory };
-    Parameter author_param { u8"author", Optionality::optional, author_string };
-    Parameter* const parameters[] {
-        &id_param,   &title_param,     &date_param,   &publisher_param,
-        &link_param, &long_link_param, &author_param,
+    Value_Matcher* const matchers[] {
+        &id_string,
+        &title_string,
+        &date_string,
+        &publisher_string,
+        &link_string,
+        &long_link_string,
+        &author_string,
     };
 
-    const Processing_Status match_status = match_call(parameters, call, context);
+    const Processing_Status match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -181,9 +192,13 @@ Bibliography_Add_Behavior::splice(Content_Policy&, const Invocation& call, Conte
     // those tags will be "<a href=..." and "</a>",
     // otherwise the sections remain empty.
     {
-        std::pmr::u8string section_name { u8"std.bib.", context.get_transient_memory() };
-        section_name += info.id;
-        const auto scope = context.get_sections().go_to_scoped(section_name);
+        const std::u8string_view section_name_parts[] {
+            section_name::bibliography,
+            u8"."sv,
+            info.id,
+        };
+        const Section_Id section = context.get_sections().intern(section_name_parts);
+        const auto scope = context.get_sections().go_to_scoped(section);
         Content_Policy& section_out = context.get_sections().current_policy();
         HTML_Writer_Buffer buffer { section_out, Output_Language::html };
         Text_Buffer_HTML_Writer section_writer { buffer };
@@ -43,11 +43,15 @@ Code_Point_Behavior::do_evaluate(const Invocation& call, Context& context) const
 Result<char32_t, Processing_Status>
 Char_By_Num_Behavior::get_code_point(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"num", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Integer_Matcher num_matcher;
-    Parameter num_param { u8"num", Optionality::mandatory, num_matcher };
-    Parameter* const parameters[] { &num_param };
+    Value_Matcher* const matchers[] { &num_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -82,11 +86,15 @@ Char_By_Name_Behavior::get_code_point(const Invocation& call, Context& context)
 {
     constexpr auto error_point = char32_t(-1);
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name", Optionality::mandatory, name_matcher };
-    Parameter* const parameters[] { &name_param };
+    Value_Matcher* const matchers[] { &name_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -110,11 +118,15 @@ Char_By_Name_Behavior::get_code_point(const Invocation& call, Context& context)
 Result<Big_Int, Processing_Status>
 Char_Get_Num_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher x_matcher { context.get_transient_memory() };
-    Parameter x_parameter { u8"x", Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_parameter };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -157,11 +169,15 @@ Char_Get_Num_Behavior::do_evaluate(const Invocation& call, Context& context) con
 Result<Value, Processing_Status>
 Char_Get_Name_Behavior::evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher x_matcher { context.get_transient_memory() };
-    Parameter x_parameter { u8"x", Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_parameter };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -3,22 +3,26 @@
 
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/char_sequence_factory.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/source_position.hpp"
 
 #include "cowel/policy/content_policy.hpp"
 
 #include "cowel/builtin_directive_set.hpp"
+#include "cowel/constant_folding.hpp"
 #include "cowel/content_status.hpp"
 #include "cowel/context.hpp"
 #include "cowel/diagnostic.hpp"
 #include "cowel/directive_processing.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/invocation.hpp"
 #include "cowel/parameters.hpp"
 #include "cowel/services.hpp"
 
 #include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/ast_cache.hpp"
 #include "cowel/syntax/parse.hpp"
 
 using namespace std::string_view_literals;
@@ -45,11 +49,15 @@ std::u8string_view file_load_error_explanation(File_Load_Error error)
 Processing_Status
 Include_Text_Behavior::do_evaluate(String_Sink& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"path", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher path_matcher { context.get_transient_memory() };
-    Parameter path_param { u8"path", Optionality::mandatory, path_matcher };
-    Parameter* const parameters[] { &path_param };
+    Value_Matcher* const matchers[] { &path_matcher };
 
-    const auto match_status = match_call_fatal_error(parameters, call, context);
+    const auto match_status = match_call_fatal_error(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -84,11 +92,15 @@ Include_Text_Behavior::do_evaluate(String_Sink& out, const Invocation& call, Con
 Processing_Status
 Include_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"path", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher path_matcher { context.get_transient_memory() };
-    Parameter path_param { u8"path", Optionality::mandatory, path_matcher };
-    Parameter* const parameters[] { &path_param };
+    Value_Matcher* const matchers[] { &path_matcher };
 
-    const auto match_status = match_call_fatal_error(parameters, call, context);
+    const auto match_status = match_call_fatal_error(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -128,9 +140,15 @@ Include_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
               context.emit(severity, id, file_location, message);
           };
 
-    ast::Pmr_Vector<ast::Markup_Element> imported_content { context.get_transient_memory() };
-    const bool parse_success = lex_and_parse_and_build(
-        imported_content, entry->source, entry->id, context.get_transient_memory(), on_parse_error
+    GC_Arena* const arena = context.get_ast_arena();
+    ast::Pmr_Vector<ast::Markup_Element> imported_content {
+        arena ? arena->get_memory() : context.get_transient_memory()
+    };
+    const Line_Table* const lines = context.get_file_loader().find_line_table(entry->id);
+    Parse_Buffers& buffers = context.get_parse_buffers();
+    const bool parse_success = lex_and_parse_and_build_cached(
+        imported_content, buffers, entry->source, lines, entry->id, context.get_ast_cache(),
+        context.get_transient_memory(), arena, on_parse_error
     );
     if (!parse_success) {
         context.try_fatal(
@@ -145,9 +163,20 @@ Include_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
         );
         return Processing_Status::fatal;
     }
+    if (context.get_fold_constants()) {
+        fold_constants(imported_content, context);
+    }
 
     try_inherit_paragraph(out);
-    return splice_all(out, imported_content, call.call_frame, context);
+    const std::size_t macro_count = context.get_macro_count();
+    const Processing_Status status
+        = splice_all(out, imported_content, call.call_frame, context);
+    // Macros defined in the imported document refer to its AST instead of copying their bodies,
+    // so the AST needs to outlive the context in that case.
+    if (context.get_macro_count() != macro_count) {
+        context.retain_document(std::move(imported_content));
+    }
+    return status;
 }
 
 } // namespace cowel
@@ -14,7 +14,6 @@
 #include "cowel/util/strings.hpp"
 #include "cowel/util/to_chars.hpp"
 
-#include "cowel/policy/capture.hpp"
 #include "cowel/policy/content_policy.hpp"
 #include "cowel/policy/html.hpp"
 
@@ -69,21 +68,29 @@ void reset_heading_counters() noexcept
 Processing_Status
 Heading_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"id"sv, Optionality::optional },
+        { u8"listed"sv, Optionality::optional },
+        { u8"show_number"sv, Optionality::optional },
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher id_matcher { context.get_transient_memory() };
-    Parameter id_param { u8"id"sv, Optionality::optional, id_matcher };
     Boolean_Matcher listed_boolean;
-    Parameter listed_param { u8"listed"sv, Optionality::optional, listed_boolean };
     Boolean_Matcher show_number_boolean;
-    Parameter show_number_param { u8"show_number"sv, Optionality::optional, show_number_boolean };
     Group_Pack_Named_Str_Matcher attr_group;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_group };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] {
-        &id_param, &listed_param, &show_number_param, &attr_param, &content_param,
+    Value_Matcher* const matchers[] {
+        &id_matcher,
+        &listed_boolean,
+        &show_number_boolean,
+        &attr_group,
+        &content_matcher,
     };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -155,9 +162,9 @@ Heading_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
     }
 
     // 2. Generate user content in the heading.
-    std::pmr::vector<char8_t> heading_html { context.get_transient_memory() };
+    Captured_HTML heading_html { context.get_transient_memory() };
     {
-        Capturing_Ref_Text_Sink heading_sink { heading_html, Output_Language::html };
+        Capturing_HTML_Sink heading_sink { heading_html };
         HTML_Content_Policy html_policy { heading_sink };
         const auto heading_status = content_matcher.get().splice_block(html_policy, context);
         current_status = status_concat(current_status, heading_status);
@@ -167,7 +174,7 @@ Heading_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
             return current_status;
         }
     }
-    const auto heading_html_string = as_u8string_view(heading_html);
+    const std::u8string_view heading_html_string = heading_html.str();
 
     // 3. Check for id duplication.
     const bool has_valid_id = [&] {
@@ -213,7 +220,7 @@ Heading_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
         write_numbers(writer);
         writer.write_inner_html(u8". "sv);
     }
-    writer.write_inner_html(heading_html_string);
+    heading_html.write_to(buffer);
     writer.close_tag(tag_name);
 
     // 6. Also write an ID preview in case the heading is referenced via \ref[#id]
@@ -236,7 +243,7 @@ Heading_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
         else {
             id_preview_out.write_inner_html(u8' ');
         }
-        id_preview_out.write_inner_html(heading_html_string);
+        heading_html.write_to(id_preview_buffer);
         id_preview_buffer.flush();
     }
 
@@ -264,7 +271,7 @@ Heading_Behavior::splice(Content_Policy& out, const Invocation& call, Context& c
         }
 
         toc_writer.open_tag(tag_name);
-        toc_writer.write_inner_html(heading_html_string);
+        heading_html.write_to(toc_buffer);
         toc_writer.close_tag(tag_name);
 
         if (has_valid_id) {
@@ -303,13 +310,17 @@ Processing_Status with_section_name(
 Processing_Status
 There_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"section"sv, Optionality::mandatory },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher section_matcher { context.get_transient_memory() };
-    Parameter section_param { u8"section"sv, Optionality::mandatory, section_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &section_param, &content_param };
+    Value_Matcher* const matchers[] { &section_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -330,13 +341,17 @@ There_Behavior::splice(Content_Policy& out, const Invocation& call, Context& con
 Processing_Status
 Here_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"section"sv, Optionality::mandatory },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher section_matcher { context.get_transient_memory() };
-    Parameter section_param { u8"section"sv, Optionality::mandatory, section_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &section_param, &content_param };
+    Value_Matcher* const matchers[] { &section_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -345,7 +360,7 @@ Here_Behavior::splice(Content_Policy& out, const Invocation& call, Context& cont
     ensure_paragraph_matches_display(out, m_display);
 
     const auto action = [&](std::u8string_view section) -> Processing_Status {
-        reference_section(out, section);
+        out.write_section_reference(context.get_sections().intern(section));
         return Processing_Status::ok;
     };
     return with_section_name(
@@ -358,7 +373,7 @@ Make_Section_Behavior::splice(Content_Policy& out, const Invocation&, Context& c
 {
     ensure_paragraph_matches_display(out, m_display);
 
-    context.get_sections().make(m_section_name);
+    const Section_Id section = context.get_sections().make(m_section_name);
 
     // TODO: warn about ignored arguments and block
     HTML_Writer_Buffer buffer { out, Output_Language::html };
@@ -367,7 +382,7 @@ Make_Section_Behavior::splice(Content_Policy& out, const Invocation&, Context& c
         .open_tag_with_attributes(html_tag::div) //
         .write_class(m_class_name)
         .end();
-    reference_section(buffer, m_section_name);
+    buffer.write_section_reference(section);
     writer.close_tag(html_tag::div);
     return Processing_Status::ok;
 }
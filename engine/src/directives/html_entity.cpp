@@ -94,11 +94,15 @@ get_code_points(const std::u8string_view text, const Invocation& call, Context&
 Result<Short_String_Value, Processing_Status>
 Char_By_Entity_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name", Optionality::mandatory, name_matcher };
-    Parameter* const parameters[] { &name_param };
+    Value_Matcher* const matchers[] { &name_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -2,6 +2,7 @@
 #include <string_view>
 
 #include "cowel/parameters.hpp"
+#include "cowel/util/char_sequence_factory.hpp"
 #include "cowel/util/strings.hpp"
 
 #include "cowel/builtin_directive_set.hpp"
@@ -16,13 +17,17 @@ namespace cowel {
 Processing_Status
 Invoke_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name", Optionality::mandatory },
+        { u8"content"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher directive_name_string { context.get_transient_memory() };
-    Parameter string_param { u8"name", Optionality::mandatory, directive_name_string };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::optional, content_matcher };
-    Parameter* const parameters[] { &string_param, &content_param };
+    Value_Matcher* const matchers[] { &directive_name_string, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
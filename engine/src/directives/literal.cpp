@@ -25,13 +25,17 @@ namespace cowel {
 Processing_Status
 HTML_Raw_Text_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Group_Pack_Named_Str_Matcher attr_matcher {};
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <cstddef>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <typeinfo>
 #include <vector>
 
 #include "cowel/parameters.hpp"
@@ -13,14 +15,18 @@
 #include "cowel/util/to_chars.hpp"
 
 #include "cowel/policy/content_policy.hpp"
+#include "cowel/policy/html.hpp"
+#include "cowel/policy/paragraph_split.hpp"
 
 #include "cowel/builtin_directive_set.hpp"
 #include "cowel/content_status.hpp"
 #include "cowel/context.hpp"
 #include "cowel/diagnostic.hpp"
 #include "cowel/directive_processing.hpp"
+#include "cowel/document_sections.hpp"
 #include "cowel/fwd.hpp"
 #include "cowel/invocation.hpp"
+#include "cowel/output_language.hpp"
 
 #include "cowel/syntax/ast.hpp"
 
@@ -120,17 +126,103 @@ struct Put_Positional {
     }
 };
 
+[[nodiscard]]
+bool is_inert(const ast::Primary& primary);
+
+/// @brief Returns `true` iff `content` contains no directives or expressions,
+/// meaning that it always produces the same output, regardless of where it is used.
+[[nodiscard]]
+bool is_inert(std::span<const ast::Markup_Element> content)
+{
+    return std::ranges::all_of(content, [](const ast::Markup_Element& element) {
+        const auto* const primary = element.try_as_primary();
+        return primary && is_inert(*primary);
+    });
+}
+
+/// @brief Returns `true` iff `member` is a positional or named argument
+/// whose name and value are inert.
+[[nodiscard]]
+bool is_inert(const ast::Group_Member& member)
+{
+    switch (member.get_kind()) {
+    case ast::Member_Kind::ellipsis: {
+        return false;
+    }
+    case ast::Member_Kind::named: {
+        if (!is_inert(member.get_name())) {
+            return false;
+        }
+        break;
+    }
+    case ast::Member_Kind::positional: {
+        break;
+    }
+    }
+    const auto* const value = member.get_value().try_as_primary();
+    return value && is_inert(*value);
+}
+
+/// @brief Returns `true` iff `primary` evaluates to the same value no matter where it is used.
+/// That is, it neither contains directives or expressions, nor does it refer to variables.
+bool is_inert(const ast::Primary& primary)
+{
+    switch (primary.get_kind()) {
+    case ast::Primary_Kind::unit_literal:
+    case ast::Primary_Kind::null_literal:
+    case ast::Primary_Kind::bool_literal:
+    case ast::Primary_Kind::int_literal:
+    case ast::Primary_Kind::decimal_float_literal:
+    case ast::Primary_Kind::infinity:
+    case ast::Primary_Kind::unquoted_member_name:
+    case ast::Primary_Kind::text:
+    case ast::Primary_Kind::escape:
+    case ast::Primary_Kind::comment:
+    case ast::Primary_Kind::empty_splice: {
+        return true;
+    }
+    case ast::Primary_Kind::id_expression: {
+        return false;
+    }
+    case ast::Primary_Kind::quoted_string:
+    case ast::Primary_Kind::block: {
+        return is_inert(primary.get_elements());
+    }
+    case ast::Primary_Kind::group: {
+        return std::ranges::all_of(primary.get_members(), [](const ast::Group_Member& member) {
+            return is_inert(member);
+        });
+    }
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Invalid primary kind.");
+}
+
+/// @brief Appends `str` to `out`, prefixed with its length,
+/// so that concatenations of multiple strings remain unambiguous.
+void append_length_prefixed(std::pmr::u8string& out, std::u8string_view str)
+{
+    out += to_characters8(str.length()).as_string();
+    out += u8':';
+    out += str;
+}
+
 }; // namespace
 
 Processing_Status Macro_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"names"sv, Optionality::optional },
+        { u8"pure"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Of_Type_Matcher names { Type::pack_of(&Type::str) };
-    Parameter names_param { u8"names"sv, Optionality::optional, names };
+    Boolean_Matcher pure_boolean;
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &names_param, &content_param };
+    Value_Matcher* const matchers[] { &names, &pure_boolean, &content_matcher };
 
-    const Processing_Status match_status = match_call_fatal_error(parameters, call, context);
+    const Processing_Status match_status = match_call_fatal_error(schema, matchers, call, context);
     switch (match_status) {
     case Processing_Status::ok: break;
     case Processing_Status::brk:
@@ -200,8 +292,8 @@ Processing_Status Macro_Behavior::do_evaluate(const Invocation& call, Context& c
             return Processing_Status::fatal;
         }
         const bool success = context.emplace_macro(
-            std::pmr::u8string { alias_name, context.get_transient_memory() },
-            call.get_content_span(), call.directive.get_source()
+            alias_name, call.get_content_span(), call.directive.get_source(),
+            pure_boolean.get_or_default(false)
         );
         COWEL_ASSERT(success);
     }
@@ -225,13 +317,17 @@ Put_Behavior::resolve(const Invocation& call, Context& context) const
     static constexpr auto else_type = Type::union_of(else_alternatives);
     static_assert(else_type.is_canonical());
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"else"sv, Optionality::optional },
+        { u8"content"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Lazy_Value_Of_Type_Matcher else_matcher { else_type };
-    Parameter else_param { u8"else"sv, Optionality::optional, else_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::optional, content_matcher };
-    Parameter* const parameters[] { &else_param, &content_param };
+    Value_Matcher* const matchers[] { &else_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -379,7 +475,91 @@ Processing_Status
 Macro_Definition::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
     try_inherit_paragraph(out);
+    if (m_pure) {
+        return splice_memoized(out, call, context);
+    }
     return splice_all(out, m_body, call.call_frame, context);
 }
 
+Processing_Status Macro_Definition::splice_memoized(
+    Content_Policy& out,
+    const Invocation& call,
+    Context& context
+) const
+{
+    // Expansions are recorded as HTML, so they can only be replayed into HTML policies
+    // which would have processed the body in the same way as the recording policy does.
+    // Paragraph splitting is stateful, but that state is part of the key,
+    // and restored after replaying.
+    auto* const paragraph_policy = dynamic_cast<Paragraph_Split_Policy*>(&out);
+    const bool is_memoizable_policy = paragraph_policy ? paragraph_policy->is_splitting()
+                                                       : typeid(out) == typeid(HTML_Content_Policy);
+    // Inert arguments evaluate to the same value wherever they appear,
+    // so their source text identifies their value.
+    // Any other arguments could evaluate differently on each invocation.
+    const bool has_inert_arguments = std::ranges::all_of(
+        call.get_arguments_span(), [](const ast::Group_Member& arg) { return is_inert(arg); }
+    );
+    if (!is_memoizable_policy || out.has_flags(Text_Sink_Flags::discard_html)
+        || !has_inert_arguments || !is_inert(call.get_content_span())) {
+        return splice_all(out, m_body, call.call_frame, context);
+    }
+
+    const Paragraph_Split_State state_before
+        = paragraph_policy ? paragraph_policy->get_split_state() : Paragraph_Split_State {};
+    std::pmr::u8string key { context.get_transient_memory() };
+    key += paragraph_policy ? u8'p' : u8'h';
+    key += state_before.paragraphs == Paragraphs_State::inside ? u8'i' : u8'o';
+    key += state_before.line == Blank_Line_Initial_State::normal ? u8'n' : u8'm';
+    // Diagnostics below the minimum level are not emitted,
+    // so an expansion recorded at one level cannot be replayed at a lower one.
+    key += char8_t(context.get_min_diagnostic_level());
+    append_length_prefixed(key, call.arguments ? call.arguments->get_source() : u8""sv);
+    append_length_prefixed(key, call.content ? call.content->get_source() : u8""sv);
+
+    if (const auto it = m_expansions.find(key); it != m_expansions.end()) {
+        const Macro_Expansion& expansion = it->second;
+        expansion.html.write_to(out);
+        if (paragraph_policy) {
+            paragraph_policy->set_split_state(expansion.split_state);
+        }
+        return Processing_Status::ok;
+    }
+    if (m_expansions.size() >= max_memoized_expansions) {
+        return splice_all(out, m_body, call.call_frame, context);
+    }
+
+    std::pmr::memory_resource* const memory = m_expansions.get_allocator().resource();
+    Captured_HTML html { memory };
+    Capturing_HTML_Sink html_sink { html };
+    Paragraph_Split_State state_after = state_before;
+    const std::size_t diagnostics_before = context.get_emitted_diagnostic_count();
+    Processing_Status status;
+    if (paragraph_policy) {
+        Paragraph_Split_Policy recording_policy { html_sink, context.get_transient_memory() };
+        recording_policy.set_split_state(state_before);
+        status = splice_all(recording_policy, m_body, call.call_frame, context);
+        state_after = recording_policy.get_split_state();
+    }
+    else {
+        HTML_Content_Policy recording_policy { html_sink };
+        status = splice_all(recording_policy, m_body, call.call_frame, context);
+    }
+    html.write_to(out);
+    if (paragraph_policy) {
+        paragraph_policy->set_split_state(state_after);
+    }
+
+    // Expansions which failed or emitted diagnostics (such as warnings) are not memoized
+    // because replaying them would not emit those diagnostics again.
+    if (status == Processing_Status::ok
+        && context.get_emitted_diagnostic_count() == diagnostics_before) {
+        m_expansions.try_emplace(
+            std::pmr::u8string { key, memory },
+            Macro_Expansion { .html = std::move(html), .split_state = state_after }
+        );
+    }
+    return status;
+}
+
 } // namespace cowel
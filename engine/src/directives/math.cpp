@@ -7,6 +7,7 @@
 #include "cowel/parameters.hpp"
 #include "cowel/util/chars.hpp"
 #include "cowel/util/html_writer.hpp"
+#include "cowel/util/perfect_hash.hpp"
 
 #include "cowel/policy/content_policy.hpp"
 #include "cowel/policy/factory.hpp"
@@ -71,6 +72,8 @@ constexpr std::u8string_view mathml_names[] = { //
 
 static_assert(std::ranges::is_sorted(mathml_names));
 
+constexpr Perfect_Hash_Table mathml_names_table { mathml_names };
+
 constexpr auto mathml_permits_text_bits = [] { //
     char init[] { 0, COWEL_MATHML_ELEMENT_DATA(COWEL_MATHML_ELEMENT_PERMITS_TEXT) };
     std::ranges::reverse(init);
@@ -81,11 +84,8 @@ constexpr auto mathml_permits_text_bits = [] { //
 
 constexpr std::ptrdiff_t mathml_element_index(std::u8string_view name)
 {
-    const auto* const pos = std::ranges::lower_bound(mathml_names, name);
-    if (pos == std::end(mathml_names) || *pos != name) {
-        return -1;
-    }
-    return pos - mathml_names;
+    const auto* const pos = mathml_names_table.find(name);
+    return pos ? pos - mathml_names : -1;
 }
 
 static_assert(mathml_permits_text_bits[mathml_element_index(u8"mi")]);
@@ -146,11 +146,15 @@ public:
             return HTML_Content_Policy::consume(d, content_frame, context);
         }
 
+        static constexpr Parameter_Declaration parameters[] {
+            { u8"attr"sv, Optionality::optional },
+            { u8"content"sv, Optionality::mandatory },
+        };
+        static constexpr Parameter_Schema schema { parameters };
+
         Pack_Named_Of_Type_Matcher attr_matcher { pack_named_bool_or_str };
-        Parameter args_param { u8"attr"sv, Optionality::optional, attr_matcher };
         Block_Matcher content_matcher;
-        Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-        Parameter* const parameters[] { &args_param, &content_param };
+        Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
         Invocation call {
             .name = name_string,
@@ -160,7 +164,7 @@ public:
             .content_frame = content_frame,
             .call_frame = content_frame,
         };
-        const auto match_status = match_call(parameters, call, context);
+        const auto match_status = match_call(schema, matchers, call, context);
         if (match_status != Processing_Status::ok) {
             return match_status;
         }
@@ -196,13 +200,17 @@ Math_Behavior::splice(Content_Policy& out, const Invocation& call, Context& cont
     const auto display_string
         = m_display == Directive_Display::in_line ? u8"inline"sv : u8"block"sv;
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Named_Of_Type_Matcher attr_matcher { pack_named_bool_or_str };
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -18,7 +18,7 @@ Processing_Status control_paragraph(
     Context& context
 )
 {
-    const auto match_status = match_call({}, call, context);
+    const auto match_status = match_call({}, {}, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
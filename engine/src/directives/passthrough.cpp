@@ -53,13 +53,17 @@ Error_Behavior::splice(Content_Policy& out, const Invocation& call, Context&) co
 Processing_Status
 Passthrough_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Named_Str_Matcher attr_matcher;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::optional, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context, make_fail_callback());
+    const auto match_status = match_call(schema, matchers, call, context, make_fail_callback());
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -89,19 +93,24 @@ Passthrough_Behavior::splice(Content_Policy& out, const Invocation& call, Contex
 Processing_Status
 HTML_Element_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_matcher };
     Group_Pack_Named_Str_Matcher attr_matcher;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::optional, content_matcher };
 
-    Parameter* const parameters[] { &name_param, &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &name_matcher, &attr_matcher, &content_matcher };
     const std::size_t parameter_count
         = m_self_closing == HTML_Element_Self_Closing::self_closing ? 2 : 3;
-    const auto actual_parameters = std::span { parameters }.subspan(0, parameter_count);
-
-    const auto match_status = match_call(actual_parameters, call, context);
+    const auto match_status = match_call(
+        Parameter_Schema_View(schema).first(parameter_count),
+        std::span { matchers }.first(parameter_count), call, context
+    );
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -150,13 +159,17 @@ HTML_Element_Behavior::splice(Content_Policy& out, const Invocation& call, Conte
 Processing_Status
 In_Tag_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Named_Str_Matcher attr_matcher;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -185,13 +198,17 @@ In_Tag_Behavior::splice(Content_Policy& out, const Invocation& call, Context& co
 Processing_Status
 Special_Block_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Named_Str_Matcher attr_matcher;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -234,13 +251,17 @@ Special_Block_Behavior::splice(Content_Policy& out, const Invocation& call, Cont
 Processing_Status
 URL_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Named_Str_Matcher attr_matcher;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -278,13 +299,17 @@ URL_Behavior::splice(Content_Policy& out, const Invocation& call, Context& conte
 Processing_Status
 Self_Closing_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"attr"sv, Optionality::optional },
+        { u8"content"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Named_Str_Matcher attr_matcher;
-    Parameter attr_param { u8"attr"sv, Optionality::optional, attr_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::optional, content_matcher };
-    Parameter* const parameters[] { &attr_param, &content_param };
+    Value_Matcher* const matchers[] { &attr_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -307,13 +332,17 @@ Processing_Status Internal_Expect_Diagnostic_Behavior::splice(
     Context& context
 ) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"id"sv, Optionality::mandatory },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher id_matcher { context.get_transient_memory() };
-    Parameter id_param { u8"id"sv, Optionality::mandatory, id_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &id_param, &content_param };
+    Value_Matcher* const matchers[] { &id_matcher, &content_matcher };
 
-    if (const auto match_status = match_call_fatal_error(parameters, call, context);
+    if (const auto match_status = match_call_fatal_error(schema, matchers, call, context);
         match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -396,11 +425,15 @@ Processing_Status Internal_Expect_Diagnostic_Behavior::splice(
 Result<Short_String_Value, Processing_Status>
 Internal_Typeof_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"expr"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Value_Of_Type_Matcher expr_matcher { Type::any };
-    Parameter expr_param { u8"expr"sv, Optionality::mandatory, expr_matcher };
-    Parameter* const parameters[] { &expr_param };
+    Value_Matcher* const matchers[] { &expr_matcher };
 
-    if (const auto match_status = match_call_fatal_error(parameters, call, context);
+    if (const auto match_status = match_call_fatal_error(schema, matchers, call, context);
         match_status != Processing_Status::ok) {
         return match_status;
     }
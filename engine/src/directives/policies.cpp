@@ -27,11 +27,15 @@ template <typename T>
 [[nodiscard]]
 Processing_Status consume_simply(Content_Policy& out, const Invocation& call, Context& context)
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &content_param };
+    Value_Matcher* const matchers[] { &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -57,11 +61,15 @@ Processing_Status consume_simply(Content_Policy& out, const Invocation& call, Co
 [[nodiscard]]
 Processing_Status consume_current(Content_Policy& out, const Invocation& call, Context& context)
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &content_param };
+    Value_Matcher* const matchers[] { &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -115,11 +123,15 @@ Processing_Status Internal_Arg_Source_As_Text_Behavior::splice(
     Context& context
 ) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"value"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Value_Of_Type_Matcher value_matcher { Type::block };
-    Parameter value_param { u8"value"sv, Optionality::mandatory, value_matcher };
-    Parameter* const parameters[] { &value_param };
+    Value_Matcher* const matchers[] { &value_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
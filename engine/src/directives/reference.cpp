@@ -112,18 +112,32 @@ Reference_Classification classify_reference(std::u8string_view ref)
     return {};
 }
 
+/// @brief Returns the ID of the section named `parent.name`,
+/// such as `std.bib.N5008` for a bibliography entry.
+[[nodiscard]]
+Section_Id
+intern_nested_section(std::u8string_view parent, std::u8string_view name, Context& context)
+{
+    const std::u8string_view parts[] { parent, u8"."sv, name };
+    return context.get_sections().intern(parts);
+}
+
 } // namespace
 
 Processing_Status
 Ref_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"to"sv, Optionality::mandatory },
+        { u8"content"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher to_matcher { context.get_transient_memory() };
-    Parameter to_param { u8"to"sv, Optionality::mandatory, to_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::optional, content_matcher };
-    Parameter* const parameters[] { &to_param, &content_param };
+    Value_Matcher* const matchers[] { &to_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -145,12 +159,9 @@ Ref_Behavior::splice(Content_Policy& out, const Invocation& call, Context& conte
 
     const Reference_Classification classification = classify_reference(target_string);
     if (classification.type == Reference_Type::unknown) {
-        const std::u8string_view section_name_parts[] {
-            section_name::bibliography,
-            u8".",
-            target_string,
-        };
-        reference_section(buffer, joined_char_sequence(section_name_parts));
+        buffer.write_section_reference(
+            intern_nested_section(section_name::bibliography, target_string, context)
+        );
         if (!content_matcher.was_matched()) {
             writer.write_inner_html(u8'[');
             writer.write_inner_text(target_string);
@@ -168,12 +179,9 @@ Ref_Behavior::splice(Content_Policy& out, const Invocation& call, Context& conte
             .end();
         auto status = Processing_Status::ok;
         if (!content_matcher.was_matched()) {
-            const std::u8string_view section_name_parts[] {
-                section_name::id_preview,
-                u8".",
-                target_string.substr(1),
-            };
-            reference_section(buffer, joined_char_sequence(section_name_parts));
+            buffer.write_section_reference(
+                intern_nested_section(section_name::id_preview, target_string.substr(1), context)
+            );
         }
         else {
             buffer.flush();
@@ -5,6 +5,7 @@
 
 #include "cowel/util/case_transform.hpp"
 #include "cowel/util/char_sequence.hpp"
+#include "cowel/util/char_sequence_factory.hpp"
 #include "cowel/util/char_sequence_ops.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
@@ -216,11 +217,15 @@ std::size_t replace_all(
 Result<Big_Int, Processing_Status>
 Str_Length_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher x_matcher { context.get_transient_memory() };
-    Parameter x_param { u8"x", Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_param };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -260,11 +265,15 @@ Processing_Status Str_Transform_Behavior::do_evaluate(
     Context& context
 ) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher x_matcher { context.get_transient_memory() };
-    Parameter x_param { u8"x", Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_param };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -308,13 +317,17 @@ Processing_Status Str_Transform_Behavior::do_evaluate(
 Result<bool, Processing_Status>
 Str_Match_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"text", Optionality::mandatory },
+        { u8"regex", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher text_matcher { context.get_transient_memory() };
-    Parameter text_param { u8"text", Optionality::mandatory, text_matcher };
     Value_Of_Type_Matcher regex_matcher { Type::regex };
-    Parameter regex_param { u8"regex", Optionality::mandatory, regex_matcher };
-    Parameter* const parameters[] { &text_param, &regex_param };
+    Value_Matcher* const matchers[] { &text_matcher, &regex_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -345,13 +358,17 @@ Str_Contains_Behavior::do_evaluate(const Invocation& call, Context& context) con
     static constexpr auto needle_type = Type::union_of(needle_alternatives);
     static_assert(needle_type.is_canonical());
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"text", Optionality::mandatory },
+        { u8"needle", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher text_matcher { context.get_transient_memory() };
-    Parameter text_param { u8"text", Optionality::mandatory, text_matcher };
     Value_Of_Type_Matcher needle_matcher { needle_type };
-    Parameter needle_param { u8"needle", Optionality::mandatory, needle_matcher };
-    Parameter* const parameters[] { &text_param, &needle_param };
+    Value_Matcher* const matchers[] { &text_matcher, &needle_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -388,13 +405,17 @@ Str_Find_Behavior::evaluate(const Invocation& call, Context& context) const
     static constexpr auto needle_type = Type::union_of(needle_alternatives);
     static_assert(needle_type.is_canonical());
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"text", Optionality::mandatory },
+        { u8"needle", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher text_matcher { context.get_transient_memory() };
-    Parameter text_param { u8"text", Optionality::mandatory, text_matcher };
     Value_Of_Type_Matcher needle_matcher { needle_type };
-    Parameter needle_param { u8"needle", Optionality::mandatory, needle_matcher };
-    Parameter* const parameters[] { &text_param, &needle_param };
+    Value_Matcher* const matchers[] { &text_matcher, &needle_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -443,13 +464,17 @@ Str_Find_Behavior::evaluate(const Invocation& call, Context& context) const
 Result<Short_String_Value, Processing_Status>
 Str_At_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"text", Optionality::mandatory },
+        { u8"index", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher text_matcher { context.get_transient_memory() };
-    Parameter text_param { u8"text", Optionality::mandatory, text_matcher };
     Integer_Matcher index_matcher;
-    Parameter index_param { u8"index", Optionality::mandatory, index_matcher };
-    Parameter* const parameters[] { &text_param, &index_param };
+    Value_Matcher* const matchers[] { &text_matcher, &index_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -525,15 +550,19 @@ Str_Substr_Behavior::evaluate(const Invocation& call, Context& context) const
     static constexpr Type length_type = Type::union_of(length_alternatives);
     static_assert(length_type.is_canonical());
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"text", Optionality::mandatory },
+        { u8"start", Optionality::mandatory },
+        { u8"length", Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher text_matcher { context.get_transient_memory() };
-    Parameter text_param { u8"text", Optionality::mandatory, text_matcher };
     Integer_Matcher start_matcher;
-    Parameter start_param { u8"start", Optionality::mandatory, start_matcher };
     Value_Of_Type_Matcher length_matcher { length_type };
-    Parameter length_param { u8"length", Optionality::optional, length_matcher };
-    Parameter* const parameters[] { &text_param, &start_param, &length_param };
+    Value_Matcher* const matchers[] { &text_matcher, &start_matcher, &length_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -658,15 +687,19 @@ Str_Replace_Behavior::evaluate(const Invocation& call, Context& context) const
     static constexpr auto needle_type = Type::union_of(needle_alternatives);
     static_assert(needle_type.is_canonical());
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"text", Optionality::mandatory },
+        { u8"needle", Optionality::mandatory },
+        { u8"with", Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher text_matcher { context.get_transient_memory() };
-    Parameter text_param { u8"text", Optionality::mandatory, text_matcher };
     Value_Of_Type_Matcher needle_matcher { needle_type };
-    Parameter needle_param { u8"needle", Optionality::mandatory, needle_matcher };
     String_Matcher with_matcher { context.get_transient_memory() };
-    Parameter with_param { u8"with", Optionality::mandatory, with_matcher };
-    Parameter* const parameters[] { &text_param, &needle_param, &with_param };
+    Value_Matcher* const matchers[] { &text_matcher, &needle_matcher, &with_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -739,13 +772,17 @@ Str_Replace_Behavior::evaluate(const Invocation& call, Context& context) const
 Result<Value, Processing_Status>
 Regex_Make_Behavior::evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"pattern", Optionality::mandatory },
+        { u8"flags", Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher pattern_matcher { context.get_transient_memory() };
-    Parameter pattern_param { u8"pattern", Optionality::mandatory, pattern_matcher };
     String_Matcher flags_matcher { context.get_transient_memory() };
-    Parameter flags_param { u8"flags", Optionality::optional, flags_matcher };
-    Parameter* const parameters[] { &pattern_param, &flags_param };
+    Value_Matcher* const matchers[] { &pattern_matcher, &flags_matcher };
 
-    const auto args_status = match_call(parameters, call, context);
+    const auto args_status = match_call(schema, matchers, call, context);
     if (args_status != Processing_Status::ok) {
         return args_status;
     }
@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <optional>
 #include <string_view>
 
@@ -9,7 +10,6 @@
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
 
-#include "cowel/policy/capture.hpp"
 #include "cowel/policy/content_policy.hpp"
 #include "cowel/policy/factory.hpp"
 #include "cowel/policy/html.hpp"
@@ -21,6 +21,7 @@
 #include "cowel/diagnostic.hpp"
 #include "cowel/directive_display.hpp"
 #include "cowel/directive_processing.hpp"
+#include "cowel/document_sections.hpp"
 #include "cowel/invocation.hpp"
 #include "cowel/output_language.hpp"
 #include "cowel/theme_to_css.hpp"
@@ -36,22 +37,26 @@ namespace cowel {
 Processing_Status
 Code_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"lang"sv, Optionality::mandatory },
+        { u8"nested"sv, Optionality::optional },
+        { u8"borders"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher lang_string_matcher { context.get_transient_memory() };
-    Parameter lang_param { u8"lang"sv, Optionality::mandatory, lang_string_matcher };
     Boolean_Matcher nested_boolean;
-    Parameter nested_param { u8"nested"sv, Optionality::optional, nested_boolean };
     Boolean_Matcher borders_boolean;
-    Parameter borders_param { u8"borders"sv, Optionality::optional, borders_boolean };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] {
-        &lang_param,
-        &nested_param,
-        &borders_param,
-        &content_param,
+    Value_Matcher* const matchers[] {
+        &lang_string_matcher,
+        &nested_boolean,
+        &borders_boolean,
+        &content_matcher,
     };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -102,23 +107,26 @@ Code_Behavior::splice(Content_Policy& out, const Invocation& call, Context& cont
             buffer.flush();
             return highlight_policy.dump_html_to(out, context, lang_string);
         }
-        Vector_Text_Sink vector_sink { Output_Language::html, context.get_transient_memory() };
+        Captured_HTML inner_html { context.get_transient_memory() };
+        Capturing_HTML_Sink inner_html_sink { inner_html };
         const Result<void, Syntax_Highlight_Error> result
-            = highlight_policy.dump_html_to(vector_sink, context, lang_string);
+            = highlight_policy.dump_html_to(inner_html_sink, context, lang_string);
 
         // https://html.spec.whatwg.org/dev/grouping-content.html#the-pre-element
         // Leading newlines immediately following <pre> are stripped anyway.
         // The same applies to any elements styled "white-space: pre".
         // In general, it is best to remove these.
         // To ensure portability, we need to trim away newlines (if any).
-        auto inner_html = as_u8string_view(*vector_sink);
-        while (inner_html.starts_with(u8'\n')) {
-            inner_html.remove_prefix(1);
+        const std::u8string_view inner_text = inner_html.str();
+        std::size_t begin = 0;
+        std::size_t end = inner_text.length();
+        while (begin != end && inner_text[begin] == u8'\n') {
+            ++begin;
         }
-        while (inner_html.ends_with(u8'\n')) {
-            inner_html.remove_suffix(1);
+        while (end != begin && inner_text[end - 1] == u8'\n') {
+            --end;
         }
-        buffer.write(inner_html, Output_Language::html);
+        inner_html.write_to(buffer, begin, end);
         return result;
     }();
     if (!result) {
@@ -137,15 +145,19 @@ Code_Behavior::splice(Content_Policy& out, const Invocation& call, Context& cont
 Processing_Status
 Highlight_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"lang"sv, Optionality::mandatory },
+        { u8"opaque"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher lang_string { context.get_transient_memory() };
-    Parameter lang_param { u8"lang"sv, Optionality::mandatory, lang_string };
     Boolean_Matcher opaque_matcher;
-    Parameter opaque_param { u8"opaque"sv, Optionality::optional, opaque_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &lang_param, &opaque_param, &content_param };
+    Value_Matcher* const matchers[] { &lang_string, &opaque_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
@@ -169,15 +181,19 @@ Highlight_Behavior::splice(Content_Policy& out, const Invocation& call, Context&
 Processing_Status
 Highlight_As_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+        { u8"opaque"sv, Optionality::optional },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Spliceable_To_String_Matcher name_string { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_string };
     Boolean_Matcher opaque_matcher;
-    Parameter opaque_param { u8"opaque"sv, Optionality::optional, opaque_matcher };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &name_param, &opaque_param, &content_param };
+    Value_Matcher* const matchers[] { &name_string, &opaque_matcher, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return status_is_error(match_status) ? try_generate_error(out, call, context, match_status)
                                              : match_status;
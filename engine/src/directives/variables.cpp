@@ -1,5 +1,6 @@
 #include <cmath>
 #include <limits>
+#include <optional>
 #include <ranges>
 #include <string>
 #include <string_view>
@@ -8,9 +9,11 @@
 
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
+#include "cowel/util/char_sequence_factory.hpp"
 #include "cowel/util/math.hpp"
 #include "cowel/util/result.hpp"
 
+#include "cowel/policy/capture.hpp"
 #include "cowel/policy/plaintext.hpp"
 
 #include "cowel/big_int.hpp"
@@ -22,6 +25,7 @@
 #include "cowel/invocation.hpp"
 #include "cowel/output_language.hpp"
 #include "cowel/parameters.hpp"
+#include "cowel/symbol.hpp"
 #include "cowel/type.hpp"
 
 namespace cowel {
@@ -141,11 +145,15 @@ static_assert(variable_type.is_canonical());
 Result<bool, Processing_Status>
 Logical_Not_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Boolean_Matcher x_matcher;
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_param };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -210,11 +218,15 @@ struct Logical_Expression_Evaluator {
 Result<bool, Processing_Status>
 Logical_Expression_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"args"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Lazy_Any_Matcher args_matcher;
-    Parameter args_param { u8"args"sv, Optionality::mandatory, args_matcher };
-    Parameter* const parameters[] { &args_param };
+    Value_Matcher* const matchers[] { &args_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -239,13 +251,17 @@ Comparison_Expression_Behavior::do_evaluate(const Invocation& call, Context& con
         ? equality_comparable
         : relation_comparable;
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+        { u8"y"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Value_Of_Type_Matcher x_value { parameter_type };
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_value };
     Value_Of_Type_Matcher y_value { parameter_type };
-    Parameter y_param { u8"y"sv, Optionality::mandatory, y_value };
-    Parameter* const parameters[] { &x_param, &y_param };
+    Value_Matcher* const matchers[] { &x_value, &y_value };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -273,13 +289,17 @@ Internal_Eq_Behavior::do_evaluate(const Invocation& call, Context& context) cons
     static constexpr auto equality_comparable = Type::union_of(equality_comparable_types);
     static_assert(equality_comparable.is_canonical());
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+        { u8"y"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Value_Of_Type_Matcher x_value { equality_comparable };
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_value };
     Value_Of_Type_Matcher y_value { equality_comparable };
-    Parameter y_param { u8"y"sv, Optionality::mandatory, y_value };
-    Parameter* const parameters[] { &x_param, &y_param };
+    Value_Matcher* const matchers[] { &x_value, &y_value };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -329,11 +349,15 @@ Internal_Eq_Behavior::do_evaluate(const Invocation& call, Context& context) cons
 Result<Value, Processing_Status>
 Unary_Numeric_Expression_Behavior::evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Value_Of_Type_Matcher x_matcher { *m_type };
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_param };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -354,13 +378,17 @@ Unary_Numeric_Expression_Behavior::evaluate(const Invocation& call, Context& con
 Result<Big_Int, Processing_Status>
 Integer_Division_Expression_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+        { u8"y"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Integer_Matcher x_matcher;
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_matcher };
     Integer_Matcher y_matcher;
-    Parameter y_param { u8"y"sv, Optionality::mandatory, y_matcher };
-    Parameter* const parameters[] { &x_param, &y_param };
+    Value_Matcher* const matchers[] { &x_matcher, &y_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -380,11 +408,15 @@ Integer_Division_Expression_Behavior::do_evaluate(const Invocation& call, Contex
 Result<Value, Processing_Status>
 N_Ary_Numeric_Expression_Behavior::evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"args"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Pack_Of_Type_Matcher args_matcher { Type::pack_of(&Type::any) };
-    Parameter args_param { u8"args"sv, Optionality::mandatory, args_matcher };
-    Parameter* const parameters[] { &args_param };
+    Value_Matcher* const matchers[] { &args_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -501,22 +533,21 @@ To_Str_Behavior::evaluate(const Invocation& call, Context& context) const
         u8"splice"sv,
     };
 
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+        { u8"base"sv, Optionality::optional },
+        { u8"zpad"sv, Optionality::optional },
+        { u8"format"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Value_Of_Type_Matcher x_matcher { to_str_type };
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_matcher };
     Integer_Matcher base_matcher;
-    Parameter base_param { u8"base"sv, Optionality::optional, base_matcher };
     Integer_Matcher zpad_matcher;
-    Parameter zpad_param { u8"zpad"sv, Optionality::optional, zpad_matcher };
     Sorted_Options_Matcher format_matcher { format_options };
-    Parameter format_param { u8"format"sv, Optionality::optional, format_matcher };
-    Parameter* const parameters[] {
-        &x_param,
-        &base_param,
-        &zpad_param,
-        &format_param,
-    };
+    Value_Matcher* const matchers[] { &x_matcher, &base_matcher, &zpad_matcher, &format_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -681,11 +712,15 @@ To_Str_Behavior::evaluate(const Invocation& call, Context& context) const
 Result<Float, Processing_Status>
 Reinterpret_As_Float_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Integer_Matcher x_matcher {};
-    Parameter to_param { u8"x"sv, Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &to_param };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -732,11 +767,15 @@ Reinterpret_As_Float_Behavior::do_evaluate(const Invocation& call, Context& cont
 Result<Big_Int, Processing_Status>
 Reinterpret_As_Int_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"x"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Float_Matcher x_matcher {};
-    Parameter x_param { u8"x"sv, Optionality::mandatory, x_matcher };
-    Parameter* const parameters[] { &x_param };
+    Value_Matcher* const matchers[] { &x_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
@@ -748,19 +787,21 @@ Reinterpret_As_Int_Behavior::do_evaluate(const Invocation& call, Context& contex
 
 Processing_Status Var_Delete_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_matcher };
-    Parameter* const parameters[] { &name_param };
+    Value_Matcher* const matchers[] { &name_matcher };
 
-    const auto status = match_call(parameters, call, context);
+    const auto status = match_call(schema, matchers, call, context);
     if (status != Processing_Status::ok) {
         return status;
     }
 
-    // This could be made more efficient using C++23 transparent erase,
-    // once available.
-    const auto it = context.get_variables().find(name_matcher.get());
-    if (it == context.get_variables().end()) {
+    const std::optional<Symbol> symbol = context.get_symbols().find(name_matcher.get());
+    if (!symbol || !context.get_variables().contains(*symbol)) {
         context.try_error(
             diagnostic::var_delete, name_matcher.get_location(),
             joined_char_sequence(
@@ -773,39 +814,47 @@ Processing_Status Var_Delete_Behavior::do_evaluate(const Invocation& call, Conte
         );
         return Processing_Status::error;
     }
-    context.get_variables().erase(it);
+    context.get_variables().erase(*symbol);
     return Processing_Status::ok;
 }
 
 Result<bool, Processing_Status>
 Var_Exists_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_matcher };
-    Parameter* const parameters[] { &name_param };
+    Value_Matcher* const matchers[] { &name_matcher };
 
-    const auto status = match_call(parameters, call, context);
+    const auto status = match_call(schema, matchers, call, context);
     if (status != Processing_Status::ok) {
         return status;
     }
 
-    return context.get_variables().contains(name_matcher.get());
+    return context.get_variable(name_matcher.get()) != nullptr;
 }
 
 Result<Value, Processing_Status>
 Var_Get_Behavior::evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_matcher };
-    Parameter* const parameters[] { &name_param };
+    Value_Matcher* const matchers[] { &name_matcher };
 
-    const auto status = match_call(parameters, call, context);
+    const auto status = match_call(schema, matchers, call, context);
     if (status != Processing_Status::ok) {
         return status;
     }
 
-    const auto it = context.get_variables().find(name_matcher.get());
-    if (it == context.get_variables().end()) {
+    const Value* const value = context.get_variable(name_matcher.get());
+    if (!value) {
         context.try_error(
             diagnostic::var_get, name_matcher.get_location(),
             joined_char_sequence(
@@ -818,25 +867,28 @@ Var_Get_Behavior::evaluate(const Invocation& call, Context& context) const
         );
         return Processing_Status::error;
     }
-    return it->second;
+    return *value;
 }
 
 Processing_Status Var_Let_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+        { u8"value"sv, Optionality::optional },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_matcher };
     Value_Of_Type_Matcher value_matcher { variable_type };
-    Parameter value_param { u8"value"sv, Optionality::optional, value_matcher };
-    Parameter* const parameters[] { &name_param, &value_param };
+    Value_Matcher* const matchers[] { &name_matcher, &value_matcher };
 
-    const auto status = match_call(parameters, call, context);
+    const auto status = match_call(schema, matchers, call, context);
     if (status != Processing_Status::ok) {
         return status;
     }
 
-    std::pmr::u8string name { name_matcher.get(), context.get_transient_memory() };
-    const auto it = context.get_variables().find(name);
-    if (it != context.get_variables().end()) {
+    const Symbol name = context.intern(name_matcher.get());
+    if (context.get_variable(name)) {
         context.try_error(
             diagnostic::var_let, name_matcher.get_location(),
             joined_char_sequence(
@@ -850,8 +902,7 @@ Processing_Status Var_Let_Behavior::do_evaluate(const Invocation& call, Context&
         return Processing_Status::error;
     }
     const auto [_, success] = context.get_variables().emplace(
-        std::move(name),
-        value_matcher.was_matched() ? std::move(value_matcher.get()) : auto(Value::null)
+        name, value_matcher.was_matched() ? std::move(value_matcher.get()) : auto(Value::null)
     );
     COWEL_DEBUG_ASSERT(success);
     return Processing_Status::ok;
@@ -859,19 +910,23 @@ Processing_Status Var_Let_Behavior::do_evaluate(const Invocation& call, Context&
 
 Processing_Status Var_Set_Behavior::do_evaluate(const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"name"sv, Optionality::mandatory },
+        { u8"value"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     String_Matcher name_matcher { context.get_transient_memory() };
-    Parameter name_param { u8"name"sv, Optionality::mandatory, name_matcher };
     Value_Of_Type_Matcher value_matcher { variable_type };
-    Parameter value_param { u8"value"sv, Optionality::mandatory, value_matcher };
-    Parameter* const parameters[] { &name_param, &value_param };
+    Value_Matcher* const matchers[] { &name_matcher, &value_matcher };
 
-    const auto status = match_call(parameters, call, context);
+    const auto status = match_call(schema, matchers, call, context);
     if (status != Processing_Status::ok) {
         return status;
     }
 
-    const auto it = context.get_variables().find(name_matcher.get());
-    if (it == context.get_variables().end()) {
+    Value* const variable = context.get_variable(name_matcher.get());
+    if (!variable) {
         context.try_error(
             diagnostic::var_set, name_matcher.get_location(),
             joined_char_sequence(
@@ -884,7 +939,7 @@ Processing_Status Var_Set_Behavior::do_evaluate(const Invocation& call, Context&
         );
         return Processing_Status::error;
     }
-    it->second = std::move(value_matcher.get());
+    *variable = std::move(value_matcher.get());
     return Processing_Status::ok;
 }
 
@@ -21,13 +21,17 @@ namespace cowel {
 Processing_Status
 WG21_Head_Behavior::splice(Content_Policy& out, const Invocation& call, Context& context) const
 {
+    static constexpr Parameter_Declaration parameters[] {
+        { u8"title"sv, Optionality::mandatory },
+        { u8"content"sv, Optionality::mandatory },
+    };
+    static constexpr Parameter_Schema schema { parameters };
+
     Lazy_Value_Of_Type_Matcher title_markup { Type::block };
-    Parameter title_param { u8"title"sv, Optionality::mandatory, title_markup };
     Block_Matcher content_matcher;
-    Parameter content_param { u8"content"sv, Optionality::mandatory, content_matcher };
-    Parameter* const parameters[] { &title_param, &content_param };
+    Value_Matcher* const matchers[] { &title_markup, &content_matcher };
 
-    const auto match_status = match_call(parameters, call, context);
+    const auto match_status = match_call(schema, matchers, call, context);
     if (match_status != Processing_Status::ok) {
         return match_status;
     }
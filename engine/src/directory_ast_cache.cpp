@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <filesystem>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cowel/util/function_ref.hpp"
+#include "cowel/util/io.hpp"
+#include "cowel/util/meta.hpp"
+#include "cowel/util/result.hpp"
+
+#include "cowel/cowel.h"
+#include "cowel/cowel_lib.hpp"
+#include "cowel/directory_ast_cache.hpp"
+
+#ifdef COWEL_EMSCRIPTEN
+#error "This file not be included in emscripten builds."
+#endif
+
+namespace cowel {
+
+Directory_AST_Cache::Directory_AST_Cache(
+    std::filesystem::path&& directory,
+    std::pmr::memory_resource* const memory
+)
+    : m_directory { std::move(directory) }
+    , m_loaded { memory }
+{
+}
+
+std::filesystem::path Directory_AST_Cache::entry_path(const std::u8string_view key) const
+{
+    std::u8string file_name { key };
+    file_name += u8".ast";
+    return m_directory / file_name;
+}
+
+std::span<const std::byte> Directory_AST_Cache::load(const std::u8string_view key)
+{
+    Result<Mapped_File, IO_Error_Code> result = map_file(entry_path(key).generic_u8string());
+    if (!result || result->bytes().empty()) {
+        return {};
+    }
+    return m_loaded.emplace_back(std::move(*result)).bytes();
+}
+
+void Directory_AST_Cache::store(const std::u8string_view key, const std::span<const std::byte> data)
+{
+    std::error_code error;
+    if (!m_directory_created) {
+        std::filesystem::create_directories(m_directory, error);
+        if (error) {
+            return;
+        }
+        m_directory_created = true;
+    }
+
+    // Writing to a temporary file first and renaming it afterwards
+    // prevents concurrent runs from observing partially written entries.
+    const std::filesystem::path path = entry_path(key);
+    std::filesystem::path temporary_path = path;
+    temporary_path += u8".tmp";
+    if (!bytes_to_file(data.data(), data.size(), temporary_path.generic_u8string())) {
+        std::filesystem::remove(temporary_path, error);
+        return;
+    }
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+[[nodiscard]]
+Function_Ref<cowel_cache_entry(cowel_string_view_u8) noexcept>
+Directory_AST_Cache::as_cowel_load_cache_fn() noexcept
+{
+    using Invoker = decltype(as_cowel_load_cache_fn())::Invoker;
+    static_assert(
+        std::is_same_v<Invoker, cowel_load_cache_fn_u8>,
+        "as_cowel_load_cache_fn must return a Function_Ref "
+        "which is suitable for use as cowel_load_cache_fn_u8."
+    );
+
+    constexpr auto result = [](Directory_AST_Cache* const self,
+                               const cowel_string_view_u8 key) noexcept -> cowel_cache_entry {
+        const std::span<const std::byte> data = self->load(as_u8string_view(key));
+        return { .data = data.empty() ? nullptr : data.data(), .size = data.size() };
+    };
+    return { const_v<result>, this };
+}
+
+[[nodiscard]]
+Function_Ref<void(cowel_string_view_u8, cowel_cache_entry) noexcept>
+Directory_AST_Cache::as_cowel_store_cache_fn() noexcept
+{
+    using Invoker = decltype(as_cowel_store_cache_fn())::Invoker;
+    static_assert(
+        std::is_same_v<Invoker, cowel_store_cache_fn_u8>,
+        "as_cowel_store_cache_fn must return a Function_Ref "
+        "which is suitable for use as cowel_store_cache_fn_u8."
+    );
+
+    constexpr auto result = [](Directory_AST_Cache* const self, const cowel_string_view_u8 key,
+                               const cowel_cache_entry entry) noexcept -> void {
+        const std::span<const std::byte> data { static_cast<const std::byte*>(entry.data),
+                                                entry.size };
+        self->store(as_u8string_view(key), data);
+    };
+    return { const_v<result>, this };
+}
+
+} // namespace cowel
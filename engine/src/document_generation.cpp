@@ -1,18 +1,16 @@
 #include <cstddef>
 #include <memory_resource>
+#include <optional>
 #include <span>
 #include <string_view>
-#include <unordered_set>
 #include <vector>
 
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/char_sequence_factory.hpp"
-#include "cowel/util/chars.hpp"
 #include "cowel/util/function_ref.hpp"
 #include "cowel/util/html_writer.hpp"
 #include "cowel/util/strings.hpp"
-#include "cowel/util/unicode.hpp"
 
 #include "cowel/policy/content_policy.hpp"
 #include "cowel/policy/paragraph_split.hpp"
@@ -26,6 +24,7 @@
 #include "cowel/document_generation.hpp"
 #include "cowel/document_sections.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/output_language.hpp"
 #include "cowel/theme_to_css.hpp"
 
@@ -46,6 +45,13 @@ Processing_Status run_generation(
     // TODO: heading counters should eventually be managed via context variables.
     reset_heading_counters();
 
+    // The heap has to outlive the context, which holds GC_Refs (e.g. in variables).
+    std::optional<GC_Heap> own_gc_heap;
+    if (options.gc_heap == nullptr) {
+        own_gc_heap.emplace(options.memory);
+    }
+    const Scoped_GC_Heap gc_heap_scope { options.gc_heap ? *options.gc_heap : *own_gc_heap };
+
     std::pmr::unsynchronized_pool_resource transient_memory { options.memory };
 
     Context context {
@@ -61,17 +67,24 @@ Processing_Status run_generation(
     if (options.hover_sink != nullptr) {
         context.set_hover_sink(*options.hover_sink);
     }
+    if (options.ast_arena != nullptr) {
+        context.set_ast_arena(*options.ast_arena);
+    }
+    if (options.ast_cache != nullptr) {
+        context.set_ast_cache(*options.ast_cache);
+    }
+    context.set_fold_constants(options.fold_constants);
+    context.set_max_call_depth(options.max_call_depth);
 
     const auto status = generate(context);
 
     if (options.consume_variables) {
-        const auto& variables = context.get_variables();
         std::pmr::vector<std::u8string_view> preserved_values { options.memory };
         preserved_values.reserve(options.preserved_variables.size());
         for (const std::u8string_view name : options.preserved_variables) {
             const File_Source_Span warning_span { {}, File_Id::main };
-            const auto it = variables.find(name);
-            if (it == variables.end()) {
+            const Value* const val = context.get_variable(name);
+            if (!val) {
                 context.try_warning(
                     diagnostic::preserved_undefined, warning_span,
                     joined_char_sequence(
@@ -85,8 +98,7 @@ Processing_Status run_generation(
                 preserved_values.push_back({});
                 continue;
             }
-            const Value& val = it->second;
-            if (!val.is_str()) {
+            if (!val->is_str()) {
                 context.try_warning(
                     diagnostic::preserved_not_str, warning_span,
                     joined_char_sequence(
@@ -96,7 +108,7 @@ Processing_Status run_generation(
                             u8"\" must be of type \""sv,
                             Type::str.get_display_name(),
                             u8"\" to be accessed by the environment, but is of type \""sv,
-                            val.get_type().get_display_name(),
+                            val->get_type().get_display_name(),
                             u8"\". Consider splicing its value into a string or using cowel_to_str."sv,
                         }
                     )
@@ -104,7 +116,7 @@ Processing_Status run_generation(
                 preserved_values.push_back({});
                 continue;
             }
-            preserved_values.push_back(val.as_string());
+            preserved_values.push_back(val->as_string());
         }
         COWEL_ASSERT(preserved_values.size() == options.preserved_variables.size());
         options.consume_variables(preserved_values);
@@ -115,69 +127,47 @@ Processing_Status run_generation(
 
 namespace {
 
-// See also `reference_section`.
-// The point of all this is that references to other sections are encoded using a section name,
-// which is encoded using a Supplementary Private Use Area A code point
-// storing the section name length, followed by the section name code units.
-
-constexpr char8_t supplementary_pua_a_first_code_unit
-    = utf8::encode8_unchecked(supplementary_pua_a_min).code_units[0];
-constexpr char8_t supplementary_pua_a_first_code_unit_mask = 0b1111'1000;
-constexpr char8_t supplementary_pua_a_first_code_unit_masked
-    = supplementary_pua_a_first_code_unit & supplementary_pua_a_first_code_unit_mask;
-
-static_assert(supplementary_pua_a_first_code_unit_masked == 0b1111'0000);
+// See also `Text_Sink::write_section_reference` and `Section_Content`.
+// References to other sections are recorded in a list alongside the text of each section,
+// so resolving them means splicing the referenced sections into the text at those offsets.
 
 struct Reference_Resolver {
     Text_Sink& out;
-    std::pmr::unordered_set<const Document_Sections::entry_type*>& visited;
+    /// @brief Indexed by `Section_Id`.
+    std::pmr::vector<bool>& visited;
     Context& context;
 
-    bool operator()(std::u8string_view text, File_Id file);
+    bool operator()(Section_Id id, File_Id file);
 };
 
-bool Reference_Resolver::operator()(std::u8string_view text, File_Id file)
+bool Reference_Resolver::operator()(Section_Id id, File_Id file)
 {
     bool success = true;
 
-    std::size_t plain_length = 0;
-    const auto flush = [&] {
-        if (plain_length != 0) {
-            out.write(text.substr(0, plain_length), Output_Language::html);
-            text.remove_prefix(plain_length);
-            plain_length = 0;
+    const Document_Sections& sections = context.get_sections();
+    const Section_Content& section = sections.get(id);
+    const std::u8string_view text = section.text();
+    std::size_t written_length = 0;
+    const auto write_until = [&](const std::size_t offset) {
+        if (offset != written_length) {
+            const std::u8string_view slice = text.substr(written_length, offset - written_length);
+            out.write_stable(slice, Output_Language::html);
+            written_length = offset;
         }
     };
-    while (plain_length < text.length()) {
-        // Obviously, almost none of the text in the generated document is a section reference,
-        // so we perform this early test,
-        // which tells us that it couldn't be a PUA A character based on the leading code unit.
-        if ((text[plain_length] & supplementary_pua_a_first_code_unit_mask)
-            != supplementary_pua_a_first_code_unit_masked) {
-            ++plain_length;
-            continue;
-        }
-        const auto [code_point, code_units]
-            = utf8::decode_and_length_or_replacement(text.substr(plain_length));
-        // This test passes for any code point that is encoded as four UTF-8 code units,
-        // so we still need to check if the code point is PUA A.
-        if (code_point < supplementary_pua_a_min || code_point > supplementary_pua_a_max) {
-            ++plain_length;
-            continue;
-        }
-        COWEL_DEBUG_ASSERT(code_units == 4);
-        flush();
-        const auto reference_length = std::size_t(code_point - supplementary_pua_a_min);
-        COWEL_ASSERT(4 + reference_length <= text.length());
-        const std::u8string_view section_name = text.substr(4, reference_length);
+    for (const Section_Reference& reference : section.references()) {
+        write_until(reference.offset);
+        const auto index = std::size_t(reference.section);
 
         bool section_success = true;
-        const Document_Sections::entry_type* const entry
-            = context.get_sections().find(section_name);
-        if (!entry) {
+        if (!sections.try_get(reference.section)) {
+            // A reference to an ID which was never assigned has no name to report.
+            const std::u8string_view name = sections.contains(reference.section)
+                ? sections.get_name(reference.section)
+                : u8""sv;
             const std::u8string_view message[] {
                 u8"Invalid reference to section \"",
-                section_name,
+                name,
                 u8"\".",
             };
             context.try_error(
@@ -185,10 +175,10 @@ bool Reference_Resolver::operator()(std::u8string_view text, File_Id file)
             );
             section_success = false;
         }
-        else if (const auto [_, insert_success] = visited.insert(entry); !insert_success) {
+        else if (visited[index]) {
             const std::u8string_view message[] {
                 u8"Circular dependency in reference to section \"",
-                section_name,
+                sections.get_name(reference.section),
                 u8"\".",
             };
             context.try_error(
@@ -196,17 +186,16 @@ bool Reference_Resolver::operator()(std::u8string_view text, File_Id file)
             );
             section_success = false;
         }
-        text.remove_prefix(4 + reference_length);
         if (section_success) {
-            const std::u8string_view referenced_text = entry->second.text();
-            (*this)(referenced_text, file);
+            visited[index] = true;
+            (*this)(reference.section, file);
+            visited[index] = false;
         }
         else {
             success = section_success;
         }
-        visited.erase(entry);
     }
-    flush();
+    write_until(text.length());
     return success;
 }
 
@@ -224,8 +213,7 @@ Processing_Status write_head_body_document(
 {
     Document_Sections& sections = context.get_sections();
 
-    const Document_Sections::entry_type* html_section = nullptr;
-    std::u8string_view html_string = [&] -> std::u8string_view {
+    const Section_Id html_section = [&] {
         const auto scope = sections.go_to_scoped(section_name::document_html);
 
         HTML_Writer_Buffer buffer { sections.current_policy(), Output_Language::html };
@@ -242,16 +230,15 @@ Processing_Status write_head_body_document(
         current_writer.write_preamble();
         open_and_close(html_tag::html, [&] {
             open_and_close(html_tag::head, [&] {
-                reference_section(buffer, section_name::document_head);
+                buffer.write_section_reference(sections.intern(section_name::document_head));
             });
             open_and_close(html_tag::body, [&] {
-                reference_section(buffer, section_name::document_body);
+                buffer.write_section_reference(sections.intern(section_name::document_body));
             });
         });
 
-        html_section = &sections.current();
         buffer.flush();
-        return as_u8string_view(sections.current_output());
+        return sections.current_id();
     }();
 
     auto status = Processing_Status::ok;
@@ -271,21 +258,19 @@ Processing_Status write_head_body_document(
     }
 
     const auto file = content.empty() ? File_Id::main : content.front().get_source_span().file;
-    const bool res_success = resolve_references(out, html_string, context, file);
+    const bool res_success = resolve_references(out, html_section, context, file);
     const auto res_status = res_success ? Processing_Status::ok : Processing_Status::error;
     status = status_concat(status, res_status);
 
     return status;
 }
 
-bool resolve_references(Text_Sink& out, std::u8string_view text, Context& context, File_Id file)
+bool resolve_references(Text_Sink& out, Section_Id section, Context& context, File_Id file)
 {
-    std::pmr::unordered_set<const Document_Sections::entry_type*> visited(
-        context.get_transient_memory()
-    );
-    visited.insert(&context.get_sections().current());
+    std::pmr::vector<bool> visited(context.get_sections().size(), context.get_transient_memory());
+    visited[std::size_t(section)] = true;
 
-    return Reference_Resolver { out, visited, context }(text, file);
+    return Reference_Resolver { out, visited, context }(section, file);
 }
 
 constexpr std::u8string_view indent = u8"  ";
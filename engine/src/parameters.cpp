@@ -491,7 +491,8 @@ enum struct Argument_Mode : Default_Underlying {
 };
 
 struct Match_Call {
-    const std::span<Parameter* const> parameters;
+    const Parameter_Schema_View schema;
+    const std::span<Value_Matcher* const> matchers;
     Context& context;
     const Fail_Callback on_fail;
     const Processing_Status on_fail_status;
@@ -566,7 +567,7 @@ Processing_Status Match_Call::operator()(
                         joined_char_sequence(
                             {
                                 u8"This argument is invalid because the parameter \""sv,
-                                parameters[parameter_index]->get_name(),
+                                schema.declarations[parameter_index].name,
                                 u8"\" has already been provided as a block argument.",
                             }
                         ),
@@ -581,7 +582,7 @@ Processing_Status Match_Call::operator()(
 
                 // FIXME: pretty sure this should be = parameter_index
                 argument_indices_by_parameter[parameter_index] = int(arg_index);
-                Value_Matcher& value_matcher = parameters[parameter_index]->get_value_matcher();
+                Value_Matcher& value_matcher = *matchers[parameter_index];
                 const auto arg_status
                     = value_matcher.match_value(arg, frame, context, on_member_fail);
                 if (arg_status != Processing_Status::ok) {
@@ -628,17 +629,17 @@ Processing_Status Match_Call::operator()(
             if (mode == Argument_Mode::normal) {
                 const std::size_t parameter_index = arg_index + cumulative_arg_index;
                 if (parameter_index < argument_indices_by_parameter.size()) {
-                    auto* const parameter = parameters[parameter_index];
-                    const bool is_pack_named = parameter->get_type().is_pack()
-                        && parameter->get_type().get_members().front().is_named();
+                    Value_Matcher& value_matcher = *matchers[parameter_index];
+                    const Type& type = value_matcher.get_matchable_type();
+                    const bool is_pack_named
+                        = type.is_pack() && type.get_members().front().is_named();
                     if (is_pack_named) {
                         argument_indices_by_parameter[parameter_index] = int(parameter_index);
-                        current_pack_value_matcher = &parameter->get_value_matcher();
+                        current_pack_value_matcher = &value_matcher;
                         current_pack_param_index = parameter_index;
                         mode = Argument_Mode::pack_named;
-                        const auto arg_status = parameter->get_value_matcher().match_value(
-                            arg, frame, context, on_member_fail
-                        );
+                        const auto arg_status
+                            = value_matcher.match_value(arg, frame, context, on_member_fail);
                         if (arg_status != Processing_Status::ok) {
                             return arg_status;
                         }
@@ -667,11 +668,7 @@ Processing_Status Match_Call::operator()(
             // we need to find a parameter with the same name.
             // Providing the same named argument twice or providing a named argument
             // without a corresponding parameter need to be diagnosed.
-            for (std::size_t i = 0; i < parameters.size(); ++i) {
-                auto* const member_matcher = parameters[i];
-                if (arg_name != member_matcher->get_name()) {
-                    continue;
-                }
+            if (const std::size_t i = schema.index_of(arg_name); i != -1uz) {
                 if (argument_indices_by_parameter[i] != -1) {
                     on_fail(
                         member.get_name_span(),
@@ -688,9 +685,8 @@ Processing_Status Match_Call::operator()(
                 }
                 // FIXME: Pretty sure this should be = parameter_index
                 argument_indices_by_parameter[i] = int(arg_index);
-                const auto arg_status = member_matcher->get_value_matcher().match_value(
-                    arg, frame, context, on_member_fail
-                );
+                const auto arg_status
+                    = matchers[i]->match_value(arg, frame, context, on_member_fail);
                 if (arg_status != Processing_Status::ok) {
                     return arg_status;
                 }
@@ -722,7 +718,8 @@ Processing_Status Match_Call::operator()(
 } // namespace
 
 Processing_Status match_call(
-    const std::span<Parameter* const> parameters,
+    const Parameter_Schema_View schema,
+    const std::span<Value_Matcher* const> matchers,
     const Invocation& call,
     Context& context,
     Fail_Callback on_fail,
@@ -731,16 +728,18 @@ Processing_Status match_call(
 {
     COWEL_ASSERT(on_fail);
     COWEL_ASSERT(status_is_error(on_fail_status));
+    COWEL_ASSERT(schema.size() == matchers.size());
+    COWEL_ASSERT(schema.name_hashes.size() == schema.declarations.size());
     if constexpr (is_debug_build) {
-        for (const auto* const matcher : parameters) {
+        for (const auto* const matcher : matchers) {
             COWEL_ASSERT(matcher != nullptr);
         }
     }
 
-    Small_Vector<int, 32> argument_indices_by_parameter(parameters.size(), -1);
+    Small_Vector<int, 32> argument_indices_by_parameter(schema.size(), -1);
 
     if (call.content) {
-        if (parameters.empty()) {
+        if (schema.size() == 0) {
             on_fail(
                 call.content->get_source_span(), //
                 u8"Block argument does not match any parameter."sv, //
@@ -754,9 +753,8 @@ Processing_Status match_call(
             .status = on_fail_status,
             .location = call.content->get_source_span(),
         };
-        const Processing_Status block_status = parameters.back()->get_value_matcher().match_value(
-            arg, call.content_frame, context, fail_options
-        );
+        const Processing_Status block_status
+            = matchers.back()->match_value(arg, call.content_frame, context, fail_options);
         if (block_status != Processing_Status::ok) {
             return block_status;
         }
@@ -764,7 +762,8 @@ Processing_Status match_call(
     }
 
     Match_Call match_call {
-        .parameters = parameters,
+        .schema = schema,
+        .matchers = matchers,
         .context = context,
         .on_fail = on_fail,
         .on_fail_status = on_fail_status,
@@ -782,14 +781,15 @@ Processing_Status match_call(
         return status;
     }
 
-    for (Parameter* const p : parameters) {
-        if (p->is_mandatory() && !p->get_value_matcher().was_matched()) {
+    for (std::size_t i = 0; i < schema.size(); ++i) {
+        const Parameter_Declaration& declaration = schema.declarations[i];
+        if (declaration.is_mandatory() && !matchers[i]->was_matched()) {
             on_fail(
                 call.directive.get_name_span(),
                 joined_char_sequence(
                     {
                         u8"No argument for parameter \"",
-                        p->get_name(),
+                        declaration.name,
                         u8"\" was provided.",
                     }
                 ),
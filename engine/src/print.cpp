@@ -19,6 +19,7 @@
 #include "cowel/util/ansi.hpp"
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/html_writer.hpp"
 #include "cowel/util/source_position.hpp"
 #include "cowel/util/strings.hpp"
@@ -83,8 +84,7 @@ struct Error_Line {
 
 void do_print_affected_line(
     Diagnostic_String& out,
-    std::u8string_view source,
-    std::size_t begin,
+    std::u8string_view cited_code,
     std::size_t length,
     std::size_t line,
     std::size_t column
@@ -94,8 +94,6 @@ void do_print_affected_line(
 
     // TODO: add proper multi-line support
 
-    const std::u8string_view cited_code = find_line(source, begin);
-
     const auto line_chars = to_characters<char8_t>(line + 1);
     constexpr std::size_t pad_max = 6;
     const std::size_t pad_length
@@ -165,13 +163,26 @@ void print_affected_line(
     const Source_Position& pos
 )
 {
-    do_print_affected_line(out, source, pos.begin, 1, pos.line, pos.column);
+    do_print_affected_line(out, find_line(source, pos.begin), 1, pos.line, pos.column);
 }
 
 void print_affected_line(Diagnostic_String& out, std::u8string_view source, const Source_Span& pos)
 {
     COWEL_ASSERT(!pos.empty());
-    do_print_affected_line(out, source, pos.begin, pos.length, pos.line, pos.column);
+    do_print_affected_line(out, find_line(source, pos.begin), pos.length, pos.line, pos.column);
+}
+
+void print_affected_line(
+    Diagnostic_String& out,
+    std::u8string_view source,
+    const Line_Table& lines,
+    const Source_Span& pos
+)
+{
+    COWEL_ASSERT(!pos.empty());
+    do_print_affected_line(
+        out, lines.line_text(source, pos.line), pos.length, pos.line, pos.column
+    );
 }
 
 std::u8string_view find_line(std::u8string_view source, std::size_t index)
@@ -329,7 +340,7 @@ void dump_tokens(
 {
     for (const auto& token : tokens) {
         out.append(indent);
-        print_token(out, token.kind, source.substr(token.location.begin, token.location.length));
+        print_token(out, token.kind, source.substr(token.begin, token.length));
         out.append(u8'\n');
     }
 }
@@ -378,7 +389,7 @@ void dump_instructions(
             COWEL_ASSERT(token_idx < tokens.size());
             const auto& tok = tokens[token_idx];
             out.append(u8' ');
-            print_quoted_text(out, source.substr(tok.location.begin, tok.location.length));
+            print_quoted_text(out, source.substr(tok.begin, tok.length));
         }
         if (advances) {
             ++token_idx;
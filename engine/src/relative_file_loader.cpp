@@ -1,10 +1,12 @@
 #include <filesystem>
 #include <memory_resource>
+#include <optional>
 #include <string_view>
 #include <vector>
 
 #include "cowel/util/char_sequence.hpp"
 #include "cowel/util/function_ref.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
 
@@ -75,8 +77,12 @@ auto Relative_File_Loader::do_load(Char_Sequence8 path_chars, const File_Id rela
             .path = std::move(resolved),
             .path_string = std::move(resolved_string),
             .text = result ? std::move(*result) : std::pmr::vector<char8_t> {},
+            .lines = std::nullopt,
         }
     );
+    if (result) {
+        entry.lines.emplace(as_u8string_view(entry.text), memory);
+    }
 
     const auto result_status = result ? COWEL_IO_OK : io_error_to_io_status(result.error());
     const auto result_data = result ? as_cowel_string_view(as_u8string_view(entry.text)) //
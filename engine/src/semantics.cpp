@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <ranges>
 #include <span>
@@ -7,11 +11,16 @@
 
 #include "cowel/util/assert.hpp"
 #include "cowel/util/char_sequence.hpp"
+#include "cowel/util/char_sequence_factory.hpp"
 #include "cowel/util/result.hpp"
+#include "cowel/util/small_vector.hpp"
+#include "cowel/util/strings.hpp"
 
 #include "cowel/context.hpp"
 #include "cowel/diagnostic.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
+#include "cowel/string_kind.hpp"
 #include "cowel/type.hpp"
 #include "cowel/value.hpp"
 
@@ -86,12 +95,240 @@ Value Value::dynamic_string_forced(const std::u8string_view value, const String_
 
 Value Value::string(const std::u8string_view value, const String_Kind kind)
 {
-    if (value.size() <= Short_String_Value::max_size_v) {
+    if (value.size() <= Inline_String_Value::max_size_v) {
         return short_string({ value.data(), value.size() }, kind);
     }
     return dynamic_string_forced(value, kind);
 }
 
+namespace {
+
+/// @brief Concatenations of at most this many code units are copied into a contiguous string
+/// instead of forming a rope.
+/// This also means that every rope is longer than this.
+constexpr std::size_t rope_min_length = 256;
+
+/// @brief Ropes deeper than this are rebalanced.
+/// This bounds the recursion when ropes are destroyed.
+constexpr std::size_t rope_max_depth = 48;
+
+/// @brief `fibonacci[i]` is the `i`-th Fibonacci number, where `fibonacci[0] == 0`.
+/// This contains every Fibonacci number that fits into `std::uint64_t`.
+constexpr auto fibonacci = [] {
+    std::array<std::uint64_t, 94> result {};
+    result[1] = 1;
+    for (std::size_t i = 2; i < result.size(); ++i) {
+        result[i] = result[i - 1] + result[i - 2];
+    }
+    return result;
+}();
+
+/// @brief The amount of slots used by `Value::rebalance_rope`.
+/// Slot `i` holds ropes whose length is in `[fibonacci[i + 2], fibonacci[i + 3])`.
+constexpr std::size_t rope_slot_count = fibonacci.size() - 3;
+
+/// @brief Returns `true` iff the rope with the given length and depth is balanced,
+/// i.e. its length is at least `fibonacci[depth + 2]`.
+/// Leaves (with a depth of zero) are always balanced,
+/// and the depth of a balanced rope is logarithmic in its length.
+[[nodiscard]]
+bool is_balanced_rope(const std::size_t length, const std::size_t depth)
+{
+    return depth + 2 >= fibonacci.size() || length >= fibonacci[depth + 2];
+}
+
+[[nodiscard]]
+String_Kind concat_string_kind(const String_Kind x, const String_Kind y)
+{
+    if (x == y) {
+        return x;
+    }
+    if (x == String_Kind::unknown || y == String_Kind::unknown) {
+        return String_Kind::unknown;
+    }
+    return String_Kind::unicode;
+}
+
+} // namespace
+
+std::size_t Value::get_string_length() const
+{
+    if (const Rope_String_Node* const node = get_rope_node()) {
+        return node->length;
+    }
+    return as_string().size();
+}
+
+const Rope_String_Node* Value::get_rope_node() const
+{
+    if (m_index != rope_string_index || m_value.rope_string->flat) {
+        return nullptr;
+    }
+    return &*m_value.rope_string;
+}
+
+std::size_t Value::get_rope_depth() const
+{
+    const Rope_String_Node* const node = get_rope_node();
+    return node ? node->depth : 0;
+}
+
+Value Value::string_concat(const Value& lhs, const Value& rhs)
+{
+    COWEL_ASSERT(lhs.is_str() && rhs.is_str());
+    const std::size_t lhs_length = lhs.get_string_length();
+    const std::size_t rhs_length = rhs.get_string_length();
+    if (rhs_length == 0) {
+        return lhs;
+    }
+    if (lhs_length == 0) {
+        return rhs;
+    }
+    const String_Kind kind = concat_string_kind(lhs.m_string_kind, rhs.m_string_kind);
+
+    if (lhs_length + rhs_length <= rope_min_length) {
+        // Since ropes are longer than rope_min_length, neither operand is a rope,
+        // and calling as_string() is cheap.
+        std::array<char8_t, rope_min_length> buffer;
+        const auto lhs_end = std::ranges::copy(lhs.as_string(), buffer.data()).out;
+        const auto rhs_end = std::ranges::copy(rhs.as_string(), lhs_end).out;
+        return Value::string({ buffer.data(), rhs_end }, kind);
+    }
+
+    // When a string is built by appending (or prepending) short pieces,
+    // those pieces are merged with the short operand of the rope,
+    // rather than forming a new node (and leaf) for every piece.
+    if (const Rope_String_Node* const node = lhs.get_rope_node()) {
+        if (node->rhs.get_string_length() + rhs_length <= rope_min_length) {
+            return make_rope(node->lhs, string_concat(node->rhs, rhs), kind);
+        }
+    }
+    if (const Rope_String_Node* const node = rhs.get_rope_node()) {
+        if (lhs_length + node->lhs.get_string_length() <= rope_min_length) {
+            return make_rope(string_concat(lhs, node->lhs), node->rhs, kind);
+        }
+    }
+    return make_rope(lhs, rhs, kind);
+}
+
+Value Value::make_rope(const Value& lhs, const Value& rhs, const String_Kind kind)
+{
+    Value result = make_rope_node(lhs, rhs, kind);
+    return result.get_rope_depth() > rope_max_depth ? rebalance_rope(result) : result;
+}
+
+Value Value::make_rope_node(const Value& lhs, const Value& rhs, const String_Kind kind)
+{
+    Rope_String_Value node = gc_ref_make<Rope_String_Node>(Rope_String_Node {
+        .lhs = lhs,
+        .rhs = rhs,
+        .length = lhs.get_string_length() + rhs.get_string_length(),
+        .depth = 1 + std::max(lhs.get_rope_depth(), rhs.get_rope_depth()),
+        .flat = {},
+    });
+    return Value { Union { .rope_string = std::move(node) }, rope_string_index, kind };
+}
+
+Value Value::rebalance_rope(const Value& rope)
+{
+    // This is the algorithm described by Boehm et al. in "Ropes: an Alternative to Strings".
+    // The rope is traversed from left to right,
+    // and each balanced subtree is added to an array of slots as a whole,
+    // so that only the unbalanced part of the rope is visited.
+    // When a string is built by appending, that part consists of the nodes created
+    // since the last rebalancing, so rebalancing takes amortized constant time per append.
+    std::array<Value, rope_slot_count> slots;
+
+    // Concatenates `lhs` and `rhs` without rebalancing, or returns `rhs` if `lhs` is null.
+    const auto concat = [](const Value& lhs, const Value& rhs) -> Value {
+        if (lhs.is_null()) {
+            return rhs;
+        }
+        const String_Kind kind = concat_string_kind(lhs.m_string_kind, rhs.m_string_kind);
+        return make_rope_node(lhs, rhs, kind);
+    };
+
+    // Adds a balanced rope to the right of the contents of all slots.
+    // Afterwards, every slot still holds a balanced rope within its range of lengths,
+    // and the concatenation of slots from highest to lowest still yields the visited string.
+    const auto add_to_slots = [&](const Value& piece) {
+        const std::size_t length = piece.get_string_length();
+        Value too_short;
+        std::size_t i = 0;
+        for (; length >= fibonacci[i + 3]; ++i) {
+            if (!slots[i].is_null()) {
+                too_short = too_short.is_null() ? slots[i] : concat(slots[i], too_short);
+                slots[i] = Value::null;
+            }
+        }
+        Value inserted = concat(too_short, piece);
+        for (;; ++i) {
+            if (!slots[i].is_null()) {
+                inserted = concat(slots[i], inserted);
+                slots[i] = Value::null;
+            }
+            if (i + 1 == slots.size() || inserted.get_string_length() < fibonacci[i + 3]) {
+                slots[i] = std::move(inserted);
+                return;
+            }
+        }
+    };
+
+    Small_Vector<const Value*, 64> stack { &rope };
+    while (!stack.empty()) {
+        const Value& v = *stack.back();
+        stack.pop_back();
+        const Rope_String_Node* const node = v.get_rope_node();
+        if (node && !is_balanced_rope(node->length, node->depth)) {
+            stack.push_back(&node->rhs);
+            stack.push_back(&node->lhs);
+        }
+        else {
+            add_to_slots(v);
+        }
+    }
+
+    Value result;
+    for (const Value& slot : slots) {
+        if (!slot.is_null()) {
+            result = result.is_null() ? slot : concat(slot, result);
+        }
+    }
+    COWEL_ASSERT(result.get_string_length() == rope.get_string_length());
+    return result;
+}
+
+std::u8string_view Value::flatten(const Rope_String_Value& rope)
+{
+    const Rope_String_Node& node = *rope;
+    if (node.flat) {
+        return as_u8string_view(node.flat.as_span());
+    }
+
+    Dynamic_String_Value flat = gc_ref_make_array<char8_t>(node.length);
+    char8_t* out = flat.as_span().data();
+    // The leaves are visited from left to right.
+    Small_Vector<const Value*, 64> stack { &node.rhs, &node.lhs };
+    while (!stack.empty()) {
+        const Value& v = *stack.back();
+        stack.pop_back();
+        if (const Rope_String_Node* const child = v.get_rope_node()) {
+            stack.push_back(&child->rhs);
+            stack.push_back(&child->lhs);
+        }
+        else {
+            out = std::ranges::copy(v.as_string(), out).out;
+        }
+    }
+    COWEL_ASSERT(out == flat.as_span().data() + node.length);
+
+    node.flat = std::move(flat);
+    // Once flattened, the operands are no longer needed.
+    node.lhs = Value::null;
+    node.rhs = Value::null;
+    return as_u8string_view(node.flat.as_span());
+}
+
 Value Value::regex(const Reg_Exp& value)
 {
     return Value { Union { .regex = value }, regex_index };
@@ -263,7 +500,7 @@ static_assert(sizeof(Int64) == 8);
 static_assert(sizeof(Int128) == 16);
 
 static_assert(alignof(Value) <= 16, "Value should not be excessively aligned.");
-static_assert(sizeof(Value) <= 64, "Value should not be too large to be passed by value.");
+static_assert(sizeof(Value) <= 32, "Value should not be too large to be passed by value.");
 
 consteval bool test_sanitized()
 {
@@ -688,16 +925,15 @@ Result<Value, Processing_Status> evaluate_builtin(
     case let_block:
     case let_group: {
         const std::u8string_view name = lhs.as_string();
-        const auto it = context.get_variables().find(name);
-        if (it != context.get_variables().end()) {
+        const Symbol symbol = context.intern(name);
+        if (context.get_variable(symbol)) {
             context.try_error_f(
                 diagnostic::var_let, lhs_location,
                 u8"Unable to declare new variable with the name \"{}\"."sv, name
             );
             return Processing_Status::error;
         }
-        std::pmr::u8string name_copy { name, context.get_transient_memory() };
-        const auto [_, success] = context.get_variables().emplace(std::move(name_copy), rhs);
+        const auto [_, success] = context.get_variables().emplace(symbol, rhs);
         COWEL_DEBUG_ASSERT(success);
         return rhs;
     }
@@ -711,15 +947,15 @@ Result<Value, Processing_Status> evaluate_builtin(
     case assign_block:
     case assign_group: {
         const std::u8string_view name = lhs.as_string();
-        const auto it = context.get_variables().find(name);
-        if (it == context.get_variables().end()) {
+        Value* const variable = context.get_variable(name);
+        if (!variable) {
             context.try_error_f(
                 diagnostic::var_set, lhs_location,
                 u8"Unable to set variable with the name \"{}\"."sv, name
             );
             return Processing_Status::error;
         }
-        it->second = rhs;
+        *variable = rhs;
         return rhs;
     }
     case logical_or_bool_bool: {
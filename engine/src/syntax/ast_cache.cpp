@@ -0,0 +1,868 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ulight/impl/lang/cowel.hpp"
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/chars.hpp"
+#include "cowel/util/line_table.hpp"
+#include "cowel/util/source_position.hpp"
+#include "cowel/util/unicode.hpp"
+
+#include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
+#include "cowel/services.hpp"
+#include "cowel/settings.hpp"
+
+#include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/ast_cache.hpp"
+#include "cowel/syntax/expression_kind.hpp"
+#include "cowel/syntax/parse.hpp"
+
+namespace cowel {
+namespace {
+
+using ulight::Common_Number_Result;
+using ulight::cowel::match_number;
+
+// 128-bit FNV-1a, see http://www.isthe.com/chongo/tech/comp/fnv/
+constexpr Uint128 fnv1a_128_prime = (Uint128(1) << 88) | 0x13B;
+constexpr Uint128 fnv1a_128_offset_basis
+    = (Uint128(0x6c62'272e'07bb'0142) << 64) | 0x62b8'2175'6295'c58d;
+
+[[nodiscard]]
+Uint128 fnv1a_128(Uint128 hash, std::span<const std::byte> bytes)
+{
+    for (const std::byte b : bytes) {
+        hash ^= Uint128(b);
+        hash *= fnv1a_128_prime;
+    }
+    return hash;
+}
+
+constexpr std::array<char, 8> flat_ast_magic { 'c', 'o', 'w', 'e', 'l', 'A', 'S', 'T' };
+constexpr std::uint32_t byte_order_mark = 0x0102'0304;
+constexpr std::size_t node_array_count = 8;
+constexpr std::size_t node_array_alignment = 8;
+
+struct Flat_AST_Header {
+    std::array<char, 8> magic;
+    std::uint32_t format_version;
+    /// @brief `byte_order_mark`, as written on the machine that produced the data.
+    std::uint32_t byte_order;
+    std::uint64_t source_length;
+    Flat_Range roots;
+    /// @brief The number of nodes in each array, in the order of `for_each_node_array`.
+    std::array<std::uint32_t, node_array_count> node_counts;
+    /// @brief The size of each node type, which guards against ABI differences
+    /// between the engines that write and read the data.
+    std::array<std::uint8_t, node_array_count> node_sizes;
+};
+
+static_assert(std::is_trivially_copyable_v<Flat_AST_Header>);
+static_assert(sizeof(Flat_AST_Header) % node_array_alignment == 0);
+
+/// @brief Invokes `f` with each of the node arrays of `ast` in a fixed order.
+template <typename AST, typename F>
+void for_each_node_array(AST& ast, F f)
+{
+    f(ast.element_refs);
+    f(ast.directives);
+    f(ast.primaries);
+    f(ast.members);
+    f(ast.expressions);
+    f(ast.unary_expressions);
+    f(ast.binary_expressions);
+    f(ast.let_expressions);
+}
+
+[[nodiscard]]
+constexpr std::size_t align_node_array_offset(std::size_t offset)
+{
+    return (offset + node_array_alignment - 1) & ~(node_array_alignment - 1);
+}
+
+void append_bytes(std::pmr::vector<std::byte>& out, const void* data, std::size_t size)
+{
+    const std::size_t old_size = out.size();
+    out.resize(align_node_array_offset(old_size + size));
+    if (size != 0) {
+        std::memcpy(out.data() + old_size, data, size);
+    }
+}
+
+/// @brief Returns `true` iff `source` is a complete numeric literal as matched by the lexer,
+/// which is an integer literal if `integer` is `true`, and a floating-point literal otherwise.
+[[nodiscard]]
+bool is_numeric_literal(const std::u8string_view source, const bool integer)
+{
+    const Common_Number_Result result = match_number(source);
+    return result && !result.erroneous && result.length == source.length()
+        && !source.starts_with(u8'+') && result.is_non_integer() != integer;
+}
+
+/// @brief Checks that every span and index within a `Flat_AST` is in bounds,
+/// and that every node is referenced at most once.
+/// The latter implies that the nodes reachable from the roots form a tree,
+/// so a corrupted AST cannot make `inflate_ast` recurse infinitely.
+///
+/// Additionally, the values which `inflate_ast` takes from the nodes or computes from the source
+/// (e.g. the code points of escapes and the values of integer literals) are checked,
+/// so that inflating cannot violate the preconditions of the `ast.hpp` types.
+struct Flat_AST_Validator {
+    const Flat_AST& m_ast;
+    std::size_t m_source_length;
+
+    std::pmr::vector<bool> m_claimed_element_refs;
+    std::pmr::vector<bool> m_claimed_directives;
+    std::pmr::vector<bool> m_claimed_primaries;
+    std::pmr::vector<bool> m_claimed_members;
+    std::pmr::vector<bool> m_claimed_expressions;
+    std::pmr::vector<bool> m_claimed_unary_expressions;
+    std::pmr::vector<bool> m_claimed_binary_expressions;
+    std::pmr::vector<bool> m_claimed_let_expressions;
+
+    [[nodiscard]]
+    Flat_AST_Validator(
+        const Flat_AST& ast,
+        std::size_t source_length,
+        std::pmr::memory_resource* memory
+    )
+        : m_ast { ast }
+        , m_source_length { source_length }
+        , m_claimed_element_refs(ast.element_refs.size(), false, memory)
+        , m_claimed_directives(ast.directives.size(), false, memory)
+        , m_claimed_primaries(ast.primaries.size(), false, memory)
+        , m_claimed_members(ast.members.size(), false, memory)
+        , m_claimed_expressions(ast.expressions.size(), false, memory)
+        , m_claimed_unary_expressions(ast.unary_expressions.size(), false, memory)
+        , m_claimed_binary_expressions(ast.binary_expressions.size(), false, memory)
+        , m_claimed_let_expressions(ast.let_expressions.size(), false, memory)
+    {
+    }
+
+    [[nodiscard]]
+    bool operator()()
+    {
+        if (!claim_range(m_claimed_element_refs, m_ast.roots)) {
+            return false;
+        }
+        for (const Flat_Ref& ref : m_ast.element_refs) {
+            if (!validate_element_ref(ref)) {
+                return false;
+            }
+        }
+        // clang-format off
+        return validate_all(m_ast.directives, &Flat_AST_Validator::validate_directive)
+            && validate_all(m_ast.primaries, &Flat_AST_Validator::validate_primary)
+            && validate_all(m_ast.members, &Flat_AST_Validator::validate_member)
+            && validate_all(m_ast.expressions, &Flat_AST_Validator::validate_expression)
+            && validate_all(m_ast.unary_expressions, &Flat_AST_Validator::validate_unary)
+            && validate_all(m_ast.binary_expressions, &Flat_AST_Validator::validate_binary)
+            && validate_all(m_ast.let_expressions, &Flat_AST_Validator::validate_let);
+        // clang-format on
+    }
+
+private:
+    template <typename Node>
+    [[nodiscard]]
+    bool validate_all(
+        const std::pmr::vector<Node>& nodes,
+        bool (Flat_AST_Validator::*validate)(const Node&)
+    )
+    {
+        for (const Node& node : nodes) {
+            if (!(this->*validate)(node)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    static bool claim(std::pmr::vector<bool>& claimed, Flat_Index index)
+    {
+        if (index >= claimed.size() || claimed[index]) {
+            return false;
+        }
+        claimed[index] = true;
+        return true;
+    }
+
+    [[nodiscard]]
+    static bool claim_range(std::pmr::vector<bool>& claimed, Flat_Range range)
+    {
+        if (range.first > claimed.size() || range.size > claimed.size() - range.first) {
+            return false;
+        }
+        for (Flat_Index i = range.first; i < range.first + range.size; ++i) {
+            if (!claim(claimed, i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    bool is_valid_span(const Flat_Span& span) const
+    {
+        return span.begin <= m_source_length && span.length <= m_source_length - span.begin;
+    }
+
+    [[nodiscard]]
+    bool claim_primary(Flat_Index index, ast::Primary_Kind expected_kind)
+    {
+        return claim(m_claimed_primaries, index) && m_ast.primaries[index].kind == expected_kind;
+    }
+
+    [[nodiscard]]
+    bool validate_element_ref(const Flat_Ref& ref)
+    {
+        switch (ref.kind) {
+        case Flat_Node_Kind::directive: return claim(m_claimed_directives, ref.index);
+        case Flat_Node_Kind::primary: return claim(m_claimed_primaries, ref.index);
+        case Flat_Node_Kind::expression: return claim(m_claimed_expressions, ref.index);
+        default: return false;
+        }
+    }
+
+    [[nodiscard]]
+    bool validate_directive(const Flat_Directive& directive)
+    {
+        return is_valid_span(directive.span) //
+            && directive.name_offset <= directive.span.length
+            && directive.name_length <= directive.span.length - directive.name_offset
+            && (directive.arguments == no_flat_index
+                || claim_primary(directive.arguments, ast::Primary_Kind::group))
+            && (directive.content == no_flat_index
+                || claim_primary(directive.content, ast::Primary_Kind::block));
+    }
+
+    [[nodiscard]]
+    bool validate_primary(const Flat_Primary& primary)
+    {
+        if (!is_valid_span(primary.span) || primary.span.length == 0) {
+            return false;
+        }
+        const std::u8string_view source = m_ast.get_source(primary.span);
+        if (primary.kind != ast::Primary_Kind::escape && primary.code_point != 0) {
+            return false;
+        }
+        using enum ast::Primary_Kind;
+        switch (primary.kind) {
+        case block: {
+            return source.starts_with(u8'{') && source.ends_with(u8'}')
+                && claim_range(m_claimed_element_refs, primary.children);
+        }
+        case quoted_string: {
+            return source.starts_with(u8'"') && source.ends_with(u8'"')
+                && claim_range(m_claimed_element_refs, primary.children);
+        }
+        case group: {
+            return source.starts_with(u8'(') && source.ends_with(u8')')
+                && claim_range(m_claimed_members, primary.children);
+        }
+        case int_literal: {
+            return primary.children.size == 0 && is_numeric_literal(source, true);
+        }
+        case decimal_float_literal: {
+            return primary.children.size == 0 && is_numeric_literal(source, false);
+        }
+        case escape: {
+            return primary.children.size == 0 && source.length() >= 2
+                && source.starts_with(u8'\\')
+                && (primary.code_point == char32_t(-1) || is_scalar_value(primary.code_point));
+        }
+        case unit_literal:
+        case null_literal:
+        case bool_literal:
+        case infinity:
+        case unquoted_member_name:
+        case id_expression:
+        case text:
+        case comment:
+        case empty_splice: return primary.children.size == 0;
+        }
+        return false;
+    }
+
+    [[nodiscard]]
+    bool validate_member(const Flat_Member& member)
+    {
+        if (!is_valid_span(member.span)) {
+            return false;
+        }
+        switch (member.kind) {
+        case ast::Member_Kind::named: {
+            if (!claim(m_claimed_primaries, member.name)) {
+                return false;
+            }
+            const ast::Primary_Kind name_kind = m_ast.primaries[member.name].kind;
+            return (name_kind == ast::Primary_Kind::unquoted_member_name
+                    || name_kind == ast::Primary_Kind::quoted_string)
+                && claim(m_claimed_expressions, member.value);
+        }
+        case ast::Member_Kind::positional: {
+            return member.name == no_flat_index && claim(m_claimed_expressions, member.value);
+        }
+        case ast::Member_Kind::ellipsis: {
+            return member.name == no_flat_index && member.value == no_flat_index;
+        }
+        }
+        return false;
+    }
+
+    [[nodiscard]]
+    bool validate_expression(const Flat_Expression& expression)
+    {
+        if (!is_valid_span(expression.span)) {
+            return false;
+        }
+        const Flat_Index index = expression.inner.index;
+        switch (expression.inner.kind) {
+        case Flat_Node_Kind::directive: return claim(m_claimed_directives, index);
+        case Flat_Node_Kind::primary: return claim(m_claimed_primaries, index);
+        case Flat_Node_Kind::unary_expression: return claim(m_claimed_unary_expressions, index);
+        case Flat_Node_Kind::binary_expression: return claim(m_claimed_binary_expressions, index);
+        case Flat_Node_Kind::let_expression: return claim(m_claimed_let_expressions, index);
+        case Flat_Node_Kind::expression: break;
+        }
+        return false;
+    }
+
+    [[nodiscard]]
+    bool validate_unary(const Flat_Unary_Expression& unary)
+    {
+        return is_valid_span(unary.span)
+            && unary.kind <= Unary_Expression_Kind::minus
+            && claim(m_claimed_expressions, unary.operand);
+    }
+
+    [[nodiscard]]
+    bool validate_binary(const Flat_Binary_Expression& binary)
+    {
+        return is_valid_span(binary.span)
+            && binary.kind <= Binary_Expression_Kind::remainder
+            && claim(m_claimed_expressions, binary.lhs)
+            && claim(m_claimed_expressions, binary.rhs);
+    }
+
+    [[nodiscard]]
+    bool validate_let(const Flat_Let_Expression& let)
+    {
+        return is_valid_span(let.span) && is_valid_span(let.name_span)
+            && claim(m_claimed_expressions, let.value);
+    }
+};
+
+struct AST_Flattener {
+    Flat_AST& m_out;
+
+    [[nodiscard]]
+    Flat_Range flatten_elements(std::span<const ast::Markup_Element> elements)
+    {
+        // All elements of a range need to be contiguous,
+        // so we first reserve the range and fill it afterwards,
+        // while nested elements are appended past the end of the range.
+        const auto first = Flat_Index(m_out.element_refs.size());
+        m_out.element_refs.resize(m_out.element_refs.size() + elements.size());
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+            const Flat_Ref ref = flatten_element(elements[i]);
+            m_out.element_refs[first + i] = ref;
+        }
+        return { first, std::uint32_t(elements.size()) };
+    }
+
+    [[nodiscard]]
+    Flat_Ref flatten_element(const ast::Markup_Element& element)
+    {
+        if (const auto* const d = element.try_as_directive()) {
+            return { Flat_Node_Kind::directive, flatten_directive(*d) };
+        }
+        if (const auto* const p = element.try_as_primary()) {
+            return { Flat_Node_Kind::primary, flatten_primary(*p) };
+        }
+        return { Flat_Node_Kind::expression, flatten_expression(element.as_expression()) };
+    }
+
+    [[nodiscard]]
+    Flat_Index flatten_directive(const ast::Directive& directive)
+    {
+        const std::u8string_view source = directive.get_source();
+        const std::u8string_view name = directive.get_name();
+        COWEL_DEBUG_ASSERT(name.data() >= source.data());
+        COWEL_DEBUG_ASSERT(name.data() + name.length() <= source.data() + source.length());
+
+        const ast::Primary* const arguments = directive.get_arguments();
+        const ast::Primary* const content = directive.get_content();
+        const Flat_Directive result {
+            .span = Flat_Span::from(directive.get_source_span()),
+            .name_offset = std::uint32_t(name.data() - source.data()),
+            .name_length = std::uint32_t(name.length()),
+            .arguments = arguments ? flatten_primary(*arguments) : no_flat_index,
+            .content = content ? flatten_primary(*content) : no_flat_index,
+        };
+        m_out.directives.push_back(result);
+        return Flat_Index(m_out.directives.size() - 1);
+    }
+
+    [[nodiscard]]
+    Flat_Index flatten_primary(const ast::Primary& primary)
+    {
+        using enum ast::Primary_Kind;
+
+        Flat_Range children {};
+        char32_t code_point = 0;
+        switch (primary.get_kind()) {
+        case block:
+        case quoted_string: {
+            children = flatten_elements(primary.get_elements());
+            break;
+        }
+        case group: {
+            children = flatten_members(primary.get_members());
+            break;
+        }
+        case escape: {
+            code_point = decode_escape(primary.get_escaped_code_units());
+            break;
+        }
+        default: break;
+        }
+
+        m_out.primaries.push_back(
+            {
+                .span = Flat_Span::from(primary.get_source_span()),
+                .kind = primary.get_kind(),
+                .children = children,
+                .code_point = code_point,
+            }
+        );
+        return Flat_Index(m_out.primaries.size() - 1);
+    }
+
+    [[nodiscard]]
+    static char32_t decode_escape(std::u8string_view code_units)
+    {
+        if (code_units.empty()) {
+            return char32_t(-1);
+        }
+        const auto [code_point, length] = utf8::decode_and_length_or_replacement(code_units);
+        COWEL_DEBUG_ASSERT(std::size_t(length) == code_units.length());
+        return code_point;
+    }
+
+    [[nodiscard]]
+    Flat_Range flatten_members(std::span<const ast::Group_Member> members)
+    {
+        const auto first = Flat_Index(m_out.members.size());
+        m_out.members.resize(m_out.members.size() + members.size());
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            const ast::Group_Member& member = members[i];
+            const Flat_Member result {
+                .span = Flat_Span::from(member.get_source_span()),
+                .kind = member.get_kind(),
+                .name = member.has_name() ? flatten_primary(member.get_name()) : no_flat_index,
+                .value
+                = member.has_value() ? flatten_expression(member.get_value()) : no_flat_index,
+            };
+            m_out.members[first + i] = result;
+        }
+        return { first, std::uint32_t(members.size()) };
+    }
+
+    [[nodiscard]]
+    Flat_Index flatten_expression(const ast::Expression& expression)
+    {
+        const Flat_Ref inner = [&] -> Flat_Ref {
+            if (const auto* const d = expression.try_as_directive()) {
+                return { Flat_Node_Kind::directive, flatten_directive(*d) };
+            }
+            if (const auto* const p = expression.try_as_primary()) {
+                return { Flat_Node_Kind::primary, flatten_primary(*p) };
+            }
+            if (const auto* const u = expression.try_as_unary()) {
+                const Flat_Unary_Expression result {
+                    .span = Flat_Span::from(u->get_source_span()),
+                    .kind = u->get_kind(),
+                    .operand = flatten_expression(u->get_operand()),
+                };
+                m_out.unary_expressions.push_back(result);
+                return { Flat_Node_Kind::unary_expression,
+                         Flat_Index(m_out.unary_expressions.size() - 1) };
+            }
+            if (const auto* const b = expression.try_as_binary()) {
+                const Flat_Binary_Expression result {
+                    .span = Flat_Span::from(b->get_source_span()),
+                    .kind = b->get_kind(),
+                    .lhs = flatten_expression(b->get_lhs()),
+                    .rhs = flatten_expression(b->get_rhs()),
+                };
+                m_out.binary_expressions.push_back(result);
+                return { Flat_Node_Kind::binary_expression,
+                         Flat_Index(m_out.binary_expressions.size() - 1) };
+            }
+            const ast::Let_Expression& let = expression.as_let();
+            const Flat_Let_Expression result {
+                .span = Flat_Span::from(let.get_source_span()),
+                .name_span = Flat_Span::from(let.get_name_span()),
+                .value = flatten_expression(let.get_value()),
+            };
+            m_out.let_expressions.push_back(result);
+            return { Flat_Node_Kind::let_expression,
+                     Flat_Index(m_out.let_expressions.size() - 1) };
+        }();
+
+        m_out.expressions.push_back(
+            {
+                .span = Flat_Span::from(expression.get_source_span()),
+                .inner = inner,
+            }
+        );
+        return Flat_Index(m_out.expressions.size() - 1);
+    }
+};
+
+struct AST_Inflater {
+    const Flat_AST& m_ast;
+    std::pmr::memory_resource* const m_memory;
+    GC_Arena* const m_arena;
+
+    template <typename T>
+    [[nodiscard]]
+    GC_Ref<T> make_node(T&& node)
+    {
+        return m_arena ? m_arena->make<T>(std::move(node)) : gc_ref_make<T>(std::move(node));
+    }
+
+    [[nodiscard]]
+    File_Source_Span span_of(const Flat_Span& span) const
+    {
+        return span.to_file_span(m_ast.file);
+    }
+
+    void inflate_elements(ast::Pmr_Vector<ast::Markup_Element>& out, Flat_Range range)
+    {
+        out.reserve(out.size() + range.size);
+        for (Flat_Index i = range.first; i < range.first + range.size; ++i) {
+            const Flat_Ref ref = m_ast.element_refs[i];
+            switch (ref.kind) {
+            case Flat_Node_Kind::directive: {
+                out.emplace_back(inflate_directive(ref.index));
+                break;
+            }
+            case Flat_Node_Kind::primary: {
+                out.emplace_back(inflate_primary(ref.index));
+                break;
+            }
+            case Flat_Node_Kind::expression: {
+                out.emplace_back(inflate_expression(ref.index));
+                break;
+            }
+            default: COWEL_ASSERT_UNREACHABLE(u8"Invalid markup element kind.");
+            }
+        }
+    }
+
+    [[nodiscard]]
+    ast::Directive inflate_directive(Flat_Index index)
+    {
+        const Flat_Directive& directive = m_ast.directives[index];
+        const std::u8string_view source = m_ast.get_source(directive.span);
+        std::optional<ast::Primary> arguments;
+        if (directive.arguments != no_flat_index) {
+            arguments = inflate_primary(directive.arguments);
+        }
+        std::optional<ast::Primary> content;
+        if (directive.content != no_flat_index) {
+            content = inflate_primary(directive.content);
+        }
+        return ast::Directive {
+            span_of(directive.span),
+            source,
+            source.substr(directive.name_offset, directive.name_length),
+            std::move(arguments),
+            std::move(content),
+        };
+    }
+
+    [[nodiscard]]
+    ast::Primary inflate_primary(Flat_Index index)
+    {
+        const Flat_Primary& primary = m_ast.primaries[index];
+        const File_Source_Span span = span_of(primary.span);
+        const std::u8string_view source = m_ast.get_source(primary.span);
+
+        using enum ast::Primary_Kind;
+        switch (primary.kind) {
+        case block:
+        case quoted_string: {
+            ast::Pmr_Vector<ast::Markup_Element> elements { m_memory };
+            inflate_elements(elements, primary.children);
+            return primary.kind == block
+                ? ast::Primary::block(span, source, std::move(elements))
+                : ast::Primary::quoted_string(span, source, std::move(elements));
+        }
+        case group: {
+            ast::Pmr_Vector<ast::Group_Member> members { m_memory };
+            members.reserve(primary.children.size);
+            const Flat_Range range = primary.children;
+            for (Flat_Index i = range.first; i < range.first + range.size; ++i) {
+                members.push_back(inflate_member(i));
+            }
+            return ast::Primary::group(span, source, std::move(members));
+        }
+        case escape: {
+            return ast::Primary::escape(span, source, primary.code_point);
+        }
+        default: {
+            return ast::Primary::basic(primary.kind, span, source);
+        }
+        }
+    }
+
+    [[nodiscard]]
+    ast::Group_Member inflate_member(Flat_Index index)
+    {
+        const Flat_Member& member = m_ast.members[index];
+        switch (member.kind) {
+        case ast::Member_Kind::named: {
+            return ast::Group_Member::named(
+                make_node(inflate_primary(member.name)),
+                make_node(inflate_expression(member.value))
+            );
+        }
+        case ast::Member_Kind::positional: {
+            return ast::Group_Member::positional(make_node(inflate_expression(member.value)));
+        }
+        case ast::Member_Kind::ellipsis: {
+            return ast::Group_Member::ellipsis(
+                span_of(member.span), m_ast.get_source(member.span)
+            );
+        }
+        }
+        COWEL_ASSERT_UNREACHABLE(u8"Invalid member kind.");
+    }
+
+    [[nodiscard]]
+    ast::Expression inflate_expression(Flat_Index index)
+    {
+        const Flat_Expression& expression = m_ast.expressions[index];
+        ast::Expression inner = [&] -> ast::Expression {
+            const Flat_Index inner_index = expression.inner.index;
+            switch (expression.inner.kind) {
+            case Flat_Node_Kind::directive: return inflate_directive(inner_index);
+            case Flat_Node_Kind::primary: return inflate_primary(inner_index);
+            case Flat_Node_Kind::unary_expression: {
+                const Flat_Unary_Expression& unary = m_ast.unary_expressions[inner_index];
+                return ast::Unary_Expression {
+                    make_node(inflate_expression(unary.operand)),
+                    unary.kind,
+                    span_of(unary.span),
+                    m_ast.get_source(unary.span),
+                };
+            }
+            case Flat_Node_Kind::binary_expression: {
+                const Flat_Binary_Expression& binary = m_ast.binary_expressions[inner_index];
+                return ast::Binary_Expression {
+                    make_node(inflate_expression(binary.lhs)),
+                    make_node(inflate_expression(binary.rhs)),
+                    binary.kind,
+                    span_of(binary.span),
+                    m_ast.get_source(binary.span),
+                };
+            }
+            case Flat_Node_Kind::let_expression: {
+                const Flat_Let_Expression& let = m_ast.let_expressions[inner_index];
+                return ast::Let_Expression {
+                    m_ast.get_source(let.name_span),
+                    span_of(let.name_span),
+                    make_node(inflate_expression(let.value)),
+                    span_of(let.span),
+                    m_ast.get_source(let.span),
+                };
+            }
+            case Flat_Node_Kind::expression: break;
+            }
+            COWEL_ASSERT_UNREACHABLE(u8"Invalid expression kind.");
+        }();
+        return ast::Expression {
+            std::move(inner),
+            span_of(expression.span),
+            m_ast.get_source(expression.span),
+        };
+    }
+};
+
+} // namespace
+
+void flatten_ast(Flat_AST& out, const std::span<const ast::Markup_Element> content)
+{
+    out.roots = AST_Flattener { out }.flatten_elements(content);
+}
+
+void inflate_ast(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    const Flat_AST& ast,
+    std::pmr::memory_resource* const memory,
+    GC_Arena* const arena
+)
+{
+    AST_Inflater { ast, memory, arena }.inflate_elements(out, ast.roots);
+}
+
+AST_Cache_Key ast_cache_key(const std::u8string_view source)
+{
+    const std::uint64_t version[] {
+        ast_cache_format_version,
+        COWEL_VERSION_MAJOR,
+        COWEL_VERSION_MINOR,
+        source.length(),
+    };
+    Uint128 hash = fnv1a_128(fnv1a_128_offset_basis, std::as_bytes(std::span { version }));
+    hash = fnv1a_128(hash, std::as_bytes(std::span { source }));
+
+    static constexpr char8_t hex_digits[] = u8"0123456789abcdef";
+    AST_Cache_Key::array_type result {};
+    for (std::size_t i = 0; i < ast_cache_key_length; ++i) {
+        result[ast_cache_key_length - 1 - i] = hex_digits[std::size_t(hash & 0xf)];
+        hash >>= 4;
+    }
+    return { result, ast_cache_key_length };
+}
+
+void serialize_flat_ast(std::pmr::vector<std::byte>& out, const Flat_AST& ast)
+{
+    COWEL_ASSERT(out.size() % node_array_alignment == 0);
+
+    Flat_AST_Header header {
+        .magic = flat_ast_magic,
+        .format_version = ast_cache_format_version,
+        .byte_order = byte_order_mark,
+        .source_length = ast.source.length(),
+        .roots = ast.roots,
+        .node_counts = {},
+        .node_sizes = {},
+    };
+    std::size_t i = 0;
+    for_each_node_array(ast, [&]<typename T>(const std::pmr::vector<T>& nodes) {
+        COWEL_ASSERT(nodes.size() <= std::numeric_limits<std::uint32_t>::max());
+        header.node_counts[i] = std::uint32_t(nodes.size());
+        header.node_sizes[i] = std::uint8_t(sizeof(T));
+        ++i;
+    });
+
+    append_bytes(out, &header, sizeof(header));
+    for_each_node_array(ast, [&]<typename T>(const std::pmr::vector<T>& nodes) {
+        append_bytes(out, nodes.data(), nodes.size() * sizeof(T));
+    });
+}
+
+bool deserialize_flat_ast(Flat_AST& out, const std::span<const std::byte> data)
+{
+    const std::size_t source_length = out.source.length();
+    Flat_AST_Header header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != flat_ast_magic //
+        || header.format_version != ast_cache_format_version
+        || header.byte_order != byte_order_mark //
+        || header.source_length != source_length) {
+        return false;
+    }
+
+    out.clear();
+    out.roots = header.roots;
+
+    std::size_t offset = sizeof(header);
+    std::size_t i = 0;
+    bool success = true;
+    for_each_node_array(out, [&]<typename T>(std::pmr::vector<T>& nodes) {
+        const std::uint32_t count = header.node_counts[i];
+        const bool valid_size = header.node_sizes[i] == sizeof(T);
+        ++i;
+        if (!success || !valid_size) {
+            success = false;
+            return;
+        }
+        const std::size_t size = std::size_t(count) * sizeof(T);
+        if (size > data.size() - offset) {
+            success = false;
+            return;
+        }
+        nodes.resize(count);
+        if (size != 0) {
+            std::memcpy(nodes.data(), data.data() + offset, size);
+        }
+        offset = align_node_array_offset(offset + size);
+    });
+    if (!success || offset != data.size()) {
+        return false;
+    }
+
+    return Flat_AST_Validator { out, source_length, out.element_refs.get_allocator().resource() }();
+}
+
+bool lex_and_parse_and_build_cached(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    const std::u8string_view source,
+    const Line_Table* const lines,
+    const File_Id file,
+    AST_Cache* const cache,
+    std::pmr::memory_resource* const memory,
+    GC_Arena* const arena,
+    const Parse_Error_Consumer on_error
+)
+{
+    const auto parse = [&] -> bool {
+        if (arena) {
+            return lines
+                ? lex_and_parse_and_build(out, buffers, source, *lines, file, *arena, on_error)
+                : lex_and_parse_and_build(out, buffers, source, file, *arena, on_error);
+        }
+        return lines ? lex_and_parse_and_build(out, buffers, source, *lines, file, memory, on_error)
+                     : lex_and_parse_and_build(out, buffers, source, file, memory, on_error);
+    };
+    // Flat spans are limited to 32 bits, so larger documents are never cached.
+    if (!cache || source.length() > std::numeric_limits<std::uint32_t>::max()) {
+        return parse();
+    }
+
+    const AST_Cache_Key key = ast_cache_key(source);
+    Flat_AST flat { memory };
+    flat.source = source;
+    flat.file = file;
+
+    if (const std::span<const std::byte> cached = cache->load(key.as_string());
+        !cached.empty() && deserialize_flat_ast(flat, cached)) {
+        inflate_ast(out, flat, arena ? arena->get_memory() : memory, arena);
+        return true;
+    }
+
+    const std::size_t old_size = out.size();
+    if (!parse()) {
+        return false;
+    }
+    flat.clear();
+    flatten_ast(flat, std::span { out }.subspan(old_size));
+
+    std::pmr::vector<std::byte> bytes { memory };
+    serialize_flat_ast(bytes, flat);
+    cache->store(key.as_string(), bytes);
+    return true;
+}
+
+} // namespace cowel
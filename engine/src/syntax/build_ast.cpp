@@ -6,16 +6,19 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "cowel/util/assert.hpp"
 #include "cowel/util/chars.hpp"
 #include "cowel/util/from_chars.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/source_position.hpp"
 #include "cowel/util/unicode.hpp"
 
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/string_kind.hpp"
 
 #include "cowel/syntax/ast.hpp"
@@ -33,8 +36,8 @@ Primary Primary::basic(Primary_Kind kind, File_Source_Span source_span, std::u8s
     using enum ast::Primary_Kind;
     switch (kind) {
     case unit_literal:
-    case null_literal:
-    case bool_literal: return Primary { kind, source_span, source, std::monostate {} };
+    case null_literal: return Primary { kind, source_span, source, std::monostate {} };
+    case bool_literal: return Primary { kind, source_span, source, source == u8"true"sv };
 
     case text: {
         const auto string_kind = is_all_ascii(source) ? String_Kind::ascii : String_Kind::unicode;
@@ -203,6 +206,42 @@ Primary Primary::group(
     return Primary { Primary_Kind::group, source_span, source, std::move(members) };
 }
 
+Primary Primary::folded_bool(
+    const File_Source_Span source_span,
+    const std::u8string_view source,
+    const bool value
+)
+{
+    return Primary { Primary_Kind::bool_literal, source_span, source, value, String_Kind::unknown,
+                     true };
+}
+
+Primary Primary::folded_integer(
+    const File_Source_Span source_span,
+    const std::u8string_view source,
+    const Big_Int& value
+)
+{
+    return Primary { Primary_Kind::int_literal, source_span, source, value, String_Kind::unknown,
+                     true };
+}
+
+Primary Primary::folded_float(
+    const File_Source_Span source_span,
+    const std::u8string_view source,
+    const Float value
+)
+{
+    return Primary {
+        Primary_Kind::decimal_float_literal,
+        source_span,
+        source,
+        Parsed_Float { .value = value, .status = Float_Literal_Status::ok },
+        String_Kind::unknown,
+        true,
+    };
+}
+
 Group_Member Group_Member::ellipsis(File_Source_Span source_span, std::u8string_view source)
 {
     COWEL_DEBUG_ASSERT(source == u8"...");
@@ -219,16 +258,24 @@ Group_Member Group_Member::ellipsis(File_Source_Span source_span, std::u8string_
 
 Group_Member Group_Member::named(Primary&& name, Expression&& value)
 {
+    return named(gc_ref_make<Primary>(std::move(name)), gc_ref_make<Expression>(std::move(value)));
+}
+
+Group_Member Group_Member::named(GC_Ref<Primary> name, GC_Ref<Expression> value)
+{
+    COWEL_ASSERT(name && value);
     COWEL_DEBUG_ASSERT(
-        name.get_kind() == ast::Primary_Kind::unquoted_member_name
-        || name.get_kind() == ast::Primary_Kind::quoted_string
+        name->get_kind() == ast::Primary_Kind::unquoted_member_name
+        || name->get_kind() == ast::Primary_Kind::quoted_string
     );
+    const File_Source_Span source_span = value->get_source_span();
+    const std::u8string_view source = value->get_source();
     // clang-format off
     return {
-        value.get_source_span(),
-        value.get_source(),
-        gc_ref_make<Primary>(std::move(name)),
-        gc_ref_make<Expression>(std::move(value)),
+        source_span,
+        source,
+        std::move(name),
+        std::move(value),
         Member_Kind::named,
     };
     // clang-format on
@@ -237,13 +284,21 @@ Group_Member Group_Member::named(Primary&& name, Expression&& value)
 [[nodiscard]]
 Group_Member Group_Member::positional(Expression&& value)
 {
-    const File_Source_Span source_span = value.get_source_span();
+    return positional(gc_ref_make<Expression>(std::move(value)));
+}
+
+[[nodiscard]]
+Group_Member Group_Member::positional(GC_Ref<Expression> value)
+{
+    COWEL_ASSERT(value);
+    const File_Source_Span source_span = value->get_source_span();
+    const std::u8string_view source = value->get_source();
     // clang-format off
     return {
         source_span,
-        value.get_source(),
+        source,
         {},
-        gc_ref_make<Expression>(std::move(value)),
+        std::move(value),
         Member_Kind::positional,
     };
     // clang-format on
@@ -352,6 +407,14 @@ void Primary::assert_validity() const
 {
     COWEL_ASSERT(!m_source_span.empty());
     COWEL_ASSERT(m_source.length() == m_source_span.length);
+    if (m_folded) {
+        // The source is that of the folded expression, not a spelling of the literal.
+        COWEL_ASSERT(
+            m_kind == Primary_Kind::bool_literal || m_kind == Primary_Kind::int_literal
+            || m_kind == Primary_Kind::decimal_float_literal
+        );
+        return;
+    }
 
     switch (m_kind) {
     case Primary_Kind::unit_literal: {
@@ -417,13 +480,15 @@ Primary::Primary(
     File_Source_Span source_span,
     std::u8string_view source,
     Extra_Variant&& extra,
-    String_Kind string_kind
+    String_Kind string_kind,
+    bool folded
 )
     : m_kind { kind }
     , m_string_kind { string_kind }
     , m_source_span { source_span }
     , m_source { source }
     , m_extra { std::move(extra) }
+    , m_folded { folded }
 {
     assert_validity();
 }
@@ -512,8 +577,11 @@ private:
     const string_view_type m_source;
     const File_Id m_file;
     const std::span<const Token> m_tokens;
-    const std::span<const CST_Instruction> m_instructions;
+    std::span<const CST_Instruction> m_instructions;
     std::pmr::memory_resource* const m_memory;
+    const Line_Table& m_lines;
+    /// @brief If not null, the arena in which expressions are allocated.
+    GC_Arena* const m_arena;
 
     std::size_t m_token_index = 0;
     std::size_t m_instruction_index = 0;
@@ -521,22 +589,36 @@ private:
 public:
     AST_Builder(
         string_view_type source,
+        const Line_Table& lines,
         File_Id file,
         std::span<const Token> tokens,
         std::span<const CST_Instruction> instructions,
-        std::pmr::memory_resource* memory
+        std::pmr::memory_resource* memory,
+        GC_Arena* arena = nullptr
     )
         : m_source { source }
         , m_file { file }
         , m_tokens { tokens }
         , m_instructions { instructions }
         , m_memory { memory }
+        , m_lines { lines }
+        , m_arena { arena }
+    {
+    }
+
+    /// @brief Allocates `node` within the arena if there is one,
+    /// or as a reference-counted node otherwise.
+    template <typename T>
+        requires(!std::is_lvalue_reference_v<T>)
+    [[nodiscard]]
+    GC_Ref<T> make_node(T&& node)
     {
-        COWEL_ASSERT(!instructions.empty());
+        return m_arena ? m_arena->make<T>(std::move(node)) : gc_ref_make<T>(std::move(node));
     }
 
     void build_document(ast::Pmr_Vector<ast::Markup_Element>& out)
     {
+        COWEL_ASSERT(!m_instructions.empty());
         const CST_Instruction push_doc = pop_instruction();
         COWEL_ASSERT(push_doc.kind == CST_Instruction_Kind::push_document);
         out.reserve(out.size() + push_doc.n);
@@ -546,6 +628,22 @@ public:
         }
     }
 
+    /// @brief Builds a single top-level markup element from `instructions`,
+    /// as obtained from `parse_incrementally`.
+    /// The previously given instructions are discarded.
+    void build_markup_element(
+        ast::Pmr_Vector<ast::Markup_Element>& out,
+        std::size_t first_token,
+        std::span<const CST_Instruction> instructions
+    )
+    {
+        m_token_index = first_token;
+        m_instructions = instructions;
+        m_instruction_index = 0;
+        append_markup_element(out);
+        COWEL_ASSERT(eof());
+    }
+
 private:
     [[nodiscard]]
     std::u8string_view extract(const Source_Span& span) const
@@ -553,6 +651,12 @@ private:
         return m_source.substr(span.begin, span.length);
     }
 
+    [[nodiscard]]
+    Source_Span location_of(const Token& token) const
+    {
+        return token.location(m_lines);
+    }
+
     void advance_by_tokens(std::size_t n)
     {
         COWEL_ASSERT(m_token_index + n <= m_tokens.size());
@@ -626,7 +730,7 @@ private:
             push.kind == CST_Instruction_Kind::push_expression_splice
             || push.kind == CST_Instruction_Kind::push_expression_line_splice
         );
-        const Source_Span expression_splice_begin = peek_token().location;
+        const Source_Span expression_splice_begin = location_of(peek_token());
         advance_by_tokens(1);
 
         ignore_skips();
@@ -648,7 +752,7 @@ private:
             pop.kind == CST_Instruction_Kind::pop_expression_splice
             || pop.kind == CST_Instruction_Kind::pop_expression_line_splice
         );
-        const Source_Span expression_splice_end = peek_token().location;
+        const Source_Span expression_splice_end = location_of(peek_token());
         advance_by_tokens(1);
 
         // The point here is to attach the leading `\(` and trailing `)`
@@ -682,7 +786,7 @@ private:
         COWEL_ASSERT(kind);
 
         const Token token = peek_token();
-        const File_Source_Span span { token.location, m_file };
+        const File_Source_Span span { location_of(token), m_file };
         const std::u8string_view source = extract(span);
 
         auto result = *kind == ast::Primary_Kind::escape
@@ -709,7 +813,7 @@ private:
                 && instruction.kind == CST_Instruction_Kind::push_expr_directive_call)
         );
 
-        const auto initial_pos = peek_token().location;
+        const auto initial_pos = location_of(peek_token());
         advance_by_tokens(1);
 
         if (kind == Directive_Kind::call) {
@@ -748,7 +852,7 @@ private:
         }();
         const std::u8string_view name = extract(name_span);
         const std::size_t source_end
-            = m_token_index >= m_tokens.size() ? m_source.size() : peek_token().location.begin;
+            = m_token_index >= m_tokens.size() ? m_source.size() : peek_token().begin;
         const std::size_t source_length = source_end - initial_pos.begin;
         const auto source_span = raw_name_span.with_length(source_length);
         const std::u8string_view source = extract(source_span);
@@ -767,7 +871,7 @@ private:
             return {};
         }
 
-        const auto initial_pos = peek_token().location;
+        const auto initial_pos = location_of(peek_token());
         pop_instruction();
         advance_by_tokens(1);
 
@@ -799,7 +903,7 @@ private:
         }
 
         const std::size_t end_pos
-            = m_token_index >= m_tokens.size() ? m_source.size() : peek_token().location.begin;
+            = m_token_index >= m_tokens.size() ? m_source.size() : peek_token().begin;
         const File_Source_Span source_span {
             initial_pos,
             end_pos - initial_pos.begin,
@@ -814,7 +918,7 @@ private:
         const CST_Instruction member_instruction = pop_instruction();
         ignore_skips();
 
-        const auto initial_pos = peek_token().location;
+        const auto initial_pos = location_of(peek_token());
 
         switch (member_instruction.kind) {
         case CST_Instruction_Kind::push_named_member: {
@@ -849,7 +953,9 @@ private:
             ignore_skips();
             const auto pop_instruction = this->pop_instruction();
             COWEL_ASSERT(pop_instruction.kind == CST_Instruction_Kind::pop_named_member);
-            return ast::Group_Member::named(std::move(name), std::move(expression));
+            return ast::Group_Member::named(
+                make_node(std::move(name)), make_node(std::move(expression))
+            );
         }
 
         case CST_Instruction_Kind::push_positional_member: {
@@ -857,7 +963,7 @@ private:
             ignore_skips();
             const auto pop_instruction = this->pop_instruction();
             COWEL_ASSERT(pop_instruction.kind == CST_Instruction_Kind::pop_positional_member);
-            return ast::Group_Member::positional(std::move(expression));
+            return ast::Group_Member::positional(make_node(std::move(expression)));
         }
 
         case CST_Instruction_Kind::push_ellipsis_argument: {
@@ -869,7 +975,7 @@ private:
                     goto done;
                 }
                 case CST_Instruction_Kind::ellipsis: {
-                    source_span = File_Source_Span { peek_token().location, m_file };
+                    source_span = File_Source_Span { location_of(peek_token()), m_file };
                     advance_by_tokens(1);
                     break;
                 }
@@ -1101,7 +1207,7 @@ private:
         return ast::Let_Expression {
             name,
             name_span,
-            gc_ref_make<ast::Expression>(std::move(value)),
+            make_node<ast::Expression>(std::move(value)),
             source_span,
             extract(source_span),
         };
@@ -1160,8 +1266,8 @@ private:
         const auto source_span = make_file_span(lhs.get_source_span(), rhs.get_source_span());
 
         return ast::Binary_Expression {
-            gc_ref_make<ast::Expression>(std::move(lhs)),
-            gc_ref_make<ast::Expression>(std::move(rhs)),
+            make_node<ast::Expression>(std::move(lhs)),
+            make_node<ast::Expression>(std::move(rhs)),
             instruction_kind_binary_kind(push_kind),
             source_span,
             extract(source_span),
@@ -1192,7 +1298,7 @@ private:
         const CST_Instruction push = pop_instruction();
         COWEL_ASSERT(push.kind == push_kind);
         COWEL_DEBUG_ASSERT(cst_instruction_kind_advances(push_kind));
-        const Source_Span push_location = peek_token().location;
+        const Source_Span push_location = location_of(peek_token());
         advance_by_tokens(1);
         ignore_skips();
 
@@ -1201,12 +1307,12 @@ private:
         const CST_Instruction pop = pop_instruction();
         COWEL_ASSERT(pop.kind == pop_kind);
         COWEL_DEBUG_ASSERT(!cst_instruction_kind_advances(pop.kind));
-        const Source_Span pop_location = peek_token().location;
+        const Source_Span pop_location = location_of(peek_token());
 
         const auto location = make_file_span(push_location, pop_location);
 
         return ast::Unary_Expression {
-            gc_ref_make<ast::Expression>(std::move(operand)),
+            make_node<ast::Expression>(std::move(operand)),
             unary_kind,
             location,
             extract(location),
@@ -1254,7 +1360,7 @@ private:
             return {};
         }
 
-        const auto initial_pos = peek_token().location;
+        const auto initial_pos = location_of(peek_token());
         pop_instruction();
         advance_by_tokens(1);
 
@@ -1271,7 +1377,7 @@ private:
         const auto closing_token = m_tokens[m_token_index];
         advance_by_tokens(1);
 
-        const auto source_span = make_file_span(initial_pos, closing_token.location);
+        const auto source_span = make_file_span(initial_pos, location_of(closing_token));
         return push_kind == CST_Instruction_Kind::push_block
             ? ast::Primary::block(source_span, extract(source_span), std::move(content))
             : ast::Primary::quoted_string(source_span, extract(source_span), std::move(content));
@@ -1293,6 +1399,19 @@ private:
 
 } // namespace
 
+void build_ast(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    const std::u8string_view source,
+    const Line_Table& lines,
+    const File_Id file,
+    const std::span<const Token> tokens,
+    const std::span<const CST_Instruction> instructions,
+    std::pmr::memory_resource* const memory
+)
+{
+    AST_Builder { source, lines, file, tokens, instructions, memory }.build_document(out);
+}
+
 void build_ast(
     ast::Pmr_Vector<ast::Markup_Element>& out,
     const std::u8string_view source,
@@ -1302,7 +1421,8 @@ void build_ast(
     std::pmr::memory_resource* const memory
 )
 {
-    AST_Builder { source, file, tokens, instructions, memory }.build_document(out);
+    const Line_Table lines { source, memory };
+    build_ast(out, source, lines, file, tokens, instructions, memory);
 }
 
 ast::Pmr_Vector<ast::Markup_Element> build_ast(
@@ -1318,9 +1438,85 @@ ast::Pmr_Vector<ast::Markup_Element> build_ast(
     return result;
 }
 
+namespace {
+
+/// @brief Returns an upper bound for the amount of markup elements
+/// at the top level of the document with the given tokens.
+/// This is used to reserve the output of incremental building,
+/// which would otherwise be reallocated repeatedly for large documents.
+[[nodiscard]]
+std::size_t max_top_level_markup_elements(const std::span<const Token> tokens)
+{
+    std::size_t result = 0;
+    std::size_t depth = 0;
+    for (const Token& token : tokens) {
+        switch (token.kind) {
+        case Token_Kind::brace_left:
+        case Token_Kind::parenthesis_left: {
+            ++depth;
+            break;
+        }
+        case Token_Kind::brace_right:
+        case Token_Kind::parenthesis_right: {
+            depth -= depth != 0;
+            break;
+        }
+        // Expression splices are closed by a separate `)` token.
+        case Token_Kind::expression_splice: {
+            result += depth == 0;
+            ++depth;
+            break;
+        }
+        case Token_Kind::document_text:
+        case Token_Kind::escape:
+        case Token_Kind::line_comment:
+        case Token_Kind::block_comment:
+        case Token_Kind::directive_splice_name:
+        case Token_Kind::expression_line_splice: {
+            result += depth == 0;
+            break;
+        }
+        default: break;
+        }
+    }
+    return result;
+}
+
+[[nodiscard]]
+bool do_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    std::pmr::vector<CST_Instruction>& instructions,
+    const std::u8string_view source,
+    const Line_Table& lines,
+    const std::span<const Token> tokens,
+    const File_Id file,
+    std::pmr::memory_resource* const memory,
+    const Parse_Error_Consumer on_error,
+    GC_Arena* const arena = nullptr
+)
+{
+    const std::size_t initial_size = out.size();
+    out.reserve(initial_size + max_top_level_markup_elements(tokens));
+    AST_Builder builder { source, lines, file, tokens, {}, memory, arena };
+    const auto on_element
+        = [&](std::size_t first_token, std::span<const CST_Instruction> element_instructions) {
+              builder.build_markup_element(out, first_token, element_instructions);
+          };
+    if (parse_incrementally(instructions, source, tokens, on_element, on_error)) {
+        return true;
+    }
+    // Elements that were built prior to the first error are discarded,
+    // so that a failed parse has no effect on the output, just like with a separate parse.
+    out.erase(out.begin() + std::ptrdiff_t(initial_size), out.end());
+    return false;
+}
+
+} // namespace
+
 bool parse_and_build(
     ast::Pmr_Vector<ast::Markup_Element>& out,
     const std::u8string_view source,
+    const Line_Table& lines,
     const std::span<const Token> tokens,
     const File_Id file,
     std::pmr::memory_resource* const memory,
@@ -1328,26 +1524,124 @@ bool parse_and_build(
 )
 {
     std::pmr::vector<CST_Instruction> instructions { memory };
-    if (parse(instructions, tokens, on_error)) {
-        build_ast(out, source, file, tokens, instructions, memory);
-        return true;
+    return do_parse_and_build(out, instructions, source, lines, tokens, file, memory, on_error);
+}
+
+bool parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    const std::u8string_view source,
+    const std::span<const Token> tokens,
+    const File_Id file,
+    std::pmr::memory_resource* const memory,
+    const Parse_Error_Consumer on_error
+)
+{
+    const Line_Table lines { source, memory };
+    return parse_and_build(out, source, lines, tokens, file, memory, on_error);
+}
+
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    const std::u8string_view source,
+    const Line_Table& lines,
+    const File_Id file,
+    std::pmr::memory_resource* const memory,
+    const Parse_Error_Consumer on_error
+)
+{
+    buffers.tokens.clear();
+    if (!lex(buffers.tokens, source, on_error)) {
+        return false;
     }
-    return false;
+    return do_parse_and_build(
+        out, buffers.instructions, source, lines, buffers.tokens, file, memory, on_error
+    );
 }
 
 bool lex_and_parse_and_build(
     ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
     const std::u8string_view source,
     const File_Id file,
     std::pmr::memory_resource* const memory,
     const Parse_Error_Consumer on_error
 )
 {
-    std::pmr::vector<Token> tokens { memory };
-    if (!lex(tokens, source, on_error)) {
+    buffers.tokens.clear();
+    if (!lex(buffers.tokens, source, on_error)) {
         return false;
     }
-    return parse_and_build(out, source, tokens, file, memory, on_error);
+    const Line_Table lines { source, memory };
+    return do_parse_and_build(
+        out, buffers.instructions, source, lines, buffers.tokens, file, memory, on_error
+    );
+}
+
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    const std::u8string_view source,
+    const Line_Table& lines,
+    const File_Id file,
+    GC_Arena& arena,
+    const Parse_Error_Consumer on_error
+)
+{
+    buffers.tokens.clear();
+    if (!lex(buffers.tokens, source, on_error)) {
+        return false;
+    }
+    return do_parse_and_build(
+        out, buffers.instructions, source, lines, buffers.tokens, file, arena.get_memory(),
+        on_error, &arena
+    );
+}
+
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    Parse_Buffers& buffers,
+    const std::u8string_view source,
+    const File_Id file,
+    GC_Arena& arena,
+    const Parse_Error_Consumer on_error
+)
+{
+    buffers.tokens.clear();
+    if (!lex(buffers.tokens, source, on_error)) {
+        return false;
+    }
+    // The line table is only needed while building, so it is not allocated within the arena.
+    const Line_Table lines { source, buffers.tokens.get_allocator().resource() };
+    return do_parse_and_build(
+        out, buffers.instructions, source, lines, buffers.tokens, file, arena.get_memory(),
+        on_error, &arena
+    );
+}
+
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    const std::u8string_view source,
+    const Line_Table& lines,
+    const File_Id file,
+    std::pmr::memory_resource* const memory,
+    const Parse_Error_Consumer on_error
+)
+{
+    Parse_Buffers buffers { memory };
+    return lex_and_parse_and_build(out, buffers, source, lines, file, memory, on_error);
+}
+
+bool lex_and_parse_and_build(
+    ast::Pmr_Vector<ast::Markup_Element>& out,
+    const std::u8string_view source,
+    const File_Id file,
+    std::pmr::memory_resource* const memory,
+    const Parse_Error_Consumer on_error
+)
+{
+    Parse_Buffers buffers { memory };
+    return lex_and_parse_and_build(out, buffers, source, file, memory, on_error);
 }
 
 } // namespace cowel
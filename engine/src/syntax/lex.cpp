@@ -1,5 +1,6 @@
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -7,8 +8,10 @@
 
 #include "cowel/util/ascii_algorithm.hpp"
 #include "cowel/util/assert.hpp"
+#include "cowel/util/byte_scan.hpp"
 #include "cowel/util/char_sequence_factory.hpp"
 #include "cowel/util/chars.hpp"
+#include "cowel/util/line_table.hpp"
 
 #include "cowel/diagnostic.hpp"
 #include "cowel/fwd.hpp"
@@ -160,8 +163,16 @@ private:
     const std::u8string_view m_source;
     const Lex_Error_Consumer m_on_error;
 
-    Source_Position m_pos {};
+    std::size_t m_pos = 0;
+    /// @brief The amount of blocks and quoted strings which are currently being lexed.
+    std::size_t m_depth = 0;
     bool m_success = true;
+    /// @brief Set once `max_nesting_depth` has been exceeded,
+    /// after which the remainder of the source is skipped and no more errors are reported.
+    bool m_too_deep = false;
+    /// @brief Only created once the first error is reported,
+    /// so that line and column numbers don't need to be tracked during lexing.
+    std::optional<Line_Table> m_lines;
 
 public:
     [[nodiscard]]
@@ -191,49 +202,60 @@ private:
                 const char8_t actual_first = peek();
                 COWEL_ASSERT(expected_first == actual_first);
             }
-            COWEL_ASSERT(m_pos.begin + length <= m_source.length());
+            COWEL_ASSERT(m_pos + length <= m_source.length());
         }
-        m_out.push_back({ kind, code_point, Source_Span { m_pos, length } });
+        m_out.push_back({
+            .kind = kind,
+            .code_point = code_point,
+            .begin = std::uint32_t(m_pos),
+            .length = std::uint32_t(length),
+        });
     }
 
-    void error(const Source_Span& pos, Char_Sequence8 message)
+    void error(std::size_t begin, std::size_t length, Char_Sequence8 message)
     {
+        if (m_too_deep) {
+            return;
+        }
         if (m_on_error) {
-            m_on_error(diagnostic::parse, pos, message);
+            if (!m_lines) {
+                m_lines.emplace(m_source, m_out.get_allocator().resource());
+            }
+            m_on_error(diagnostic::parse, m_lines->span_at(begin, length), message);
         }
         m_success = false;
     }
 
     void advance_by(std::size_t n)
     {
-        COWEL_DEBUG_ASSERT(m_pos.begin + n <= m_source.size());
-        advance(m_pos, m_source.substr(m_pos.begin, n));
+        COWEL_DEBUG_ASSERT(m_pos + n <= m_source.size());
+        m_pos += n;
     }
 
     [[nodiscard]]
     std::u8string_view peek_all() const
     {
-        COWEL_DEBUG_ASSERT(m_pos.begin <= m_source.size());
-        return m_source.substr(m_pos.begin);
+        COWEL_DEBUG_ASSERT(m_pos <= m_source.size());
+        return m_source.substr(m_pos);
     }
 
     [[nodiscard]]
     char8_t peek() const
     {
         COWEL_ASSERT(!eof());
-        return m_source[m_pos.begin];
+        return m_source[m_pos];
     }
 
     [[nodiscard]]
     bool eof() const
     {
-        return m_pos.begin == m_source.length();
+        return m_pos == m_source.length();
     }
 
     [[nodiscard]]
     bool peek(char8_t c) const
     {
-        return !eof() && m_source[m_pos.begin] == c;
+        return !eof() && m_source[m_pos] == c;
     }
 
     [[nodiscard]]
@@ -276,44 +298,40 @@ private:
             return true;
         }
 
+        // Only a handful of bytes can end a run of text,
+        // so we quickly skip past anything else.
+        // Line breaks are of no interest here because tokens don't store line numbers.
+        const std::u8string_view stop_bytes //
+            = context == Content_Context::block         ? u8"\\{}"sv
+            : context == Content_Context::quoted_string ? u8"\\\""sv
+                                                        : u8"\\"sv;
+
         const std::u8string_view remainder = peek_all();
         std::size_t text_length = 0;
-        for (; text_length < remainder.length(); ++text_length) {
-            const char8_t c = remainder[text_length];
-            if (c == u8'\\') {
+        while (true) {
+            text_length += find_first_of_bytes(remainder.substr(text_length), stop_bytes);
+            if (text_length == remainder.length()) {
                 break;
             }
-            switch (context) {
-            case Content_Context::document: {
-                // At the document level, we don't care about brace mismatches,
-                // commas, etc.
+            // Within blocks, braces need to be balanced,
+            // and only an unmatched closing brace ends the block.
+            // At the document level and within strings, braces are not stop bytes.
+            const char8_t c = remainder[text_length];
+            if (c == u8'{') {
+                ++brace_level;
+                ++text_length;
                 continue;
             }
-            case Content_Context::quoted_string: {
-                // Within strings, braces have no special meaning,
-                // but an unescaped quote ends the string.
-                if (c == u8'"') {
-                    goto done;
-                }
+            if (c == u8'}' && brace_level != 0) {
+                --brace_level;
+                ++text_length;
                 continue;
             }
-            case Content_Context::block: {
-                if (c == u8'{') {
-                    ++brace_level;
-                    break;
-                }
-                if (c == u8'}') {
-                    if (brace_level == 0) {
-                        goto done;
-                    }
-                    --brace_level;
-                    continue;
-                }
-            }
-            }
+            // An unescaped quote in a string, an unmatched closing brace in a block,
+            // or a backslash in any context.
+            break;
         }
 
-    done:
         if (text_length == 0) {
             return false;
         }
@@ -337,16 +355,16 @@ private:
 
         if (escape.length == 1) {
             COWEL_DEBUG_ASSERT(escape.is_reserved);
-            error(Source_Span { m_pos, 1 }, u8"Backslash at the end of the file is not valid."sv);
+            error(m_pos, 1, u8"Backslash at the end of the file is not valid."sv);
             emit(Token_Kind::reserved_escape, escape.length);
         }
         else if (escape.is_reserved) {
             error(
-                Source_Span { m_pos, escape.length },
+                m_pos, escape.length,
                 joined_char_sequence(
                     {
                         u8"Expected comment or escape sequence, but got '"sv,
-                        m_source.substr(m_pos.begin, escape.length),
+                        m_source.substr(m_pos, escape.length),
                         u8"' following a backslash."sv,
                     }
                 )
@@ -366,14 +384,14 @@ private:
                 }
                 case Expand_Escape_Error_Code::nonscalar: {
                     error(
-                        Source_Span { m_pos, escape.length },
+                        m_pos, escape.length,
                         u8"Numeric escape does not denote a Unicode scalar value."sv
                     );
                     break;
                 }
                 case Expand_Escape_Error_Code::bad_name: {
                     error(
-                        Source_Span { m_pos, escape.length },
+                        m_pos, escape.length,
                         u8"Named escape does not refer to a known Unicode character."sv
                     );
                     break;
@@ -447,8 +465,8 @@ private:
         if (const Comment_Result c = match_block_comment(remainder)) {
             COWEL_ASSERT(remainder.starts_with(u8"\\*"sv));
             if (!c.is_terminated) {
-                COWEL_ASSERT(m_pos.begin + c.length == m_source.length());
-                error(Source_Span { m_pos, 2 }, u8"Unterminated block comment."sv);
+                COWEL_ASSERT(m_pos + c.length == m_source.length());
+                error(m_pos, 2, u8"Unterminated block comment."sv);
                 advance_by(c.length);
                 return true;
             }
@@ -502,12 +520,12 @@ private:
             return false;
         }
 
-        const Source_Position initial_pos = m_pos;
+        const std::size_t initial_pos = m_pos;
         emit(Token_Kind::expression_splice, 2);
         advance_by(2);
         if (!consume_group_content(1, Group_Content_Terminator::parenthesis)) {
             error(
-                Source_Span { initial_pos, 2 },
+                initial_pos, 2,
                 u8"No matching ')'. This expression splice is unterminated."sv
             );
         }
@@ -671,7 +689,7 @@ private:
                 continue;
             }
             case u8'\\': {
-                const Source_Position initial_pos = m_pos;
+                const std::size_t initial_pos = m_pos;
                 const std::size_t initial_size = m_out.size();
                 consume_backslash_prefixed();
                 if (initial_size == m_out.size()) {
@@ -680,7 +698,7 @@ private:
                 const Token_Kind kind = m_out[initial_size].kind;
                 if (kind != Token_Kind::line_comment && kind != Token_Kind::block_comment) {
                     error(
-                        Source_Span { initial_pos, 1 },
+                        initial_pos, 1,
                         u8"Only comments are permitted after a backslash in argument groups."sv
                     );
                     return false;
@@ -720,7 +738,7 @@ private:
             }
             const bool any_matched = expect_identifier_or_keyword();
             if (!any_matched) {
-                error(Source_Span { m_pos, 1 }, u8"Unable to form a token."sv);
+                error(m_pos, 1, u8"Unable to form a token."sv);
                 // FIXME: this should do a Unicode decode to avoid slicing code points
                 emit(Token_Kind::error, 1);
                 advance_by(1);
@@ -732,11 +750,11 @@ private:
 
     void consume_group()
     {
-        const Source_Position initial_pos = m_pos;
+        const std::size_t initial_pos = m_pos;
         COWEL_ASSERT(expect_and_emit(u8'(', Token_Kind::parenthesis_left));
         if (!consume_group_content(1, Group_Content_Terminator::parenthesis)) {
             error(
-                Source_Span { initial_pos, 1 },
+                initial_pos, 1,
                 u8"No matching ')'. This argument group is unterminated."sv
             );
         }
@@ -758,7 +776,7 @@ private:
 
         const Common_Number_Result result = match_number(remainder.substr(0, reserved_length));
         if (!result || result.erroneous || result.length != reserved_length) {
-            error(Source_Span { m_pos, reserved_length }, u8"Invalid numeric literal."sv);
+            error(m_pos, reserved_length, u8"Invalid numeric literal."sv);
             emit(Token_Kind::reserved_number, reserved_length);
             advance_by(reserved_length);
             return;
@@ -792,7 +810,7 @@ private:
         if (length == 0) {
             return false;
         }
-        const std::u8string_view match = m_source.substr(m_pos.begin, length);
+        const std::u8string_view match = m_source.substr(m_pos, length);
 
         if (match == u8"unit"sv) {
             emit(Token_Kind::unit, length);
@@ -830,29 +848,52 @@ private:
         return true;
     }
 
+    /// @brief Enters a block or quoted string whose opening character is at `initial_pos`.
+    /// If that would exceed `max_nesting_depth`, reports an error and skips the rest of the source,
+    /// since the end of the construct cannot be found without lexing (and recursing into) it.
+    /// @returns `true` iff the construct was entered.
+    [[nodiscard]]
+    bool try_enter_nested(const std::size_t initial_pos)
+    {
+        if (m_depth < max_nesting_depth) {
+            ++m_depth;
+            return true;
+        }
+        error(initial_pos, 1, u8"Blocks and quoted strings are nested too deeply."sv);
+        m_too_deep = true;
+        advance_by(m_source.length() - m_pos);
+        return false;
+    }
+
     void consume_quoted_string()
     {
-        const auto initial_pos = m_pos;
+        const std::size_t initial_pos = m_pos;
         COWEL_ASSERT(expect_and_emit(u8'"', Token_Kind::string_quote));
+        if (!try_enter_nested(initial_pos)) {
+            return;
+        }
 
         consume_markup_sequence(Content_Context::quoted_string);
+        --m_depth;
 
         if (!expect_and_emit(u8'"', Token_Kind::string_quote)) {
-            error(
-                Source_Span { initial_pos, 1 }, u8"No matching '\"'. This string is unterminated."sv
-            );
+            error(initial_pos, 1, u8"No matching '\"'. This string is unterminated."sv);
         }
     }
 
     void consume_block()
     {
-        const auto initial_pos = m_pos;
+        const std::size_t initial_pos = m_pos;
         COWEL_ASSERT(expect_and_emit(u8'{', Token_Kind::brace_left));
+        if (!try_enter_nested(initial_pos)) {
+            return;
+        }
 
         consume_markup_sequence(Content_Context::block);
+        --m_depth;
 
         if (!expect_and_emit(u8'}', Token_Kind::brace_right)) {
-            error(Source_Span { initial_pos, 1 }, u8"No matching '}'. This block is unclosed."sv);
+            error(initial_pos, 1, u8"No matching '}'. This block is unclosed."sv);
         }
     }
 };
@@ -861,6 +902,15 @@ private:
 
 bool lex(std::pmr::vector<Token>& out, std::u8string_view source, Lex_Error_Consumer on_error)
 {
+    if (source.length() > max_lex_source_length) {
+        if (on_error) {
+            on_error(
+                diagnostic::parse, Source_Span {},
+                u8"The source file is too large to be processed."sv
+            );
+        }
+        return false;
+    }
     return Lexer { out, source, on_error }();
 }
 
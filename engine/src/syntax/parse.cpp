@@ -1,8 +1,10 @@
 #include <cstddef>
+#include <optional>
 #include <string_view>
 #include <vector>
 
 #include "cowel/util/assert.hpp"
+#include "cowel/util/line_table.hpp"
 
 #include "cowel/diagnostic.hpp"
 #include "cowel/fwd.hpp"
@@ -163,6 +165,7 @@ private:
 
             m_self->m_pos = m_initial_pos;
             m_self->m_out.resize(m_initial_size);
+            m_self->m_memoized_quoted_string.reset();
 
             m_self = nullptr;
         }
@@ -176,36 +179,83 @@ private:
     };
 
     std::pmr::vector<CST_Instruction>& m_out;
+    const std::u8string_view m_source;
     std::span<const Token> m_tokens;
     const Parse_Error_Consumer m_on_error;
+    /// @brief If not empty, the document is parsed incrementally (see `parse_incrementally`).
+    const Markup_Element_Instructions_Consumer m_on_element;
+
+    /// @brief A quoted string that has already been parsed as an expression
+    /// at the token position `first_token`,
+    /// whose instructions are the last instructions in `m_out`.
+    ///
+    /// Quoted strings at the start of a group member are first parsed as member names.
+    /// If they turn out not to be followed by `=`,
+    /// their instructions are kept and memoized here,
+    /// so that the subsequent attempt to parse the member as an expression
+    /// does not parse the string a second time.
+    /// Without memoization, strings nested in groups nested in strings,
+    /// like `\d("\d("\d("")")")`, would be parsed twice as often per level of nesting,
+    /// which takes exponential time.
+    struct Memoized_Quoted_String {
+        std::size_t first_token;
+        std::size_t end_token;
+        std::size_t first_instruction;
+        std::size_t end_instruction;
+    };
 
     std::size_t m_pos = 0;
+    std::size_t m_tokens_consumed = 0;
+    /// @brief The amount of groups and expressions which are currently being parsed.
+    /// The nesting of blocks and quoted strings is already limited by the lexer.
+    std::size_t m_depth = 0;
+    std::optional<Memoized_Quoted_String> m_memoized_quoted_string;
     bool m_success = true;
+    /// @brief Only created once the first error is reported.
+    std::optional<Line_Table> m_lines;
 
 public:
     [[nodiscard]]
     Parser(
         std::pmr::vector<CST_Instruction>& out,
+        std::u8string_view source,
         std::span<const Token> tokens,
-        Parse_Error_Consumer on_error
+        Parse_Error_Consumer on_error,
+        Markup_Element_Instructions_Consumer on_element = {}
     )
         : m_out { out }
+        , m_source { source }
         , m_tokens { tokens }
         , m_on_error { on_error }
+        , m_on_element { on_element }
     {
     }
 
     bool operator()()
     {
-        consume_document();
+        if (m_on_element) {
+            consume_document_incrementally();
+        }
+        else {
+            consume_document();
+        }
         return m_success;
     }
 
+    [[nodiscard]]
+    Parse_Statistics statistics() const
+    {
+        return { .tokens_consumed = m_tokens_consumed };
+    }
+
 private:
-    void error(const Source_Span& pos, Char_Sequence8 message)
+    void error(const Token& token, Char_Sequence8 message)
     {
         if (m_on_error) {
-            m_on_error(diagnostic::parse, pos, message);
+            if (!m_lines) {
+                m_lines.emplace(m_source, m_out.get_allocator().resource());
+            }
+            m_on_error(diagnostic::parse, token.location(*m_lines), message);
         }
         m_success = false;
     }
@@ -214,6 +264,7 @@ private:
     {
         COWEL_DEBUG_ASSERT(m_pos + n <= m_tokens.size());
         m_pos += n;
+        m_tokens_consumed += n;
     }
 
     [[nodiscard]]
@@ -284,6 +335,22 @@ private:
         m_out.push_back({ CST_Instruction_Kind::pop_document });
     }
 
+    void consume_document_incrementally()
+    {
+        while (true) {
+            const std::size_t first_token = m_pos;
+            if (!expect_markup_element(Content_Context::document)) {
+                break;
+            }
+            // Top-level markup elements are never subject to backtracking or retroactive
+            // insertion of instructions, so they can be handed off as soon as they are complete.
+            if (m_success) {
+                m_on_element(first_token, m_out);
+            }
+            m_out.clear();
+        }
+    }
+
     [[nodiscard]]
     std::size_t consume_markup_sequence(Content_Context context)
     {
@@ -379,12 +446,12 @@ private:
 
         consume_blank_sequence();
         if (!expect_expression()) {
-            error(m_tokens[m_pos].location, u8"Invalid expression of splice expression."sv);
+            error(m_tokens[m_pos], u8"Invalid expression of splice expression."sv);
         }
         consume_blank_sequence();
 
         if (!peek(Token_Kind::parenthesis_right)) {
-            error(m_tokens[m_pos].location, u8"Expected ')' to close expression splice."sv);
+            error(m_tokens[m_pos], u8"Expected ')' to close expression splice."sv);
             int depth = 0;
             while (!eof()) {
                 if (peek(Token_Kind::parenthesis_left)) {
@@ -433,10 +500,7 @@ private:
                 continue;
             }
             default: {
-                error(
-                    m_tokens[trailing_start].location,
-                    u8"Trailing content in expression line splice."sv
-                );
+                error(m_tokens[trailing_start], u8"Trailing content in expression line splice."sv);
                 advance_by(1);
                 while (!eof()) {
                     if (peek(Token_Kind::line_terminator)) {
@@ -449,7 +513,7 @@ private:
             }
         }
         error(
-            m_tokens.back().location,
+            m_tokens.back(),
             u8"Expression line splice requires a terminating newline, "
             u8"but EOF was unexpectedly reached."sv
         );
@@ -457,17 +521,27 @@ private:
 
     void consume_group()
     {
-        COWEL_ASSERT(expect(Token_Kind::parenthesis_left));
+        const Token* const parenthesis = expect(Token_Kind::parenthesis_left);
+        COWEL_ASSERT(parenthesis);
 
         const std::size_t instruction_index = m_out.size();
         m_out.push_back({ CST_Instruction_Kind::push_group, 0 });
 
+        if (m_depth == max_nesting_depth) {
+            error(*parenthesis, u8"Groups are nested too deeply."sv);
+            skip_past_closing_parenthesis();
+            m_out.push_back({ CST_Instruction_Kind::pop_group });
+            return;
+        }
+        ++m_depth;
+
         std::size_t member_count = 0;
         while (!eof()) {
             consume_blank_sequence();
             if (expect(Token_Kind::parenthesis_right)) {
                 m_out.push_back({ CST_Instruction_Kind::pop_group });
                 m_out[instruction_index].n = member_count;
+                --m_depth;
                 return;
             }
             if (expect(Token_Kind::comma)) {
@@ -528,14 +602,11 @@ private:
                     ++member_count;
                     continue;
                 }
-                error(m_tokens[m_pos].location, u8"Invalid group member."sv);
+                error(m_tokens[m_pos], u8"Invalid group member."sv);
                 skip_to_end_of_group_member();
             }
 
-            error(
-                m_tokens.back().location,
-                u8"Unterminated group should have been dealt with by lexer."sv
-            );
+            error(m_tokens.back(), u8"Unterminated group should have been dealt with by lexer."sv);
         };
 
         const auto promote_first_member_to_group
@@ -556,7 +627,7 @@ private:
                 if (!expect_expression()) {
                     // Even though we couldn't parse the argument expression,
                     // we still return `named` because we recognize the group member kind.
-                    error(m_tokens[m_pos].location, u8"Invalid group member value."sv);
+                    error(m_tokens[m_pos], u8"Invalid group member value."sv);
                     skip_to_end_of_group_member();
                 }
                 return First_Member_Kind::named;
@@ -571,7 +642,7 @@ private:
             return {};
         }();
         if (!first_member_kind) {
-            error(m_tokens[m_pos].location, u8"Invalid group member value."sv);
+            error(m_tokens[m_pos], u8"Invalid group member value."sv);
             m_out[wrapper_instruction_index] = { CST_Instruction_Kind::push_group, 0 };
             consume_group_tail(0);
             return;
@@ -595,10 +666,7 @@ private:
         }
         case First_Member_Kind::positional: {
             if (!peek(Token_Kind::comma)) {
-                error(
-                    m_tokens[m_pos].location,
-                    u8"Expected ')' or ',' after parenthesized expression."sv
-                );
+                error(m_tokens[m_pos], u8"Expected ')' or ',' after parenthesized expression."sv);
                 skip_to_end_of_group_member();
             }
             promote_first_member_to_group(
@@ -652,7 +720,7 @@ private:
 
         if (push_type != CST_Instruction_Kind::push_ellipsis_argument) {
             if (!expect_expression()) {
-                error(m_tokens[m_pos].location, u8"Invalid group member value."sv);
+                error(m_tokens[m_pos], u8"Invalid group member value."sv);
                 skip_to_end_of_group_member();
                 return;
             }
@@ -660,7 +728,7 @@ private:
         }
 
         if (!peek(Token_Kind::comma) && !peek(Token_Kind::parenthesis_right)) {
-            error(m_tokens[m_pos].location, u8"Invalid group member."sv);
+            error(m_tokens[m_pos], u8"Invalid group member."sv);
             skip_to_end_of_group_member();
             return;
         }
@@ -713,6 +781,34 @@ private:
         COWEL_ASSERT(m_pos != initial_pos);
     }
 
+    /// @brief Advances the parser past the `)` matching an already consumed `(`,
+    /// without parsing anything in between.
+    ///
+    /// Unlike `skip_to_end_of_group_member`, this does not recurse into nested constructs,
+    /// so it is used for recovering from constructs which are nested too deeply.
+    void skip_past_closing_parenthesis()
+    {
+        std::size_t depth = 1;
+        while (const Token* const next = peek()) {
+            advance_by(1);
+            switch (next->kind) {
+            case Token_Kind::parenthesis_left:
+            case Token_Kind::expression_splice: {
+                ++depth;
+                break;
+            }
+            case Token_Kind::parenthesis_right: {
+                if (--depth == 0) {
+                    return;
+                }
+                break;
+            }
+            default: break;
+            }
+        }
+        COWEL_ASSERT_UNREACHABLE(u8"Unterminated group should have been dealt with by lexer.");
+    }
+
     /// @brief Matches the name of an argument, including any surrounding whitespace and the `=`
     /// character following it.
     /// If the argument couldn't be matched, returns `false` and keeps the parser state unchanged.
@@ -727,6 +823,8 @@ private:
             return false;
         }
         Scoped_Attempt a = attempt();
+        const std::size_t first_token = m_pos;
+        const std::size_t first_instruction = m_out.size();
         if (next->kind == Token_Kind::identifier) {
             emit_and_advance_by_one(CST_Instruction_Kind::unquoted_member_name);
         }
@@ -736,6 +834,8 @@ private:
                 CST_Instruction_Kind::pop_quoted_member_name
             );
         }
+        const std::size_t end_token = m_pos;
+        const std::size_t end_instruction = m_out.size();
         consume_blank_sequence();
         if (expect(Token_Kind::equals)) {
             m_out.push_back({ CST_Instruction_Kind::equals });
@@ -743,9 +843,39 @@ private:
             a.commit();
             return true;
         }
+        if (next->kind == Token_Kind::string_quote) {
+            a.commit();
+            m_pos = first_token;
+            m_out.resize(end_instruction);
+            m_out[first_instruction].kind = CST_Instruction_Kind::push_quoted_string;
+            m_out.back().kind = CST_Instruction_Kind::pop_quoted_string;
+            COWEL_DEBUG_ASSERT(!m_memoized_quoted_string);
+            m_memoized_quoted_string = Memoized_Quoted_String {
+                .first_token = first_token,
+                .end_token = end_token,
+                .first_instruction = first_instruction,
+                .end_instruction = end_instruction,
+            };
+        }
         return false;
     }
 
+    /// @brief If the quoted string at the current position has already been parsed
+    /// (see `m_memoized_quoted_string`),
+    /// advances past it and returns `true`.
+    /// Otherwise, returns `false` and has no effect.
+    [[nodiscard]]
+    bool expect_memoized_quoted_string()
+    {
+        if (!m_memoized_quoted_string || m_memoized_quoted_string->first_token != m_pos) {
+            return false;
+        }
+        COWEL_DEBUG_ASSERT(m_out.size() == m_memoized_quoted_string->end_instruction);
+        m_pos = m_memoized_quoted_string->end_token;
+        m_memoized_quoted_string.reset();
+        return true;
+    }
+
     void consume_let_expression()
     {
         const Token* const lettoken = peek(Token_Kind::let);
@@ -755,7 +885,7 @@ private:
         consume_blank_sequence();
 
         if (!peek(Token_Kind::identifier)) {
-            error(m_tokens[m_pos].location, u8"Expected variable name after 'let'."sv);
+            error(m_tokens[m_pos], u8"Expected variable name after 'let'."sv);
             skip_to_end_of_group_member();
             return;
         }
@@ -764,9 +894,7 @@ private:
         consume_blank_sequence();
 
         if (!expect(Token_Kind::equals)) {
-            error(
-                m_tokens[m_pos].location, u8"Expected '=' after variable name in let-expression."sv
-            );
+            error(m_tokens[m_pos], u8"Expected '=' after variable name in let-expression."sv);
             skip_to_end_of_group_member();
             return;
         }
@@ -774,7 +902,7 @@ private:
         consume_blank_sequence();
 
         if (!expect_expression()) {
-            error(m_tokens[m_pos].location, u8"Expected expression after '=' in let-expression."sv);
+            error(m_tokens[m_pos], u8"Expected expression after '=' in let-expression."sv);
             skip_to_end_of_group_member();
         }
 
@@ -796,10 +924,49 @@ private:
     {
         COWEL_DEBUG_ASSERT(min_precedence >= 0);
 
+        // Every nested expression, including the right operand of each binary operator,
+        // is parsed by a recursive call to this function.
+        if (!try_enter_nested_expression()) {
+            return false;
+        }
+        const bool result = do_expect_expression_with_min_precedence(min_precedence);
+        --m_depth;
+        return result;
+    }
+
+    /// @brief Enters a nested expression at the current position.
+    /// If that would exceed `max_nesting_depth`, reports an error instead,
+    /// and the expression is left to be skipped by the caller.
+    /// @returns `true` iff the expression was entered,
+    /// in which case `m_depth` has to be decremented once it has been parsed.
+    [[nodiscard]]
+    bool try_enter_nested_expression()
+    {
+        if (m_depth != max_nesting_depth) {
+            ++m_depth;
+            return true;
+        }
+        if (!eof()) {
+            error(m_tokens[m_pos], u8"Expressions are nested too deeply."sv);
+        }
+        // The caller recovers by skipping past the expression,
+        // which includes a quoted string that may have been memoized.
+        m_memoized_quoted_string.reset();
+        return false;
+    }
+
+    [[nodiscard]]
+    bool do_expect_expression_with_min_precedence(const int min_precedence)
+    {
+
         // Record where the left operand begins in the output.
         // When a binary operator is found, we insert the push instruction here,
         // so that push_op wraps the entire left subtree (not just the right operand).
-        const std::size_t left_start = m_out.size();
+        // If the left operand is a memoized quoted string, it has already been emitted.
+        const std::size_t left_start
+            = m_memoized_quoted_string && m_memoized_quoted_string->first_token == m_pos
+            ? m_memoized_quoted_string->first_instruction
+            : m_out.size();
 
         if (!expect_unary_expression()) {
             return false;
@@ -852,7 +1019,7 @@ private:
                     }
                 }
                 if (!lhs_is_id || id_count != 1) {
-                    error(op_token->location, u8"Left side of assignment must be an identifier."sv);
+                    error(*op_token, u8"Left side of assignment must be an identifier."sv);
                 }
             }
 
@@ -863,7 +1030,7 @@ private:
                 = is_right_associative ? op_precedence : op_precedence + 1;
 
             if (!expect_expression_with_min_precedence(right_min_precedence)) {
-                error(m_tokens[m_pos].location, u8"Expected expression after binary operator."sv);
+                error(m_tokens[m_pos], u8"Expected expression after binary operator."sv);
                 skip_to_end_of_group_member();
             }
 
@@ -931,6 +1098,9 @@ private:
             return true;
         }
         case Token_Kind::string_quote: {
+            if (expect_memoized_quoted_string()) {
+                return true;
+            }
             consume_quoted(
                 CST_Instruction_Kind::push_quoted_string, CST_Instruction_Kind::pop_quoted_string
             );
@@ -1021,7 +1191,7 @@ private:
         case Token_Kind::line_comment: break;
         }
 
-        error(m_tokens[m_pos].location, u8"Unexpected token in expression."sv);
+        error(m_tokens[m_pos], u8"Unexpected token in expression."sv);
         return false;
     }
 
@@ -1039,7 +1209,12 @@ private:
 
         m_out.push_back({ push });
         consume_blank_sequence();
-        if (!expect_unary_expression()) {
+        if (!try_enter_nested_expression()) {
+            return false;
+        }
+        const bool has_operand = expect_unary_expression();
+        --m_depth;
+        if (!has_operand) {
             return false;
         }
         m_out.push_back({ pop });
@@ -1424,11 +1599,31 @@ bool cst_instruction_kind_advances(CST_Instruction_Kind kind)
 
 bool parse(
     std::pmr::vector<CST_Instruction>& out,
+    std::u8string_view source,
+    std::span<const Token> tokens,
+    Parse_Error_Consumer on_error,
+    Parse_Statistics* statistics
+)
+{
+    Parser parser { out, source, tokens, on_error };
+    const bool success = parser();
+    if (statistics) {
+        statistics->tokens_consumed += parser.statistics().tokens_consumed;
+    }
+    return success;
+}
+
+bool parse_incrementally(
+    std::pmr::vector<CST_Instruction>& buffer,
+    std::u8string_view source,
     std::span<const Token> tokens,
+    Markup_Element_Instructions_Consumer on_element,
     Parse_Error_Consumer on_error
 )
 {
-    return Parser { out, tokens, on_error }();
+    COWEL_ASSERT(on_element);
+    buffer.clear();
+    return Parser { buffer, source, tokens, on_error, on_element }();
 }
 
 } // namespace cowel
@@ -0,0 +1,409 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/byte_scan.hpp"
+
+using namespace std::string_view_literals;
+
+#if !defined(COWEL_DISABLE_ARCH_INTRINSICS) && (defined(__x86_64__) || defined(_M_X64))
+// SSE2 is part of the x86-64 baseline, so it is always available.
+#define COWEL_BYTE_SCAN_SSE2
+#include <emmintrin.h>
+// AVX2 is only available on some CPUs, so we compile it with a target attribute
+// and select it at runtime.
+// This requires GNU extensions, so MSVC only gets it if it's enabled globally.
+#if defined(__GNUC__) || defined(__AVX2__)
+#define COWEL_BYTE_SCAN_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(COWEL_BYTE_SCAN_AVX2) && defined(__GNUC__) && !defined(__AVX2__)
+#define COWEL_TARGET_AVX2 [[gnu::target("avx2")]]
+#else
+#define COWEL_TARGET_AVX2
+#endif
+
+namespace cowel {
+
+namespace {
+
+[[nodiscard]]
+bool set_contains(std::u8string_view set, char8_t c)
+{
+    return set.find(c) != std::u8string_view::npos;
+}
+
+// SCALAR
+// ======
+
+[[nodiscard]]
+std::size_t find_first_of_scalar(std::u8string_view str, std::u8string_view set)
+{
+    for (std::size_t i = 0; i < str.length(); ++i) {
+        if (set_contains(set, str[i])) {
+            return i;
+        }
+    }
+    return str.length();
+}
+
+[[nodiscard]]
+std::size_t find_last_of_scalar(std::u8string_view str, std::u8string_view set)
+{
+    for (std::size_t i = str.length(); i-- != 0;) {
+        if (set_contains(set, str[i])) {
+            return i;
+        }
+    }
+    return std::u8string_view::npos;
+}
+
+[[nodiscard]]
+std::size_t count_byte_scalar(std::u8string_view str, char8_t byte)
+{
+    std::size_t result = 0;
+    for (const char8_t c : str) {
+        result += c == byte;
+    }
+    return result;
+}
+
+// SSE2
+// ====
+
+#ifdef COWEL_BYTE_SCAN_SSE2
+
+template <std::size_t N>
+struct SSE2_Byte_Set {
+    __m128i needles[N];
+
+    [[nodiscard]]
+    explicit SSE2_Byte_Set(std::u8string_view set)
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            needles[i] = _mm_set1_epi8(static_cast<char>(set[i]));
+        }
+    }
+
+    /// @brief Returns a 16-bit mask where each bit indicates
+    /// whether the corresponding byte in `chunk` is in the set.
+    [[nodiscard]]
+    unsigned match(__m128i chunk) const
+    {
+        __m128i result = _mm_cmpeq_epi8(chunk, needles[0]);
+        for (std::size_t i = 1; i < N; ++i) {
+            result = _mm_or_si128(result, _mm_cmpeq_epi8(chunk, needles[i]));
+        }
+        return static_cast<unsigned>(_mm_movemask_epi8(result));
+    }
+};
+
+[[nodiscard]]
+__m128i load_sse2(const char8_t* data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+template <std::size_t N>
+[[nodiscard]]
+std::size_t find_first_of_sse2(std::u8string_view str, std::u8string_view set)
+{
+    const SSE2_Byte_Set<N> needles { set };
+    std::size_t i = 0;
+    for (; i + 16 <= str.length(); i += 16) {
+        if (const unsigned mask = needles.match(load_sse2(str.data() + i))) {
+            return i + std::size_t(std::countr_zero(mask));
+        }
+    }
+    return i + find_first_of_scalar(str.substr(i), set);
+}
+
+template <std::size_t N>
+[[nodiscard]]
+std::size_t find_last_of_sse2(std::u8string_view str, std::u8string_view set)
+{
+    const SSE2_Byte_Set<N> needles { set };
+    std::size_t i = str.length();
+    for (; i >= 16; i -= 16) {
+        if (const unsigned mask = needles.match(load_sse2(str.data() + i - 16))) {
+            return i - 16 + std::size_t(std::bit_width(mask)) - 1;
+        }
+    }
+    return find_last_of_scalar(str.substr(0, i), set);
+}
+
+[[nodiscard]]
+std::size_t count_byte_sse2(std::u8string_view str, char8_t byte)
+{
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(byte));
+    std::size_t result = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= str.length(); i += 16) {
+        const __m128i eq = _mm_cmpeq_epi8(load_sse2(str.data() + i), needle);
+        result += std::size_t(std::popcount(static_cast<unsigned>(_mm_movemask_epi8(eq))));
+    }
+    return result + count_byte_scalar(str.substr(i), byte);
+}
+
+#endif
+
+// AVX2
+// ====
+
+#ifdef COWEL_BYTE_SCAN_AVX2
+
+template <std::size_t N>
+struct AVX2_Byte_Set {
+    __m256i needles[N];
+
+    COWEL_TARGET_AVX2
+    [[nodiscard]]
+    explicit AVX2_Byte_Set(std::u8string_view set)
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            needles[i] = _mm256_set1_epi8(static_cast<char>(set[i]));
+        }
+    }
+
+    /// @brief Returns a 32-bit mask where each bit indicates
+    /// whether the corresponding byte in `chunk` is in the set.
+    COWEL_TARGET_AVX2
+    [[nodiscard]]
+    std::uint32_t match(__m256i chunk) const
+    {
+        __m256i result = _mm256_cmpeq_epi8(chunk, needles[0]);
+        for (std::size_t i = 1; i < N; ++i) {
+            result = _mm256_or_si256(result, _mm256_cmpeq_epi8(chunk, needles[i]));
+        }
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(result));
+    }
+};
+
+COWEL_TARGET_AVX2
+[[nodiscard]]
+__m256i load_avx2(const char8_t* data)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+template <std::size_t N>
+COWEL_TARGET_AVX2
+[[nodiscard]]
+std::size_t find_first_of_avx2(std::u8string_view str, std::u8string_view set)
+{
+    const AVX2_Byte_Set<N> needles { set };
+    std::size_t i = 0;
+    for (; i + 32 <= str.length(); i += 32) {
+        if (const std::uint32_t mask = needles.match(load_avx2(str.data() + i))) {
+            return i + std::size_t(std::countr_zero(mask));
+        }
+    }
+    return i + find_first_of_sse2<N>(str.substr(i), set);
+}
+
+template <std::size_t N>
+COWEL_TARGET_AVX2
+[[nodiscard]]
+std::size_t find_last_of_avx2(std::u8string_view str, std::u8string_view set)
+{
+    const AVX2_Byte_Set<N> needles { set };
+    std::size_t i = str.length();
+    for (; i >= 32; i -= 32) {
+        if (const std::uint32_t mask = needles.match(load_avx2(str.data() + i - 32))) {
+            return i - 32 + std::size_t(std::bit_width(mask)) - 1;
+        }
+    }
+    return find_last_of_sse2<N>(str.substr(0, i), set);
+}
+
+COWEL_TARGET_AVX2
+[[nodiscard]]
+std::size_t count_byte_avx2(std::u8string_view str, char8_t byte)
+{
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(byte));
+    std::size_t result = 0;
+    std::size_t i = 0;
+    for (; i + 32 <= str.length(); i += 32) {
+        const __m256i eq = _mm256_cmpeq_epi8(load_avx2(str.data() + i), needle);
+        result += std::size_t(std::popcount(static_cast<std::uint32_t>(_mm256_movemask_epi8(eq))));
+    }
+    return result + count_byte_sse2(str.substr(i), byte);
+}
+
+#endif
+
+using Find_Function = std::size_t(std::u8string_view str, std::u8string_view set);
+using Count_Function = std::size_t(std::u8string_view str, char8_t byte);
+
+/// @brief The functions implementing a kernel.
+/// The find functions are specialized for each set size,
+/// which lets the vector kernels keep all needles in registers.
+struct Kernel_Table {
+    Find_Function* find_first_of[max_byte_set_size + 1];
+    Find_Function* find_last_of[max_byte_set_size + 1];
+    Count_Function* count;
+};
+
+constexpr Kernel_Table scalar_table {
+    .find_first_of = {
+        find_first_of_scalar, find_first_of_scalar, find_first_of_scalar,
+        find_first_of_scalar, find_first_of_scalar, find_first_of_scalar,
+        find_first_of_scalar, find_first_of_scalar, find_first_of_scalar,
+    },
+    .find_last_of = {
+        find_last_of_scalar, find_last_of_scalar, find_last_of_scalar,
+        find_last_of_scalar, find_last_of_scalar, find_last_of_scalar,
+        find_last_of_scalar, find_last_of_scalar, find_last_of_scalar,
+    },
+    .count = count_byte_scalar,
+};
+
+#ifdef COWEL_BYTE_SCAN_SSE2
+constexpr Kernel_Table sse2_table {
+    .find_first_of = {
+        find_first_of_scalar, find_first_of_sse2<1>, find_first_of_sse2<2>,
+        find_first_of_sse2<3>, find_first_of_sse2<4>, find_first_of_sse2<5>,
+        find_first_of_sse2<6>, find_first_of_sse2<7>, find_first_of_sse2<8>,
+    },
+    .find_last_of = {
+        find_last_of_scalar, find_last_of_sse2<1>, find_last_of_sse2<2>,
+        find_last_of_sse2<3>, find_last_of_sse2<4>, find_last_of_sse2<5>,
+        find_last_of_sse2<6>, find_last_of_sse2<7>, find_last_of_sse2<8>,
+    },
+    .count = count_byte_sse2,
+};
+#endif
+
+#ifdef COWEL_BYTE_SCAN_AVX2
+constexpr Kernel_Table avx2_table {
+    .find_first_of = {
+        find_first_of_scalar, find_first_of_avx2<1>, find_first_of_avx2<2>,
+        find_first_of_avx2<3>, find_first_of_avx2<4>, find_first_of_avx2<5>,
+        find_first_of_avx2<6>, find_first_of_avx2<7>, find_first_of_avx2<8>,
+    },
+    .find_last_of = {
+        find_last_of_scalar, find_last_of_avx2<1>, find_last_of_avx2<2>,
+        find_last_of_avx2<3>, find_last_of_avx2<4>, find_last_of_avx2<5>,
+        find_last_of_avx2<6>, find_last_of_avx2<7>, find_last_of_avx2<8>,
+    },
+    .count = count_byte_avx2,
+};
+#endif
+
+static_assert(max_byte_set_size == 8, "Kernel tables need to be updated.");
+
+[[nodiscard]]
+const Kernel_Table& kernel_table(Byte_Scan_Kernel kernel)
+{
+    if (!byte_scan_kernel_is_supported(kernel)) {
+        return scalar_table;
+    }
+    switch (kernel) {
+    case Byte_Scan_Kernel::scalar: return scalar_table;
+#ifdef COWEL_BYTE_SCAN_SSE2
+    case Byte_Scan_Kernel::sse2: return sse2_table;
+#endif
+#ifdef COWEL_BYTE_SCAN_AVX2
+    case Byte_Scan_Kernel::avx2: return avx2_table;
+#endif
+    default: break;
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Unsupported byte scan kernel.");
+}
+
+// Resolved once during static initialization,
+// so that calls without an explicit kernel are a single indirect call.
+const Kernel_Table& default_table = kernel_table(default_byte_scan_kernel());
+
+} // namespace
+
+std::u8string_view byte_scan_kernel_name(Byte_Scan_Kernel kernel)
+{
+    switch (kernel) {
+    case Byte_Scan_Kernel::scalar: return u8"scalar"sv;
+    case Byte_Scan_Kernel::sse2: return u8"sse2"sv;
+    case Byte_Scan_Kernel::avx2: return u8"avx2"sv;
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Invalid byte scan kernel.");
+}
+
+bool byte_scan_kernel_is_supported(Byte_Scan_Kernel kernel)
+{
+    switch (kernel) {
+    case Byte_Scan_Kernel::scalar: return true;
+    case Byte_Scan_Kernel::sse2: {
+#ifdef COWEL_BYTE_SCAN_SSE2
+        return true;
+#else
+        return false;
+#endif
+    }
+    case Byte_Scan_Kernel::avx2: {
+#if defined(COWEL_BYTE_SCAN_AVX2) && defined(__AVX2__)
+        return true;
+#elif defined(COWEL_BYTE_SCAN_AVX2)
+        static const bool result = __builtin_cpu_supports("avx2");
+        return result;
+#else
+        return false;
+#endif
+    }
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Invalid byte scan kernel.");
+}
+
+Byte_Scan_Kernel default_byte_scan_kernel()
+{
+    static const Byte_Scan_Kernel result = [] {
+        if (byte_scan_kernel_is_supported(Byte_Scan_Kernel::avx2)) {
+            return Byte_Scan_Kernel::avx2;
+        }
+        if (byte_scan_kernel_is_supported(Byte_Scan_Kernel::sse2)) {
+            return Byte_Scan_Kernel::sse2;
+        }
+        return Byte_Scan_Kernel::scalar;
+    }();
+    return result;
+}
+
+std::size_t find_first_of_bytes(std::u8string_view str, std::u8string_view set)
+{
+    COWEL_ASSERT(set.size() <= max_byte_set_size);
+    return default_table.find_first_of[set.size()](str, set);
+}
+
+std::size_t
+find_first_of_bytes(std::u8string_view str, std::u8string_view set, Byte_Scan_Kernel kernel)
+{
+    COWEL_ASSERT(set.size() <= max_byte_set_size);
+    return kernel_table(kernel).find_first_of[set.size()](str, set);
+}
+
+std::size_t find_last_of_bytes(std::u8string_view str, std::u8string_view set)
+{
+    COWEL_ASSERT(set.size() <= max_byte_set_size);
+    return default_table.find_last_of[set.size()](str, set);
+}
+
+std::size_t
+find_last_of_bytes(std::u8string_view str, std::u8string_view set, Byte_Scan_Kernel kernel)
+{
+    COWEL_ASSERT(set.size() <= max_byte_set_size);
+    return kernel_table(kernel).find_last_of[set.size()](str, set);
+}
+
+std::size_t count_byte(std::u8string_view str, char8_t byte)
+{
+    return default_table.count(str, byte);
+}
+
+std::size_t count_byte(std::u8string_view str, char8_t byte, Byte_Scan_Kernel kernel)
+{
+    return kernel_table(kernel).count(str, byte);
+}
+
+} // namespace cowel
@@ -4,6 +4,7 @@
 #include <string_view>
 
 #include "cowel/util/html_entities.hpp"
+#include "cowel/util/perfect_hash.hpp"
 
 namespace cowel {
 namespace {
@@ -32,14 +33,12 @@ constexpr Character_Reference references[] {
 
 static_assert(std::ranges::is_sorted(references, {}, &Character_Reference::name_as_string));
 
+constexpr Perfect_Hash_Table references_by_name { references,
+                                                  &Character_Reference::name_as_string };
+
 const Character_Reference* character_reference_by_name(std::u8string_view name) noexcept
 {
-    const auto* const it
-        = std::ranges::lower_bound(references, name, {}, &Character_Reference::name_as_string);
-    if (it == std::end(references) || it->name_as_string() != name) {
-        return nullptr;
-    }
-    return &*it;
+    return references_by_name.find(name);
 }
 
 } // namespace
@@ -1,9 +1,22 @@
+#if defined(__unix__) || defined(__APPLE__)
+#include "stdio.h" // NOLINT for fileno
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <array>
 #include <bit>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <memory_resource>
 #include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -48,6 +61,60 @@ Result<void, IO_Error_Code> file_to_bytes_chunked(
     return {};
 }
 
+void Mapped_File::close() noexcept
+{
+    if (!m_data) {
+        return;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<std::byte*>(m_data), m_size);
+#else
+    delete[] m_data;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+Result<Mapped_File, IO_Error_Code> map_file(std::u8string_view path)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const std::string c_path(reinterpret_cast<const char*>(path.data()), path.size());
+    const int fd = ::open(c_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return IO_Error_Code::cannot_open;
+    }
+    struct ::stat status {};
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        ::close(fd);
+        return IO_Error_Code::read_error;
+    }
+    const auto size = std::size_t(status.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return Mapped_File {};
+    }
+    void* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own.
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return IO_Error_Code::read_error;
+    }
+    return Mapped_File { static_cast<const std::byte*>(data), size };
+#else
+    std::vector<std::byte> buffer;
+    if (auto r = file_to_bytes(buffer, path); !r) {
+        return r.error();
+    }
+    if (buffer.empty()) {
+        return Mapped_File {};
+    }
+    auto* const data = new std::byte[buffer.size()];
+    std::memcpy(data, buffer.data(), buffer.size());
+    return Mapped_File { data, buffer.size() };
+#endif
+}
+
 Result<void, IO_Error_Code> load_utf8_file(std::pmr::vector<char8_t>& out, std::u8string_view path)
 {
     const std::size_t initial_size = out.size();
@@ -125,4 +192,75 @@ bytes_to_file(const void* data, std::size_t amount, std::u8string_view path)
     return {};
 }
 
+Result<void, IO_Error_Code>
+write_gathered(std::FILE* const file, const std::span<const std::u8string_view> pieces)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    // Anything previously written through the FILE has to reach the file before the pieces.
+    if (std::fflush(file) != 0) {
+        return IO_Error_Code::write_error;
+    }
+    const int fd = fileno(file);
+
+#ifdef IOV_MAX
+    constexpr std::size_t max_vectors = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+    constexpr std::size_t max_vectors = 16;
+#endif
+    std::array<iovec, max_vectors> vectors;
+
+    // The first piece that has not been written entirely,
+    // and the amount of its bytes that have been written.
+    std::size_t index = 0;
+    std::size_t offset = 0;
+    while (true) {
+        while (index < pieces.size() && offset == pieces[index].size()) {
+            ++index;
+            offset = 0;
+        }
+        if (index == pieces.size()) {
+            return {};
+        }
+
+        std::size_t count = 0;
+        for (std::size_t i = index; i < pieces.size() && count < max_vectors; ++i) {
+            const std::u8string_view piece = i == index ? pieces[i].substr(offset) : pieces[i];
+            if (!piece.empty()) {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+                vectors[count++] = { const_cast<char8_t*>(piece.data()), piece.size() };
+            }
+        }
+
+        const ::ssize_t result = ::writev(fd, vectors.data(), int(count));
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return IO_Error_Code::write_error;
+        }
+
+        // writev may write fewer bytes than requested,
+        // in which case the remainder is written in the next iteration.
+        auto written = std::size_t(result);
+        while (written != 0) {
+            const std::size_t remaining = pieces[index].size() - offset;
+            if (written < remaining) {
+                offset += written;
+                break;
+            }
+            written -= remaining;
+            ++index;
+            offset = 0;
+        }
+    }
+#else
+    for (const std::u8string_view piece : pieces) {
+        if (std::fwrite(piece.data(), 1, piece.size(), file) != piece.size()) {
+            return IO_Error_Code::write_error;
+        }
+    }
+    return {};
+#endif
+}
+
 } // namespace cowel
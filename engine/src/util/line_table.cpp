@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+
+#include "cowel/util/assert.hpp"
+#include "cowel/util/byte_scan.hpp"
+#include "cowel/util/line_table.hpp"
+#include "cowel/util/source_position.hpp"
+#include "cowel/util/strings.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+
+Line_Table::Line_Table(std::u8string_view source, std::pmr::memory_resource* memory)
+    : m_line_starts { memory }
+    , m_carriage_returns { memory }
+    , m_source_length { source.length() }
+{
+    m_line_starts.push_back(0);
+    std::size_t i = 0;
+    while (true) {
+        i += find_first_of_bytes(source.substr(i), u8"\r\n"sv);
+        if (i == source.length()) {
+            break;
+        }
+        if (source[i] == u8'\n') {
+            m_line_starts.push_back(i + 1);
+        }
+        else {
+            m_carriage_returns.push_back(i);
+        }
+        ++i;
+    }
+}
+
+std::size_t Line_Table::line_at(std::size_t offset) const
+{
+    COWEL_ASSERT(offset <= m_source_length);
+
+    // The line is the amount of line starts (other than the first) at or before the offset.
+    const auto line_it = std::ranges::upper_bound(m_line_starts, offset);
+    COWEL_DEBUG_ASSERT(line_it != m_line_starts.begin());
+    return std::size_t(line_it - m_line_starts.begin() - 1);
+}
+
+Source_Position Line_Table::position_at(std::size_t offset) const
+{
+    const std::size_t line = line_at(offset);
+
+    std::size_t column_start = m_line_starts[line];
+    // Carriage returns are rare (except in CRLF files),
+    // but when present, they reset the column without starting a new line.
+    if (!m_carriage_returns.empty()) {
+        const auto cr_it = std::ranges::lower_bound(m_carriage_returns, offset);
+        if (cr_it != m_carriage_returns.begin() && *(cr_it - 1) >= column_start) {
+            column_start = *(cr_it - 1) + 1;
+        }
+    }
+
+    return { .line = line, .column = offset - column_start, .begin = offset };
+}
+
+std::size_t Line_Table::utf16_column_at(std::u8string_view source, std::size_t offset) const
+{
+    COWEL_DEBUG_ASSERT(source.length() == m_source_length);
+    const std::size_t start = m_line_starts[line_at(offset)];
+    return unchecked_utf8_to_utf16_length(source.substr(start, offset - start));
+}
+
+std::size_t Line_Table::offset_at(std::size_t line, std::size_t column) const
+{
+    if (line >= m_line_starts.size()) {
+        return m_source_length;
+    }
+    const std::size_t start = m_line_starts[line];
+    return start + std::min(column, line_end(line) - start);
+}
+
+std::size_t Line_Table::offset_at_utf16(
+    std::u8string_view source,
+    std::size_t line,
+    std::size_t utf16_column
+) const
+{
+    if (line >= m_line_starts.size()) {
+        return m_source_length;
+    }
+    return m_line_starts[line]
+        + unchecked_utf16_offset_to_utf8_offset(line_text(source, line), utf16_column);
+}
+
+} // namespace cowel
@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cowel/util/byte_scan.hpp"
+#include "cowel/util/source_position.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+constexpr Byte_Scan_Kernel all_kernels[] {
+    Byte_Scan_Kernel::scalar,
+    Byte_Scan_Kernel::sse2,
+    Byte_Scan_Kernel::avx2,
+};
+
+[[nodiscard]]
+std::u8string random_text(std::default_random_engine& rng, std::size_t length)
+{
+    static constexpr std::u8string_view alphabet = u8"abc \\{}\"\r\n"sv;
+    std::uniform_int_distribution<std::size_t> distribution { 0, alphabet.length() - 1 };
+
+    std::u8string result;
+    result.reserve(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        result += alphabet[distribution(rng)];
+    }
+    return result;
+}
+
+TEST(Byte_Scan, find_first_of_bytes)
+{
+    for (const Byte_Scan_Kernel kernel : all_kernels) {
+        EXPECT_EQ(find_first_of_bytes(u8""sv, u8"x"sv, kernel), 0uz);
+        EXPECT_EQ(find_first_of_bytes(u8"abc"sv, u8""sv, kernel), 3uz);
+        EXPECT_EQ(find_first_of_bytes(u8"abc"sv, u8"x"sv, kernel), 3uz);
+        EXPECT_EQ(find_first_of_bytes(u8"abc"sv, u8"cb"sv, kernel), 1uz);
+
+        std::u8string long_text(100, u8'a');
+        EXPECT_EQ(find_first_of_bytes(long_text, u8"\\"sv, kernel), 100uz);
+        long_text[70] = u8'\\';
+        long_text[90] = u8'{';
+        EXPECT_EQ(find_first_of_bytes(long_text, u8"{\\"sv, kernel), 70uz);
+    }
+}
+
+TEST(Byte_Scan, find_last_of_bytes)
+{
+    for (const Byte_Scan_Kernel kernel : all_kernels) {
+        EXPECT_EQ(find_last_of_bytes(u8""sv, u8"x"sv, kernel), std::u8string_view::npos);
+        EXPECT_EQ(find_last_of_bytes(u8"abc"sv, u8"x"sv, kernel), std::u8string_view::npos);
+        EXPECT_EQ(find_last_of_bytes(u8"abc"sv, u8"ab"sv, kernel), 1uz);
+
+        std::u8string long_text(100, u8'a');
+        long_text[3] = u8'\n';
+        long_text[40] = u8'\r';
+        EXPECT_EQ(find_last_of_bytes(long_text, u8"\r\n"sv, kernel), 40uz);
+    }
+}
+
+TEST(Byte_Scan, count_byte)
+{
+    for (const Byte_Scan_Kernel kernel : all_kernels) {
+        EXPECT_EQ(count_byte(u8""sv, u8'\n', kernel), 0uz);
+        EXPECT_EQ(count_byte(u8"a\nb\n"sv, u8'\n', kernel), 2uz);
+
+        std::u8string long_text(100, u8'\n');
+        long_text[99] = u8'a';
+        EXPECT_EQ(count_byte(long_text, u8'\n', kernel), 99uz);
+    }
+}
+
+TEST(Byte_Scan, kernels_agree_with_scalar)
+{
+    std::default_random_engine rng { 12345 };
+    std::uniform_int_distribution<std::size_t> length_distribution { 0, 200 };
+
+    for (int i = 0; i < 10'000; ++i) {
+        const std::u8string text = random_text(rng, length_distribution(rng));
+
+        const std::size_t expected_first
+            = find_first_of_bytes(text, u8"\\{}"sv, Byte_Scan_Kernel::scalar);
+        const std::size_t expected_last
+            = find_last_of_bytes(text, u8"\r\n"sv, Byte_Scan_Kernel::scalar);
+        const std::size_t expected_count = count_byte(text, u8'\n', Byte_Scan_Kernel::scalar);
+
+        for (const Byte_Scan_Kernel kernel : all_kernels) {
+            ASSERT_EQ(find_first_of_bytes(text, u8"\\{}"sv, kernel), expected_first);
+            ASSERT_EQ(find_last_of_bytes(text, u8"\r\n"sv, kernel), expected_last);
+            ASSERT_EQ(count_byte(text, u8'\n', kernel), expected_count);
+        }
+    }
+}
+
+TEST(Byte_Scan, bulk_advance_matches_per_character_advance)
+{
+    std::default_random_engine rng { 54321 };
+    std::uniform_int_distribution<std::size_t> length_distribution { 0, 200 };
+
+    for (int i = 0; i < 10'000; ++i) {
+        const std::u8string text = random_text(rng, length_distribution(rng));
+
+        const Source_Position start { .line = 3, .column = 5, .begin = 10 };
+        Source_Position expected = start;
+        for (const char8_t c : text) {
+            advance(expected, c);
+        }
+        Source_Position actual = start;
+        advance(actual, std::u8string_view { text });
+
+        ASSERT_EQ(actual, expected);
+    }
+}
+
+} // namespace
+} // namespace cowel
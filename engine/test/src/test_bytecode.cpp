@@ -0,0 +1,268 @@
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cowel/util/function_ref.hpp"
+
+#include "cowel/big_int.hpp"
+#include "cowel/builtin_directive_set.hpp"
+#include "cowel/bytecode.hpp"
+#include "cowel/collecting_logger.hpp"
+#include "cowel/content_status.hpp"
+#include "cowel/context.hpp"
+#include "cowel/diagnostic.hpp"
+#include "cowel/document_generation.hpp"
+#include "cowel/fwd.hpp"
+#include "cowel/memory_resources.hpp"
+#include "cowel/type.hpp"
+#include "cowel/value.hpp"
+
+#include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/expression_kind.hpp"
+#include "cowel/syntax/parse.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+struct Bytecode_Test : testing::Test {
+    Global_Memory_Resource memory;
+    Builtin_Directive_Set directives;
+    Collecting_Logger logger { &memory };
+    ast::Pmr_Vector<ast::Markup_Element> content { &memory };
+
+    /// @brief Parses `source`, which shall consist of a single expression splice
+    /// such as `\(1 + 2)`, and returns the spliced expression,
+    /// or `nullptr` if `source` is not such a splice.
+    [[nodiscard]]
+    const ast::Expression* parse_expression(std::u8string_view source)
+    {
+        content.clear();
+        if (!lex_and_parse_and_build(content, source, File_Id::main, &memory)
+            || content.size() != 1) {
+            return nullptr;
+        }
+        return content.front().try_as_expression();
+    }
+
+    void run(Function_Ref<void(Context&)> test)
+    {
+        const Generation_Options options {
+            .error_behavior = &directives.get_error_behavior(),
+            .highlight_theme_source = u8""sv,
+            .builtin_name_resolver = directives,
+            .logger = logger,
+            .memory = &memory,
+        };
+        const Processing_Status status = run_generation(
+            [&](Context& context) -> Processing_Status {
+                test(context);
+                return Processing_Status::ok;
+            },
+            options
+        );
+        EXPECT_EQ(status, Processing_Status::ok);
+    }
+};
+
+void set_variable(Context& context, std::u8string_view name, Value value)
+{
+    context.get_variables().insert_or_assign(context.intern(name), std::move(value));
+}
+
+[[nodiscard]]
+std::vector<Opcode> opcodes(const Bytecode_Program& program)
+{
+    std::vector<Opcode> result;
+    for (const Bytecode_Instruction& instruction : program.code) {
+        result.push_back(instruction.opcode);
+    }
+    return result;
+}
+
+TEST_F(Bytecode_Test, compile_arithmetic)
+{
+    const ast::Expression* const expression = parse_expression(u8R"(\(1 + 2 * x))");
+    ASSERT_NE(expression, nullptr);
+
+    Bytecode_Program program { &memory };
+    compile_bytecode(program, *expression);
+
+    const std::vector<Opcode> expected {
+        Opcode::push_constant, Opcode::push_constant, Opcode::evaluate_primary,
+        Opcode::binary,        Opcode::binary,
+    };
+    EXPECT_EQ(opcodes(program), expected);
+    ASSERT_EQ(program.constants.size(), 2u);
+    EXPECT_EQ(program.constants[0], Value::integer(1_n));
+    EXPECT_EQ(program.constants[1], Value::integer(2_n));
+    ASSERT_EQ(program.binary_operations.size(), 2u);
+    EXPECT_EQ(program.binary_operations[0].kind, Builtin_Operation_Kind::multiply_dynamic);
+    EXPECT_EQ(program.binary_operations[1].kind, Builtin_Operation_Kind::plus_dynamic);
+    EXPECT_EQ(program.max_stack_size, 3u);
+}
+
+TEST_F(Bytecode_Test, compile_logical)
+{
+    const ast::Expression* const expression = parse_expression(u8R"(\(a || b && c))");
+    ASSERT_NE(expression, nullptr);
+
+    Bytecode_Program program { &memory };
+    compile_bytecode(program, *expression);
+
+    const std::vector<Opcode> expected {
+        Opcode::evaluate_primary, Opcode::logical_lhs, Opcode::evaluate_primary,
+        Opcode::logical_lhs,      Opcode::evaluate_primary, Opcode::logical_rhs,
+        Opcode::logical_rhs,
+    };
+    EXPECT_EQ(opcodes(program), expected);
+    ASSERT_EQ(program.logical_operations.size(), 2u);
+    // The outer || jumps past everything; the inner && only past its own right operand.
+    EXPECT_TRUE(program.logical_operations[0].terminator);
+    EXPECT_EQ(program.logical_operations[0].end, 7u);
+    EXPECT_FALSE(program.logical_operations[1].terminator);
+    EXPECT_EQ(program.logical_operations[1].end, 6u);
+    EXPECT_EQ(program.max_stack_size, 1u);
+}
+
+TEST_F(Bytecode_Test, compile_let)
+{
+    const ast::Expression* const expression = parse_expression(u8R"(\(let v = 1))");
+    ASSERT_NE(expression, nullptr);
+
+    Bytecode_Program program { &memory };
+    compile_bytecode(program, *expression);
+
+    const std::vector<Opcode> expected {
+        Opcode::push_constant,
+        Opcode::push_constant,
+        Opcode::binary,
+    };
+    EXPECT_EQ(opcodes(program), expected);
+    ASSERT_EQ(program.constants.size(), 2u);
+    EXPECT_EQ(program.constants[0].as_string(), u8"v"sv);
+    ASSERT_EQ(program.binary_operations.size(), 1u);
+    EXPECT_EQ(program.binary_operations[0].kind, Builtin_Operation_Kind::let_dynamic);
+}
+
+TEST_F(Bytecode_Test, inline_cache_follows_operand_types)
+{
+    const ast::Expression* const expression = parse_expression(u8R"(\(x + y))");
+    ASSERT_NE(expression, nullptr);
+
+    run([&](Context& context) {
+        const Bytecode_Program& program = context.get_bytecode(*expression);
+        ASSERT_EQ(program.binary_operations.size(), 1u);
+        const Binary_Operation& operation = program.binary_operations[0];
+
+        set_variable(context, u8"x"sv, Value::integer(1_n));
+        set_variable(context, u8"y"sv, Value::integer(2_n));
+        const auto int_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(int_result);
+        EXPECT_EQ(*int_result, Value::integer(3_n));
+        EXPECT_EQ(operation.resolved_kind, Builtin_Operation_Kind::plus_int_int);
+
+        set_variable(context, u8"x"sv, Value::floating(1.5));
+        set_variable(context, u8"y"sv, Value::floating(2.5));
+        const auto float_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(float_result);
+        EXPECT_EQ(*float_result, Value::floating(4.0));
+        EXPECT_EQ(operation.resolved_kind, Builtin_Operation_Kind::plus_float_float);
+
+        // A failed type check must not replace the cached operation.
+        set_variable(context, u8"x"sv, Value::integer(1_n));
+        const auto mixed_result = execute_bytecode(program, Frame_Index::root, context);
+        EXPECT_FALSE(mixed_result);
+        EXPECT_TRUE(logger.was_logged(diagnostic::type_mismatch));
+        EXPECT_EQ(operation.resolved_kind, Builtin_Operation_Kind::plus_float_float);
+        EXPECT_EQ(operation.resolved_lhs_type, Type_Kind::floating);
+
+        set_variable(context, u8"y"sv, Value::integer(2_n));
+        const auto int_again_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(int_again_result);
+        EXPECT_EQ(*int_again_result, Value::integer(3_n));
+        EXPECT_EQ(operation.resolved_kind, Builtin_Operation_Kind::plus_int_int);
+    });
+}
+
+TEST_F(Bytecode_Test, logical_short_circuit)
+{
+    const ast::Expression* const expression
+        = parse_expression(u8R"(\(x && (let z = true) || y))");
+    ASSERT_NE(expression, nullptr);
+
+    run([&](Context& context) {
+        const Bytecode_Program& program = context.get_bytecode(*expression);
+
+        set_variable(context, u8"x"sv, Value::boolean(false));
+        set_variable(context, u8"y"sv, Value::boolean(false));
+        const auto false_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(false_result);
+        EXPECT_EQ(*false_result, Value::boolean(false));
+        EXPECT_EQ(context.get_variable(u8"z"sv), nullptr);
+
+        set_variable(context, u8"x"sv, Value::boolean(true));
+        const auto true_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(true_result);
+        EXPECT_EQ(*true_result, Value::boolean(true));
+        EXPECT_NE(context.get_variable(u8"z"sv), nullptr);
+
+        // A right operand which is not a bool is only diagnosed if it is evaluated.
+        set_variable(context, u8"y"sv, Value::integer(0_n));
+        context.get_variables().erase(context.intern(u8"z"sv));
+        const auto decided_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(decided_result);
+        EXPECT_EQ(*decided_result, Value::boolean(true));
+        EXPECT_TRUE(logger.nothing_logged());
+
+        set_variable(context, u8"x"sv, Value::boolean(false));
+        const auto undecided_result = execute_bytecode(program, Frame_Index::root, context);
+        EXPECT_FALSE(undecided_result);
+        EXPECT_TRUE(logger.was_logged(diagnostic::type_mismatch));
+    });
+}
+
+TEST_F(Bytecode_Test, let_declares_once)
+{
+    const ast::Expression* const expression = parse_expression(u8R"(\(let v = 1 + 2))");
+    ASSERT_NE(expression, nullptr);
+
+    run([&](Context& context) {
+        const Bytecode_Program& program = context.get_bytecode(*expression);
+
+        const auto declared_result = execute_bytecode(program, Frame_Index::root, context);
+        ASSERT_TRUE(declared_result);
+        EXPECT_EQ(*declared_result, Value::integer(3_n));
+        const Value* const v = context.get_variable(u8"v"sv);
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(*v, Value::integer(3_n));
+
+        set_variable(context, u8"v"sv, Value::floating(0.5));
+        const auto redeclared_result = execute_bytecode(program, Frame_Index::root, context);
+        EXPECT_FALSE(redeclared_result);
+        EXPECT_TRUE(logger.was_logged(diagnostic::var_let));
+        EXPECT_EQ(*context.get_variable(u8"v"sv), Value::floating(0.5));
+    });
+}
+
+TEST_F(Bytecode_Test, error_stops_execution)
+{
+    const ast::Expression* const expression
+        = parse_expression(u8R"(\(1 % x == 0 && (let after = true)))");
+    ASSERT_NE(expression, nullptr);
+
+    run([&](Context& context) {
+        set_variable(context, u8"x"sv, Value::integer(0_n));
+        const auto result
+            = execute_bytecode(context.get_bytecode(*expression), Frame_Index::root, context);
+        EXPECT_FALSE(result);
+        EXPECT_TRUE(logger.was_logged(diagnostic::arithmetic_div_by_zero));
+        EXPECT_EQ(context.get_variable(u8"after"sv), nullptr);
+    });
+}
+
+} // namespace
+} // namespace cowel
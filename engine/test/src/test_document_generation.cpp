@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <filesystem>
 #include <span>
 #include <string>
@@ -8,6 +9,7 @@
 
 #include "cowel/ulight_highlighter.hpp"
 #include "cowel/util/annotated_string.hpp"
+#include "cowel/util/function_ref.hpp"
 #include "cowel/util/meta.hpp"
 #include "cowel/util/strings.hpp"
 
@@ -113,7 +115,9 @@ void print_diagnostic(
     out.append(u8'\n');
 }
 
-TEST(Document_Generation, file_tests)
+/// @brief Runs all tests in `engine/test/files/semantics`,
+/// generating each of them with the given `flags`.
+void run_file_tests(const cowel_gen_flags flags)
 {
     Global_Memory_Resource memory;
     const auto alloc_options = Allocator_Options::from_memory_resource(&memory);
@@ -174,7 +178,7 @@ TEST(Document_Generation, file_tests)
             .source = as_cowel_string_view(as_u8string_view(source)),
             .highlight_theme_json = as_cowel_string_view(as_u8string_view(theme_source)),
             .mode = COWEL_MODE_MINIMAL,
-            .flags = COWEL_GEN_FLAGS_NONE,
+            .flags = flags,
             .min_log_severity = COWEL_SEVERITY_DEBUG,
             .preserved_variables = preserved_variables,
             .preserved_variables_size = std::size(preserved_variables),
@@ -191,6 +195,15 @@ TEST(Document_Generation, file_tests)
             .highlighter = &syntax_highlighter,
             .highlight_policy = COWEL_SYNTAX_HIGHLIGHT_POLICY_FALL_BACK,
             .preamble = as_cowel_string_view(integration_test_preamble),
+            .load_cache = nullptr,
+            .load_cache_data = nullptr,
+            .store_cache = nullptr,
+            .store_cache_data = nullptr,
+            .max_call_depth = 0,
+            .write = nullptr,
+            .write_data = nullptr,
+            .write_slices = nullptr,
+            .write_slices_data = nullptr,
         };
 
         cowel_gen_result_u8 result = cowel_generate_html_u8(&cowel_options);
@@ -248,6 +261,18 @@ TEST(Document_Generation, file_tests)
     EXPECT_TRUE(success);
 }
 
+TEST(Document_Generation, file_tests)
+{
+    run_file_tests(COWEL_GEN_FLAGS_NONE);
+}
+
+// Constant folding must not change the output of any document,
+// so the same tests are run with folding enabled.
+TEST(Document_Generation, file_tests_folded)
+{
+    run_file_tests(COWEL_GEN_FLAGS_FOLD_CONSTANTS);
+}
+
 TEST(Document_Generation, empty_document)
 {
     const std::u8string_view expected_html = u8R"(<!DOCTYPE html>
@@ -280,6 +305,140 @@ TEST(Document_Generation, empty_document)
     ASSERT_EQ(actual_html, expected_html);
 }
 
+TEST(Document_Generation, call_depth_exceeded)
+{
+    constexpr auto source = u8R"(\cowel_macro("self"){\self}\self)"sv;
+
+    Global_Memory_Resource memory;
+    ast::Pmr_Vector<ast::Markup_Element> content { &memory };
+
+    Builtin_Directive_Set directives;
+    Collecting_Logger logger { &memory };
+
+    const bool parse_success = lex_and_parse_and_build(
+        content, source, File_Id::main, &memory, Parse_Error_Logger { logger }
+    );
+    ASSERT_TRUE(parse_success);
+
+    const Generation_Options options {
+        .error_behavior = &directives.get_error_behavior(),
+        .highlight_theme_source = u8""sv,
+        .builtin_name_resolver = directives,
+        .logger = logger,
+        .highlighter = ulight_syntax_highlighter,
+        .max_call_depth = 32,
+        .memory = &memory,
+    };
+    Vector_Text_Sink sink { Output_Language::html, &memory };
+    const Processing_Status status = run_generation(
+        [&](Context& context) -> Processing_Status {
+            return write_empty_head_document(sink, content, context);
+        },
+        options
+    );
+
+    EXPECT_EQ(status, Processing_Status::fatal);
+    EXPECT_TRUE(logger.was_logged(diagnostic::call_depth));
+}
+
+/// @brief Generates a document which is large enough to be written in multiple chunks,
+/// and returns the output of the result.
+[[nodiscard]]
+std::u8string generate_large_document(
+    cowel_write_fn_u8* write,
+    const void* write_data,
+    cowel_write_slices_fn_u8* write_slices,
+    const void* write_slices_data
+)
+{
+    std::u8string source = u8"\\h1{Heading}\n";
+    for (int i = 0; i < 5000; ++i) {
+        source += u8"Some text & <more> text in a paragraph.\n\n"sv;
+    }
+
+    const cowel_options_u8 options {
+        .source = as_cowel_string_view(source),
+        .highlight_theme_json = {},
+        .mode = COWEL_MODE_DOCUMENT,
+        .flags = COWEL_GEN_FLAGS_NONE,
+        .min_log_severity = COWEL_SEVERITY_MAX,
+        .preserved_variables = nullptr,
+        .preserved_variables_size = 0,
+        .consume_variables = nullptr,
+        .consume_variables_data = nullptr,
+        .alloc = nullptr,
+        .alloc_data = nullptr,
+        .free = nullptr,
+        .free_data = nullptr,
+        .load_file = nullptr,
+        .load_file_data = nullptr,
+        .log = nullptr,
+        .log_data = nullptr,
+        .highlighter = nullptr,
+        .highlight_policy = COWEL_SYNTAX_HIGHLIGHT_POLICY_FALL_BACK,
+        .preamble = {},
+        .load_cache = nullptr,
+        .load_cache_data = nullptr,
+        .store_cache = nullptr,
+        .store_cache_data = nullptr,
+        .max_call_depth = 0,
+        .write = write,
+        .write_data = write_data,
+        .write_slices = write_slices,
+        .write_slices_data = write_slices_data,
+    };
+    cowel_gen_result_u8 result = cowel_generate_html_u8(&options);
+    EXPECT_EQ(result.status, COWEL_PROCESSING_OK);
+    std::u8string output { result.output.text, result.output.length };
+    cowel_free_gen_result_u8(&options, &result);
+    return output;
+}
+
+TEST(Document_Generation, streaming_output)
+{
+    const std::u8string expected = generate_large_document(nullptr, nullptr, nullptr, nullptr);
+
+    std::u8string streamed;
+    std::size_t chunks = 0;
+    const auto write_lambda = [&](const cowel_string_view_u8 text) noexcept {
+        EXPECT_NE(text.length, 0u);
+        streamed.append(text.text, text.length);
+        ++chunks;
+    };
+    const Function_Ref<void(cowel_string_view_u8) noexcept> write = write_lambda;
+    const std::u8string unused_output
+        = generate_large_document(write.get_invoker(), write.get_entity(), nullptr, nullptr);
+
+    EXPECT_TRUE(unused_output.empty());
+    EXPECT_GT(chunks, 1u);
+    EXPECT_EQ(streamed, expected);
+}
+
+TEST(Document_Generation, sliced_output)
+{
+    const std::u8string expected = generate_large_document(nullptr, nullptr, nullptr, nullptr);
+
+    std::u8string gathered;
+    std::size_t calls = 0;
+    const auto write_slices_lambda
+        = [&](const cowel_string_view_u8* slices, const std::size_t slices_size) noexcept {
+              ++calls;
+              for (std::size_t i = 0; i < slices_size; ++i) {
+                  EXPECT_NE(slices[i].length, 0u);
+                  gathered.append(slices[i].text, slices[i].length);
+              }
+          };
+    const Function_Ref<void(const cowel_string_view_u8*, std::size_t) noexcept> write_slices
+        = write_slices_lambda;
+    const std::u8string unused_output = generate_large_document(
+        nullptr, nullptr, write_slices.get_invoker(), write_slices.get_entity()
+    );
+
+    EXPECT_TRUE(unused_output.empty());
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(gathered, expected);
+}
+
 TEST(Document_Generation, documentation)
 {
     constexpr auto html_path = u8"docs/index.html"sv;
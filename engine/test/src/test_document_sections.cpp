@@ -0,0 +1,179 @@
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "cowel/util/char_sequence.hpp"
+#include "cowel/util/html_writer.hpp"
+
+#include "cowel/document_sections.hpp"
+#include "cowel/fwd.hpp"
+#include "cowel/output_language.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+TEST(Document_Sections, ids_are_dense)
+{
+    Document_Sections sections { std::pmr::get_default_resource() };
+    EXPECT_EQ(sections.size(), 1u);
+    EXPECT_EQ(sections.current_id(), Section_Id(0));
+    EXPECT_EQ(sections.current_name(), u8""sv);
+
+    const Section_Id a = sections.make(u8"a"sv);
+    const Section_Id b = sections.intern(u8"b"sv);
+    EXPECT_EQ(a, Section_Id(1));
+    EXPECT_EQ(b, Section_Id(2));
+    EXPECT_EQ(sections.make(u8"a"sv), a);
+    EXPECT_EQ(sections.intern(u8"b"sv), b);
+    EXPECT_EQ(sections.size(), 3u);
+    EXPECT_EQ(sections.get_name(b), u8"b"sv);
+}
+
+TEST(Document_Sections, intern_does_not_make)
+{
+    Document_Sections sections { std::pmr::get_default_resource() };
+    const Section_Id id = sections.intern(u8"x"sv);
+    EXPECT_EQ(sections.try_get(id), nullptr);
+    EXPECT_EQ(sections.find(u8"x"sv), std::nullopt);
+
+    sections.make(id);
+    EXPECT_NE(sections.try_get(id), nullptr);
+    EXPECT_EQ(sections.find(u8"x"sv), id);
+}
+
+TEST(Document_Sections, unassigned_ids)
+{
+    Document_Sections sections { std::pmr::get_default_resource() };
+    const Section_Id unassigned = Section_Id(sections.size());
+    EXPECT_FALSE(sections.contains(unassigned));
+    EXPECT_EQ(sections.try_get(unassigned), nullptr);
+    EXPECT_EQ(std::as_const(sections).try_get(Section_Id(100'000)), nullptr);
+
+    EXPECT_EQ(sections.intern(u8"x"sv), unassigned);
+    EXPECT_TRUE(sections.contains(unassigned));
+}
+
+TEST(Document_Sections, intern_joined_parts)
+{
+    Document_Sections sections { std::pmr::get_default_resource() };
+    const Section_Id id = sections.make(u8"std.bib.N5008"sv);
+
+    const std::u8string_view parts[] { u8"std.bib"sv, u8"."sv, u8"N5008"sv };
+    EXPECT_EQ(sections.intern(parts), id);
+    EXPECT_EQ(sections.size(), 2u);
+
+    const std::u8string_view other_parts[] { u8"std.bib"sv, u8"."sv, u8"N5009"sv };
+    const Section_Id other = sections.intern(other_parts);
+    EXPECT_EQ(other, Section_Id(2));
+    EXPECT_EQ(sections.get_name(other), u8"std.bib.N5009"sv);
+    EXPECT_EQ(sections.try_get(other), nullptr);
+}
+
+TEST(Document_Sections, go_to_scoped)
+{
+    Document_Sections sections { std::pmr::get_default_resource() };
+    const Section_Id root = sections.current_id();
+    {
+        const auto scope = sections.go_to_scoped(u8"x"sv);
+        EXPECT_EQ(sections.current_name(), u8"x"sv);
+        sections.current_policy().write(u8"text"sv, Output_Language::html);
+    }
+    EXPECT_EQ(sections.current_id(), root);
+    EXPECT_EQ(sections.get(*sections.find(u8"x"sv)).text(), u8"text"sv);
+}
+
+TEST(Section_Content, references_are_recorded)
+{
+    Section_Content section { std::pmr::get_default_resource() };
+    Content_Policy& out = section.policy();
+
+    out.write(u8"<div>"sv, Output_Language::html);
+    out.write_section_reference(Section_Id(3));
+    out.write(u8"</div><div>"sv, Output_Language::html);
+    out.write_section_reference(Section_Id(100'000));
+    out.write_section_reference(Section_Id(0));
+    out.write(u8"</div>"sv, Output_Language::html);
+
+    EXPECT_EQ(section.text(), u8"<div></div><div></div>"sv);
+    ASSERT_EQ(section.references().size(), 3u);
+    EXPECT_EQ(section.references()[0].offset, 5u);
+    EXPECT_EQ(section.references()[0].section, Section_Id(3));
+    EXPECT_EQ(section.references()[1].offset, 16u);
+    EXPECT_EQ(section.references()[1].section, Section_Id(100'000));
+    EXPECT_EQ(section.references()[2].offset, 16u);
+    EXPECT_EQ(section.references()[2].section, Section_Id(0));
+}
+
+TEST(Section_Content, buffered_text_precedes_reference)
+{
+    Section_Content section { std::pmr::get_default_resource() };
+    {
+        HTML_Writer_Buffer buffer { section.policy(), Output_Language::html };
+        buffer.write(u8"<div>"sv, Output_Language::html);
+        buffer.write_section_reference(Section_Id(1));
+        buffer.write(u8"</div>"sv, Output_Language::html);
+    }
+
+    EXPECT_EQ(section.text(), u8"<div></div>"sv);
+    ASSERT_EQ(section.references().size(), 1u);
+    EXPECT_EQ(section.references()[0].offset, 5u);
+    EXPECT_EQ(section.references()[0].section, Section_Id(1));
+}
+
+TEST(Section_Content, private_use_text_is_kept)
+{
+    Section_Content section { std::pmr::get_default_resource() };
+    Content_Policy& out = section.policy();
+
+    // Text in the Supplementary Private Use Area-A is not mistaken for a reference,
+    // no matter whether it is written as text or as HTML.
+    constexpr std::u8string_view text = u8"a\U000F0001\U000F0002b\U000F0000c\U0010FFFFdé"sv;
+    out.write(text, Output_Language::text);
+    out.write(text, Output_Language::html);
+
+    EXPECT_EQ(section.text(), std::u8string(text) + std::u8string(text));
+    EXPECT_TRUE(section.references().empty());
+}
+
+TEST(Captured_HTML, write_to)
+{
+    Captured_HTML captured { std::pmr::get_default_resource() };
+    {
+        Capturing_HTML_Sink sink { captured };
+        sink.write_section_reference(Section_Id(1));
+        sink.write(u8"\nab"sv, Output_Language::html);
+        sink.write_section_reference(Section_Id(2));
+        sink.write(u8"c\n"sv, Output_Language::html);
+        sink.write_section_reference(Section_Id(3));
+    }
+    EXPECT_EQ(captured.str(), u8"\nabc\n"sv);
+
+    Section_Content whole { std::pmr::get_default_resource() };
+    captured.write_to(whole.policy());
+    EXPECT_EQ(whole.text(), u8"\nabc\n"sv);
+    ASSERT_EQ(whole.references().size(), 3u);
+    EXPECT_EQ(whole.references()[0].offset, 0u);
+    EXPECT_EQ(whole.references()[1].offset, 3u);
+    EXPECT_EQ(whole.references()[2].offset, 5u);
+
+    // References outside the written range are moved to its boundaries.
+    Section_Content trimmed { std::pmr::get_default_resource() };
+    captured.write_to(trimmed.policy(), 1, 4);
+    EXPECT_EQ(trimmed.text(), u8"abc"sv);
+    ASSERT_EQ(trimmed.references().size(), 3u);
+    EXPECT_EQ(trimmed.references()[0].offset, 0u);
+    EXPECT_EQ(trimmed.references()[0].section, Section_Id(1));
+    EXPECT_EQ(trimmed.references()[1].offset, 2u);
+    EXPECT_EQ(trimmed.references()[1].section, Section_Id(2));
+    EXPECT_EQ(trimmed.references()[2].offset, 3u);
+    EXPECT_EQ(trimmed.references()[2].section, Section_Id(3));
+}
+
+} // namespace
+} // namespace cowel
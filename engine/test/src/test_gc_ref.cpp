@@ -405,5 +405,122 @@ TEST(GC_Node, add_reference_skips_when_zero)
     EXPECT_EQ(node.reference_count, 0u);
 }
 
+TEST(GC_Node, drop_reference_skips_immortal)
+{
+    GC_Node node {
+        .reference_count = 0,
+        .extent = 0,
+        .allocation_size = 0,
+        .allocation_alignment = 0,
+        .destructor = {},
+        .immortal = true,
+    };
+    EXPECT_EQ(node.drop_reference(), 0u);
+    EXPECT_EQ(node.reference_count, 0u);
+}
+
+// =============================================================================
+// GC_Arena
+// =============================================================================
+
+TEST(GC_Arena, refs_do_not_count_references)
+{
+    int live = 0;
+    GC_Arena arena;
+    {
+        const GC_Ref<Tracked> a = arena.make<Tracked>(live, 1);
+        EXPECT_EQ(a.unsafe_get_node()->reference_count, 0u);
+        EXPECT_TRUE(a.unsafe_get_node()->immortal);
+        {
+            const GC_Ref<Tracked> b = a; // NOLINT(performance-unnecessary-copy-initialization)
+            EXPECT_EQ(b.unsafe_get_node()->reference_count, 0u);
+            EXPECT_EQ(b->id, 1);
+        }
+        EXPECT_EQ(live, 1);
+    }
+    // Dropping all references does not destroy arena-owned objects.
+    EXPECT_EQ(live, 1);
+}
+
+TEST(GC_Arena, destroys_objects_on_release)
+{
+    int live = 0;
+    {
+        GC_Arena arena;
+        {
+            const GC_Ref<Tracked> a = arena.make<Tracked>(live, 1);
+            const GC_Ref<Tracked> b = arena.make<Tracked>(live, 2);
+            const GC_Ref<int> c = arena.make<int>(3);
+            EXPECT_EQ(live, 2);
+            EXPECT_EQ(*c, 3);
+        }
+        arena.release();
+        EXPECT_EQ(live, 0);
+
+        // The arena remains usable after being released.
+        const GC_Ref<Tracked> d = arena.make<Tracked>(live, 4);
+        EXPECT_EQ(live, 1);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+// =============================================================================
+// GC_Heap
+// =============================================================================
+
+TEST(GC_Heap, scoped_heap_is_used_for_allocation)
+{
+    GC_Heap heap;
+    GC_Heap& previous = get_gc_heap();
+    {
+        const Scoped_GC_Heap scope { heap };
+        EXPECT_EQ(&get_gc_heap(), &heap);
+
+        const GC_Ref<int> ref = gc_ref_make<int>(123);
+        EXPECT_EQ(ref.unsafe_get_node()->heap, &heap);
+    }
+    EXPECT_EQ(&get_gc_heap(), &previous);
+}
+
+TEST(GC_Heap, statistics)
+{
+    int live = 0;
+    GC_Heap heap;
+    const Scoped_GC_Heap scope { heap };
+    {
+        const GC_Ref<Tracked> a = gc_ref_make<Tracked>(live, 1);
+        const std::vector<int> values { 1, 2, 3 };
+        const GC_Ref<int> b = gc_ref_from_range<int>(values);
+
+        const GC_Heap_Statistics& statistics = heap.get_statistics();
+        EXPECT_EQ(statistics.live_nodes, 2u);
+        EXPECT_EQ(statistics.total_nodes, 2u);
+        EXPECT_EQ(
+            statistics.live_bytes,
+            a.unsafe_get_node()->allocation_size + b.unsafe_get_node()->allocation_size
+        );
+    }
+    const GC_Heap_Statistics& statistics = heap.get_statistics();
+    EXPECT_EQ(live, 0);
+    EXPECT_EQ(statistics.live_nodes, 0u);
+    EXPECT_EQ(statistics.live_bytes, 0u);
+    EXPECT_EQ(statistics.total_nodes, 2u);
+    EXPECT_GT(statistics.peak_live_bytes, 0u);
+}
+
+TEST(GC_Heap, nodes_are_freed_into_their_own_heap)
+{
+    GC_Heap outer;
+    GC_Heap inner;
+    const Scoped_GC_Heap outer_scope { outer };
+    GC_Ref<int> ref = gc_ref_make<int>(1);
+    {
+        const Scoped_GC_Heap inner_scope { inner };
+        ref.reset();
+    }
+    EXPECT_EQ(outer.get_statistics().live_nodes, 0u);
+    EXPECT_EQ(inner.get_statistics().total_nodes, 0u);
+}
+
 } // namespace
 } // namespace cowel
@@ -2,10 +2,12 @@
 #include <cstddef>
 #include <memory_resource>
 #include <span>
+#include <string>
 #include <string_view>
 
 #include <gtest/gtest.h>
 
+#include "cowel/util/html.hpp"
 #include "cowel/util/html_entities.hpp"
 #include "cowel/util/html_writer.hpp"
 
@@ -54,6 +56,20 @@ TEST_F(HTML_Writer_Test, inner_text)
     EXPECT_EQ(expected, as_view(*out));
 }
 
+TEST_F(HTML_Writer_Test, inner_text_long)
+{
+    constexpr std::u8string_view expected
+        = u8"0123456789abcdefghijklmnopqrstuvwxyz&lt;0123456789abcdefghijklmnopqrstuvwxyz&gt;"
+          u8"&amp;&amp;0123456789abcdefghijklmnopqrstuvwxyz"sv;
+
+    writer.write_inner_text(
+        u8"0123456789abcdefghijklmnopqrstuvwxyz<0123456789abcdefghijklmnopqrstuvwxyz>"
+        u8"&&0123456789abcdefghijklmnopqrstuvwxyz"sv
+    );
+
+    EXPECT_EQ(expected, as_view(*out));
+}
+
 TEST_F(HTML_Writer_Test, tag)
 {
     constexpr std::u8string_view expected = u8"<b>Hello, world!</b>"sv;
@@ -139,6 +155,27 @@ TEST_F(HTML_Writer_Test, attributes_escape)
     EXPECT_EQ(expected, as_view(*out));
 }
 
+TEST(HTML_Escape, charset_matches_predicate)
+{
+    // The escaped character is moved across every position of a text that spans
+    // multiple blocks of SIMD registers, so that every offset within a block is covered.
+    for (std::size_t i = 0; i < 100; ++i) {
+        std::u8string text(100, u8'x');
+        text[i] = u8'<';
+        text[99 - i] = u8'&';
+
+        std::u8string expected;
+        U8String_Consumer expected_out { expected };
+        append_html_escaped(expected_out, text, [](char8_t c) { return c == u8'<' || c == u8'&'; });
+
+        std::u8string actual;
+        U8String_Consumer actual_out { actual };
+        append_html_escaped_of(actual_out, text, u8"<&"sv);
+
+        EXPECT_EQ(actual, expected);
+    }
+}
+
 TEST(HTML_Entities, empty)
 {
     constexpr std::array<char32_t, 2> expected {};
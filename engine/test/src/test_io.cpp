@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cowel/util/io.hpp"
+#include "cowel/util/result.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+[[nodiscard]]
+std::u8string read_all(std::FILE* file)
+{
+    std::rewind(file);
+    std::u8string result;
+    char8_t buffer[BUFSIZ];
+    while (const std::size_t read = std::fread(buffer, 1, sizeof(buffer), file)) {
+        result.append(buffer, read);
+    }
+    return result;
+}
+
+TEST(IO, write_gathered_empty)
+{
+    const Unique_File file { std::tmpfile() };
+    ASSERT_TRUE(file);
+
+    EXPECT_TRUE(write_gathered(file.get(), {}));
+    const std::u8string_view pieces[] { u8""sv, u8""sv };
+    EXPECT_TRUE(write_gathered(file.get(), pieces));
+
+    EXPECT_EQ(read_all(file.get()), u8""sv);
+}
+
+TEST(IO, write_gathered_many_pieces)
+{
+    const Unique_File file { std::tmpfile() };
+    ASSERT_TRUE(file);
+
+    // This exceeds the number of buffers that can be passed to the operating system at once,
+    // so the pieces have to be written in multiple batches.
+    // Every third piece is empty, which must not count towards that limit or stall progress.
+    constexpr std::size_t piece_count = 5000;
+    std::vector<std::u8string> storage;
+    storage.reserve(piece_count);
+    std::vector<std::u8string_view> pieces;
+    pieces.reserve(piece_count);
+    std::u8string expected;
+    for (std::size_t i = 0; i < piece_count; ++i) {
+        const std::size_t length = i % 3 == 0 ? 0 : (i % 17) + 1;
+        storage.emplace_back(length, char8_t(u8'a' + (i % 26)));
+        pieces.push_back(storage.back());
+        expected += storage.back();
+    }
+    pieces.emplace_back();
+
+    EXPECT_TRUE(write_gathered(file.get(), pieces));
+    EXPECT_EQ(read_all(file.get()), expected);
+}
+
+TEST(IO, write_gathered_after_buffered_write)
+{
+    const Unique_File file { std::tmpfile() };
+    ASSERT_TRUE(file);
+
+    // Output that is still in the buffer of the FILE has to come first.
+    constexpr std::u8string_view head = u8"head,"sv;
+    ASSERT_EQ(std::fwrite(head.data(), 1, head.size(), file.get()), head.size());
+
+    const std::u8string_view pieces[] { u8"a"sv, u8""sv, u8"bc"sv };
+    EXPECT_TRUE(write_gathered(file.get(), pieces));
+    EXPECT_EQ(read_all(file.get()), u8"head,abc"sv);
+}
+
+TEST(IO, map_file)
+{
+    const std::filesystem::path path
+        = std::filesystem::temp_directory_path() / u8"cowel-test-map-file.bin";
+    const std::u8string path_string = path.generic_u8string();
+
+    constexpr std::u8string_view contents = u8"mapped\0contents"sv;
+    ASSERT_TRUE(bytes_to_file(contents, path_string));
+    {
+        const Result<Mapped_File, IO_Error_Code> mapped = map_file(path_string);
+        ASSERT_TRUE(mapped);
+        const std::span<const std::byte> bytes = mapped->bytes();
+        ASSERT_EQ(bytes.size(), contents.size());
+        EXPECT_EQ(std::memcmp(bytes.data(), contents.data(), contents.size()), 0);
+
+        // Replacing the file by renaming another over it must not affect the mapping.
+        std::filesystem::path replacement = path;
+        replacement += u8".tmp";
+        ASSERT_TRUE(bytes_to_file(u8"other"sv, replacement.generic_u8string()));
+        std::filesystem::rename(replacement, path);
+        EXPECT_EQ(std::memcmp(bytes.data(), contents.data(), contents.size()), 0);
+    }
+
+    ASSERT_TRUE(bytes_to_file(u8""sv, path_string));
+    {
+        const Result<Mapped_File, IO_Error_Code> mapped = map_file(path_string);
+        ASSERT_TRUE(mapped);
+        EXPECT_TRUE(mapped->bytes().empty());
+    }
+
+    std::filesystem::remove(path);
+    const Result<Mapped_File, IO_Error_Code> missing = map_file(path_string);
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error(), IO_Error_Code::cannot_open);
+}
+
+} // namespace
+} // namespace cowel
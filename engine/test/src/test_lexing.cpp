@@ -1,7 +1,10 @@
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <memory_resource>
 #include <optional>
+#include <random>
 #include <span>
 #include <string>
 #include <string_view>
@@ -13,10 +16,12 @@
 #include "cowel/util/annotated_string.hpp"
 #include "cowel/util/ansi.hpp"
 #include "cowel/util/ascii_algorithm.hpp"
+#include "cowel/util/byte_scan.hpp"
 #include "cowel/util/char_sequence_ops.hpp"
 #include "cowel/util/chars.hpp"
 #include "cowel/util/from_chars.hpp"
 #include "cowel/util/io.hpp"
+#include "cowel/util/line_table.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
 #include "cowel/util/tty.hpp"
@@ -116,9 +121,9 @@ std::optional<Lex_Actual> lex_file(
 
     for (std::size_t pos = 0; const auto& token : lex_tokens) {
         const auto* const token_start = result.source.data() + pos;
-        std::pmr::u8string current_text { token_start, token.location.length, memory };
+        std::pmr::u8string current_text { token_start, token.length, memory };
         result.tokens.push_back({ token.kind, std::move(current_text) });
-        pos += token.location.length;
+        pos += token.length;
     }
     return result;
 }
@@ -547,6 +552,149 @@ TEST(Lex, exhaustive_three_chars)
     }
 }
 
+constexpr std::u8string_view long_document_paragraph
+    = u8"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor\n"
+      u8"incididunt ut labore et dolore magna aliqua, as described in \\ref(\"N1234\").\n"
+      u8"Ut enim ad minim veniam, quis \\b{nostrud {exercitation} ullamco} laboris.\n"
+      u8"\n"sv;
+
+/// @brief Returns a prose-heavy document of at least `min_size` bytes,
+/// consisting of repetitions of `long_document_paragraph`.
+[[nodiscard]]
+std::pmr::u8string make_long_document(std::size_t min_size)
+{
+    std::pmr::u8string result;
+    result.reserve(min_size + long_document_paragraph.length());
+    while (result.length() < min_size) {
+        result += long_document_paragraph;
+    }
+    return result;
+}
+
+TEST(Lex, long_document)
+{
+    // Line and column tracking has to remain correct over long inputs,
+    // where most of the text is skipped by the byte scanning kernels.
+    constexpr std::u8string_view paragraph = long_document_paragraph;
+    constexpr std::size_t lines_per_paragraph = 4;
+    // The last token is the text following the closing brace on the third line.
+    constexpr std::size_t last_brace = paragraph.rfind(u8'}');
+    constexpr std::size_t last_token_column = last_brace - paragraph.rfind(u8'\n', last_brace);
+
+    const std::pmr::u8string source = make_long_document(1024 * 1024);
+    const std::size_t paragraph_count = source.length() / paragraph.length();
+
+    std::pmr::vector<Token> tokens;
+    const auto noop = [](std::u8string_view, const Source_Span&, Char_Sequence8) { };
+    ASSERT_TRUE(lex(tokens, source, noop));
+    ASSERT_FALSE(tokens.empty());
+
+    const Line_Table lines { source, std::pmr::get_default_resource() };
+    const Source_Span last = tokens.back().location(lines);
+    EXPECT_EQ(last.end(), source.length());
+    EXPECT_EQ(last.line, (paragraph_count * lines_per_paragraph) - 2);
+    EXPECT_EQ(last.column, last_token_column);
+}
+
+// Measures lexing throughput on large, prose-heavy documents.
+// This is a benchmark rather than a test, so it only runs when requested explicitly
+// with --gtest_also_run_disabled_tests, and the result is recorded as a test property
+// (visible in --gtest_output=xml or json reports).
+TEST(Lex, DISABLED_throughput)
+{
+    const std::pmr::u8string source = make_long_document(64 * 1024 * 1024);
+
+    std::pmr::vector<Token> tokens;
+    const auto noop = [](std::u8string_view, const Source_Span&, Char_Sequence8) { };
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool success = lex(tokens, source, noop);
+    const auto end = std::chrono::steady_clock::now();
+    ASSERT_TRUE(success);
+
+    const auto microseconds
+        = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    // Bytes per microsecond are the same as (decimal) megabytes per second.
+    const auto megabytes_per_second
+        = std::int64_t(source.length()) / std::max(std::int64_t(microseconds), std::int64_t(1));
+
+    const std::u8string_view kernel = byte_scan_kernel_name(default_byte_scan_kernel());
+    RecordProperty("megabytes_per_second", std::to_string(megabytes_per_second));
+    RecordProperty("kernel", std::string(as_string_view(kernel)));
+}
+
+TEST(Lex, tokens_are_compact)
+{
+    static_assert(sizeof(Token) == 16);
+
+    std::pmr::vector<Token> tokens;
+    const auto noop = [](std::u8string_view, const Source_Span&, Char_Sequence8) { };
+    constexpr std::u8string_view source = u8"abc\n\\b{x}\r\n\\c(1)"sv;
+    ASSERT_TRUE(lex(tokens, source, noop));
+
+    const Line_Table lines { source, std::pmr::get_default_resource() };
+    Source_Position expected {};
+    for (const Token& token : tokens) {
+        EXPECT_EQ(token.location(lines), (Source_Span { expected, token.length }));
+        advance(expected, source.substr(token.begin, token.length));
+    }
+    EXPECT_EQ(expected.begin, source.length());
+}
+
+TEST(Line_Table, matches_per_character_advance)
+{
+    static constexpr std::u8string_view alphabet = u8"ab \r\n"sv;
+    std::default_random_engine rng { 12345 };
+    std::uniform_int_distribution<std::size_t> char_distribution { 0, alphabet.length() - 1 };
+    std::uniform_int_distribution<std::size_t> length_distribution { 0, 100 };
+
+    for (int i = 0; i < 1000; ++i) {
+        std::u8string source;
+        const std::size_t length = length_distribution(rng);
+        for (std::size_t j = 0; j < length; ++j) {
+            source += alphabet[char_distribution(rng)];
+        }
+
+        const Line_Table lines { source, std::pmr::get_default_resource() };
+        Source_Position expected {};
+        for (std::size_t offset = 0; offset <= source.length(); ++offset) {
+            ASSERT_EQ(lines.position_at(offset), expected);
+            if (offset < source.length()) {
+                advance(expected, source[offset]);
+            }
+        }
+        EXPECT_EQ(lines.line_count(), expected.line + 1);
+    }
+}
+
+TEST(Line_Table, utf16_columns)
+{
+    // "€" is three UTF-8 code units and one UTF-16 code unit,
+    // "\U0001F600" is four UTF-8 code units and two UTF-16 code units.
+    constexpr std::u8string_view source = u8"a€\U0001F600b\nxy"sv;
+    const Line_Table lines { source, std::pmr::get_default_resource() };
+
+    ASSERT_EQ(lines.line_count(), 2uz);
+    EXPECT_EQ(lines.line_text(source, 0), u8"a€\U0001F600b"sv);
+    EXPECT_EQ(lines.line_text(source, 1), u8"xy"sv);
+
+    EXPECT_EQ(lines.utf16_column_at(source, 0), 0uz);
+    EXPECT_EQ(lines.utf16_column_at(source, 1), 1uz);
+    EXPECT_EQ(lines.utf16_column_at(source, 4), 2uz);
+    EXPECT_EQ(lines.utf16_column_at(source, 8), 4uz);
+    EXPECT_EQ(lines.utf16_column_at(source, 9), 5uz);
+    EXPECT_EQ(lines.utf16_column_at(source, 12), 2uz);
+
+    EXPECT_EQ(lines.offset_at_utf16(source, 0, 2), 4uz);
+    EXPECT_EQ(lines.offset_at_utf16(source, 0, 4), 8uz);
+    EXPECT_EQ(lines.offset_at_utf16(source, 1, 1), 11uz);
+    EXPECT_EQ(lines.offset_at_utf16(source, 5, 0), source.length());
+
+    EXPECT_EQ(lines.offset_at(0, 100), 9uz);
+    EXPECT_EQ(lines.offset_at(1, 2), 12uz);
+    EXPECT_EQ(lines.offset_at(2, 0), source.length());
+}
+
 TEST(Lex, DumpTokensCanRenderColorizedOutput)
 {
     const std::u8string_view source = u8"foo";
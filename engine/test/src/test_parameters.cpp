@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cowel/util/perfect_hash.hpp"
+
+#include "cowel/parameters.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+constexpr Parameter_Declaration test_parameters[] {
+    { u8"x"sv, Optionality::mandatory },
+    { u8"y"sv, Optionality::optional },
+    { u8"content"sv, Optionality::optional },
+};
+constexpr Parameter_Schema test_schema { test_parameters };
+
+TEST(Parameter_Schema, hashes_names)
+{
+    const Parameter_Schema_View schema = test_schema;
+    ASSERT_EQ(schema.size(), 3u);
+    ASSERT_EQ(schema.name_hashes.size(), 3u);
+    for (std::size_t i = 0; i < schema.size(); ++i) {
+        EXPECT_EQ(schema.name_hashes[i], fnv1a_64(schema.declarations[i].name));
+    }
+}
+
+TEST(Parameter_Schema_View, index_of)
+{
+    const Parameter_Schema_View schema = test_schema;
+    EXPECT_EQ(schema.index_of(u8"x"sv), 0u);
+    EXPECT_EQ(schema.index_of(u8"y"sv), 1u);
+    EXPECT_EQ(schema.index_of(u8"content"sv), 2u);
+}
+
+TEST(Parameter_Schema_View, index_of_absent)
+{
+    const Parameter_Schema_View schema = test_schema;
+    EXPECT_EQ(schema.index_of(u8""sv), -1uz);
+    EXPECT_EQ(schema.index_of(u8"z"sv), -1uz);
+    EXPECT_EQ(schema.index_of(u8"X"sv), -1uz);
+    EXPECT_EQ(schema.index_of(u8"conten"sv), -1uz);
+    EXPECT_EQ(schema.index_of(u8"contents"sv), -1uz);
+
+    const Parameter_Schema_View empty {};
+    EXPECT_EQ(empty.index_of(u8"x"sv), -1uz);
+}
+
+TEST(Parameter_Schema_View, index_of_first)
+{
+    const Parameter_Schema_View schema = Parameter_Schema_View(test_schema).first(2);
+    EXPECT_EQ(schema.index_of(u8"x"sv), 0u);
+    EXPECT_EQ(schema.index_of(u8"y"sv), 1u);
+    EXPECT_EQ(schema.index_of(u8"content"sv), -1uz);
+}
+
+TEST(Parameter_Schema_View, index_of_hash_collision)
+{
+    // Real collisions of fnv1a_64 between short identifiers are hard to come by,
+    // so we simulate them by giving every declaration the same hash.
+    const std::uint64_t hash = fnv1a_64(u8"c"sv);
+    const std::uint64_t name_hashes[] { hash, hash, hash };
+    constexpr Parameter_Declaration declarations[] {
+        { u8"a"sv, Optionality::mandatory },
+        { u8"b"sv, Optionality::mandatory },
+        { u8"c"sv, Optionality::mandatory },
+    };
+    const Parameter_Schema_View schema { declarations, name_hashes };
+
+    // The name is compared for every declaration whose hash matches,
+    // so earlier declarations with the same hash are skipped.
+    EXPECT_EQ(schema.index_of(u8"c"sv), 2u);
+    // A colliding name which is not declared is not found.
+    EXPECT_EQ(schema.first(2).index_of(u8"c"sv), -1uz);
+}
+
+} // namespace
+} // namespace cowel
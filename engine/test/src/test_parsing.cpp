@@ -6,6 +6,7 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -14,6 +15,7 @@
 
 #include "cowel/util/annotated_string.hpp"
 #include "cowel/util/from_chars.hpp"
+#include "cowel/util/function_ref.hpp"
 #include "cowel/util/io.hpp"
 #include "cowel/util/result.hpp"
 #include "cowel/util/strings.hpp"
@@ -21,11 +23,14 @@
 
 #include "cowel/diagnostic_highlight.hpp"
 #include "cowel/fwd.hpp"
+#include "cowel/gc.hpp"
 #include "cowel/print.hpp"
+#include "cowel/services.hpp"
 
 #include "diff.hpp"
 
 #include "cowel/syntax/ast.hpp"
+#include "cowel/syntax/ast_cache.hpp"
 #include "cowel/syntax/lex.hpp"
 #include "cowel/syntax/parse.hpp"
 
@@ -908,7 +913,7 @@ Result<Parsed_File, Parse_Error_Stage> parse_file(
         return Parse_Error_Stage::lex;
     }
     if (!parse(
-            result.instructions, result.tokens,
+            result.instructions, result.get_source_string(), result.tokens,
             silence_parse_error ? Parse_Error_Consumer {} : on_error
         )) {
         return Parse_Error_Stage::parse;
@@ -1171,6 +1176,496 @@ TEST(Parse, file_tests)
     EXPECT_TRUE(overall_success);
 }
 
+TEST(Parse, pathological_nesting)
+{
+    // Each of these documents nests constructs which the parser may have to try parsing
+    // in multiple ways, such as a quoted string which could be a member name or a member value.
+    // If any such attempt was repeated for each level of nesting,
+    // parsing would take exponential time.
+    // Rather than measuring time, we count how often the parser advances past a token,
+    // which is only linear in the number of tokens if no such attempt is repeated.
+    struct Nesting {
+        std::u8string_view name;
+        std::u8string_view open;
+        std::u8string_view innermost;
+        std::u8string_view close;
+        std::u8string_view prefix = {};
+        std::u8string_view suffix = {};
+    };
+    static constexpr Nesting nestings[] {
+        { u8"positional strings", u8"\\d(\"", u8"x", u8"\")" },
+        { u8"named strings", u8"\\d(\"n\" = \"", u8"x", u8"\")" },
+        { u8"strings and commas", u8"\\d(\"", u8"x", u8"\", 0)" },
+        { u8"parenthesized strings", u8"\\(\"\\d((\"", u8"x", u8"\" + \"\"))\")" },
+        { u8"groups", u8"(", u8"x", u8", 0)", u8"\\d(", u8")" },
+        { u8"named groups", u8"(n = ", u8"x", u8")", u8"\\d(", u8")" },
+    };
+    // Deep enough for exponential time to be obvious, but within max_nesting_depth,
+    // which the parenthesized strings exhaust at three levels of nesting per repetition.
+    constexpr std::size_t depth = 30;
+    static_assert(3 * depth < max_nesting_depth);
+
+    std::pmr::monotonic_buffer_resource memory;
+    for (const Nesting& nesting : nestings) {
+        std::pmr::u8string source { nesting.prefix, &memory };
+        for (std::size_t i = 0; i < depth; ++i) {
+            source += nesting.open;
+        }
+        source += nesting.innermost;
+        for (std::size_t i = 0; i < depth; ++i) {
+            source += nesting.close;
+        }
+        source += nesting.suffix;
+
+        std::pmr::vector<Token> tokens { &memory };
+        ASSERT_TRUE(lex(tokens, source, {})) << as_string_view(nesting.name);
+
+        std::pmr::vector<CST_Instruction> instructions { &memory };
+        Parse_Statistics statistics;
+        ASSERT_TRUE(parse(instructions, source, tokens, {}, &statistics))
+            << as_string_view(nesting.name);
+        // Every token results in a bounded number of instructions.
+        EXPECT_LE(instructions.size(), 4 * tokens.size()) << as_string_view(nesting.name);
+        // Each token is parsed at most twice, once as part of an attempt that is abandoned,
+        // and once more after backtracking.
+        EXPECT_LE(statistics.tokens_consumed, 2 * tokens.size()) << as_string_view(nesting.name);
+
+        // Parsing incrementally has to produce the same instructions,
+        // just without the surrounding push_document and pop_document.
+        std::pmr::vector<CST_Instruction> incremental { &memory };
+        std::pmr::vector<CST_Instruction> element_buffer { &memory };
+        const auto on_element = [&](std::size_t, std::span<const CST_Instruction> element) {
+            incremental.insert(incremental.end(), element.begin(), element.end());
+        };
+        ASSERT_TRUE(parse_incrementally(element_buffer, source, tokens, on_element))
+            << as_string_view(nesting.name);
+        ASSERT_GE(instructions.size(), 2u);
+        EXPECT_TRUE(std::ranges::equal(
+            std::span(instructions).subspan(1, instructions.size() - 2), incremental
+        )) << as_string_view(nesting.name);
+    }
+}
+
+TEST(Parse, nesting_limit)
+{
+    // Lexing, parsing, and building the AST are recursive,
+    // so nesting beyond max_nesting_depth has to be diagnosed
+    // rather than exhausting the native stack.
+    struct Nesting {
+        std::u8string_view name;
+        std::u8string_view open;
+        std::u8string_view innermost;
+        std::u8string_view close;
+        std::u8string_view prefix = {};
+        std::u8string_view suffix = {};
+    };
+    static constexpr Nesting nestings[] {
+        { u8"blocks", u8"\\d{", u8"x", u8"}" },
+        { u8"strings", u8"\\d(\"", u8"x", u8"\")" },
+        { u8"groups", u8"(", u8"x", u8")", u8"\\d(", u8")" },
+        { u8"parentheses", u8"(", u8"x", u8")", u8"\\(", u8")" },
+        { u8"directive calls", u8"d(", u8"x", u8")", u8"\\(", u8")" },
+        { u8"prefix operators", u8"-", u8"x", u8"", u8"\\(", u8")" },
+        { u8"assignments", u8"x = ", u8"x", u8"", u8"\\(", u8")" },
+        { u8"let-expressions", u8"let x = ", u8"x", u8"", u8"\\(", u8")" },
+    };
+
+    std::pmr::monotonic_buffer_resource memory;
+    const auto nest = [&](const Nesting& nesting, std::size_t depth) {
+        std::pmr::u8string source { nesting.prefix, &memory };
+        for (std::size_t i = 0; i < depth; ++i) {
+            source += nesting.open;
+        }
+        source += nesting.innermost;
+        for (std::size_t i = 0; i < depth; ++i) {
+            source += nesting.close;
+        }
+        source += nesting.suffix;
+        return source;
+    };
+
+    for (const Nesting& nesting : nestings) {
+        const std::pmr::u8string shallow = nest(nesting, max_nesting_depth / 4);
+        ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+        EXPECT_TRUE(lex_and_parse_and_build(tree, shallow, File_Id::main, &memory))
+            << as_string_view(nesting.name);
+
+        std::size_t too_deep_errors = 0;
+        const auto on_error
+            = [&](std::u8string_view /* id */, const Source_Span&, Char_Sequence8 message) {
+                  std::u8string text(message.size(), u8'\0');
+                  message.extract(text);
+                  too_deep_errors += text.ends_with(u8"nested too deeply.");
+              };
+        const std::pmr::u8string deep = nest(nesting, max_nesting_depth + 1);
+        tree.clear();
+        EXPECT_FALSE(lex_and_parse_and_build(tree, deep, File_Id::main, &memory, on_error))
+            << as_string_view(nesting.name);
+        EXPECT_NE(too_deep_errors, 0u) << as_string_view(nesting.name);
+    }
+}
+
+namespace {
+
+using Parse_Test_File_Consumer
+    = Function_Ref<void(std::u8string_view path, std::u8string_view source)>;
+
+/// @brief Invokes `consume` with the path and contents of each COWEL document
+/// in the parse test directory, in lexicographical order of their paths.
+void for_each_parse_test_file(std::pmr::memory_resource* memory, Parse_Test_File_Consumer consume)
+{
+    constexpr auto filter = [](const fs::directory_entry& entry) -> bool {
+        const fs::path& path = entry.path();
+        return path.native().ends_with(".cow") || path.native().ends_with(".cowel");
+    };
+
+    std::pmr::vector<fs::path> test_paths { memory };
+    find_files_recursively(test_paths, "engine/test/files/parse", filter);
+    std::ranges::sort(test_paths);
+
+    for (const fs::path& source_path : test_paths) {
+        const std::u8string path = source_path.generic_u8string();
+        std::pmr::vector<char8_t> source { memory };
+        ASSERT_TRUE(load_utf8_file(source, path)) << as_string_view(path);
+        consume(path, { source.data(), source.size() });
+    }
+}
+
+/// @brief Expects two ASTs which were built from the same source in different ways
+/// to have the same top-level elements.
+void expect_same_top_level_elements(
+    std::span<const ast::Markup_Element> expected,
+    std::span<const ast::Markup_Element> actual,
+    std::u8string_view path
+)
+{
+    ASSERT_EQ(expected.size(), actual.size()) << as_string_view(path);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].index(), actual[i].index());
+        EXPECT_EQ(expected[i].get_source_span(), actual[i].get_source_span());
+        EXPECT_EQ(expected[i].get_source(), actual[i].get_source());
+    }
+}
+
+} // namespace
+
+TEST(Parse_And_Build, incremental_matches_separate_build)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    Parse_Buffers buffers { &memory };
+    for_each_parse_test_file(&memory, [&](std::u8string_view path, std::u8string_view source) {
+        constexpr bool silence_parse_error = true;
+        const Result<Parsed_File, Parse_Error_Stage> parsed
+            = parse_file(path, &memory, silence_parse_error);
+
+        ast::Pmr_Vector<ast::Markup_Element> incremental { &memory };
+        const bool success
+            = lex_and_parse_and_build(incremental, buffers, source, File_Id::main, &memory);
+        ASSERT_EQ(success, bool(parsed)) << as_string_view(path);
+        if (!success) {
+            EXPECT_TRUE(incremental.empty());
+            return;
+        }
+
+        const ast::Pmr_Vector<ast::Markup_Element> expected = build_ast(
+            parsed->get_source_string(), File_Id::main, parsed->tokens, parsed->instructions,
+            &memory
+        );
+        expect_same_top_level_elements(expected, incremental, path);
+    });
+}
+
+TEST(Parse_And_Build, arena_matches_reference_counted_build)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    Parse_Buffers buffers { &memory };
+    for_each_parse_test_file(&memory, [&](std::u8string_view path, std::u8string_view source) {
+        ast::Pmr_Vector<ast::Markup_Element> expected { &memory };
+        const bool success
+            = lex_and_parse_and_build(expected, buffers, source, File_Id::main, &memory);
+
+        GC_Arena arena { &memory };
+        // The AST has to be destroyed before the arena.
+        ast::Pmr_Vector<ast::Markup_Element> actual { arena.get_memory() };
+        ASSERT_EQ(success, lex_and_parse_and_build(actual, buffers, source, File_Id::main, arena))
+            << as_string_view(path);
+        expect_same_top_level_elements(expected, actual, path);
+    });
+}
+
+namespace {
+
+void expect_flat_equal(const Flat_AST& expected, const Flat_AST& actual)
+{
+    EXPECT_EQ(expected.roots, actual.roots);
+    EXPECT_TRUE(std::ranges::equal(expected.element_refs, actual.element_refs));
+    EXPECT_TRUE(std::ranges::equal(expected.directives, actual.directives));
+    EXPECT_TRUE(std::ranges::equal(expected.primaries, actual.primaries));
+    EXPECT_TRUE(std::ranges::equal(expected.members, actual.members));
+    EXPECT_TRUE(std::ranges::equal(expected.expressions, actual.expressions));
+    EXPECT_TRUE(std::ranges::equal(expected.unary_expressions, actual.unary_expressions));
+    EXPECT_TRUE(std::ranges::equal(expected.binary_expressions, actual.binary_expressions));
+    EXPECT_TRUE(std::ranges::equal(expected.let_expressions, actual.let_expressions));
+}
+
+[[nodiscard]]
+File_Source_Span flat_source_span(const Flat_AST& ast, Flat_Ref ref)
+{
+    switch (ref.kind) {
+    case Flat_Node_Kind::directive: return ast.directives[ref.index].span.to_file_span(ast.file);
+    case Flat_Node_Kind::primary: return ast.primaries[ref.index].span.to_file_span(ast.file);
+    case Flat_Node_Kind::expression: return ast.expressions[ref.index].span.to_file_span(ast.file);
+    default: break;
+    }
+    COWEL_ASSERT_UNREACHABLE(u8"Invalid markup element kind.");
+}
+
+} // namespace
+
+TEST(AST_Cache, flatten_inflate_round_trip)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    Parse_Buffers buffers { &memory };
+    for_each_parse_test_file(&memory, [&](std::u8string_view path, std::u8string_view source) {
+        ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+        if (!lex_and_parse_and_build(tree, buffers, source, File_Id::main, &memory)) {
+            return;
+        }
+
+        Flat_AST flat { &memory };
+        flat.source = source;
+        flatten_ast(flat, tree);
+        ASSERT_EQ(tree.size(), flat.roots.size) << as_string_view(path);
+        for (std::size_t i = 0; i < tree.size(); ++i) {
+            const Flat_Ref ref = flat.element_refs[flat.roots.first + i];
+            EXPECT_EQ(tree[i].get_source_span(), flat_source_span(flat, ref));
+        }
+
+        ast::Pmr_Vector<ast::Markup_Element> inflated { &memory };
+        inflate_ast(inflated, flat, &memory);
+        expect_same_top_level_elements(tree, inflated, path);
+
+        // Inflating and flattening again should result in exactly the same flat AST.
+        Flat_AST reflattened { &memory };
+        reflattened.source = source;
+        flatten_ast(reflattened, inflated);
+        expect_flat_equal(flat, reflattened);
+    });
+}
+
+namespace {
+
+struct Memory_AST_Cache final : AST_Cache {
+    std::pmr::unordered_map<std::u8string, std::pmr::vector<std::byte>> entries;
+    std::size_t loads = 0;
+    std::size_t hits = 0;
+
+    [[nodiscard]]
+    explicit Memory_AST_Cache(std::pmr::memory_resource* memory)
+        : entries { memory }
+    {
+    }
+
+    [[nodiscard]]
+    std::span<const std::byte> load(std::u8string_view key) final
+    {
+        ++loads;
+        const auto it = entries.find(std::u8string { key });
+        if (it == entries.end()) {
+            return {};
+        }
+        ++hits;
+        return it->second;
+    }
+
+    void store(std::u8string_view key, std::span<const std::byte> data) final
+    {
+        entries.insert_or_assign(
+            std::u8string { key },
+            std::pmr::vector<std::byte> { data.begin(), data.end(), entries.get_allocator() }
+        );
+    }
+};
+
+} // namespace
+
+TEST(AST_Cache, key)
+{
+    const AST_Cache_Key key = ast_cache_key(u8"\\b{x}");
+    EXPECT_EQ(key.size(), ast_cache_key_length);
+    EXPECT_TRUE(std::ranges::all_of(key.as_string(), [](char8_t c) {
+        return (c >= u8'0' && c <= u8'9') || (c >= u8'a' && c <= u8'f');
+    }));
+    EXPECT_EQ(key.as_string(), ast_cache_key(u8"\\b{x}").as_string());
+    EXPECT_NE(key.as_string(), ast_cache_key(u8"\\b{y}").as_string());
+    EXPECT_NE(key.as_string(), ast_cache_key(u8"").as_string());
+}
+
+TEST(AST_Cache, serialize_round_trip)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    Parse_Buffers buffers { &memory };
+    for_each_parse_test_file(&memory, [&](std::u8string_view path, std::u8string_view source) {
+        ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+        if (!lex_and_parse_and_build(tree, buffers, source, File_Id::main, &memory)) {
+            return;
+        }
+        Flat_AST flat { &memory };
+        flat.source = source;
+        flatten_ast(flat, tree);
+
+        std::pmr::vector<std::byte> bytes { &memory };
+        serialize_flat_ast(bytes, flat);
+        EXPECT_EQ(bytes.size() % 8, 0u) << as_string_view(path);
+
+        Flat_AST deserialized { &memory };
+        deserialized.source = source;
+        ASSERT_TRUE(deserialize_flat_ast(deserialized, bytes)) << as_string_view(path);
+        expect_flat_equal(flat, deserialized);
+
+        // Data for another source or truncated data has to be rejected.
+        std::pmr::u8string longer_source { source, &memory };
+        longer_source += u8' ';
+        deserialized.source = longer_source;
+        EXPECT_FALSE(deserialize_flat_ast(deserialized, bytes));
+        deserialized.source = source;
+        const std::span<const std::byte> truncated { bytes.data(), bytes.size() - 8 };
+        EXPECT_FALSE(deserialize_flat_ast(deserialized, truncated));
+        EXPECT_FALSE(deserialize_flat_ast(deserialized, {}));
+
+        // References to nodes past the end have to be rejected.
+        if (!flat.directives.empty()) {
+            flat.directives.front().arguments = Flat_Index(flat.primaries.size());
+            bytes.clear();
+            serialize_flat_ast(bytes, flat);
+            EXPECT_FALSE(deserialize_flat_ast(deserialized, bytes)) << as_string_view(path);
+        }
+    });
+}
+
+TEST(AST_Cache, rejects_shared_nodes)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    constexpr std::u8string_view source = u8"\\a{x}\\b{y}";
+
+    ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+    ASSERT_TRUE(lex_and_parse_and_build(tree, source, File_Id::main, &memory));
+    Flat_AST flat { &memory };
+    flat.source = source;
+    flatten_ast(flat, tree);
+    ASSERT_EQ(flat.directives.size(), 2u);
+
+    // Making both directives share the same content would turn the AST into a DAG,
+    // and cycles could be created the same way.
+    flat.directives[1].content = flat.directives[0].content;
+    std::pmr::vector<std::byte> bytes { &memory };
+    serialize_flat_ast(bytes, flat);
+    Flat_AST deserialized { &memory };
+    deserialized.source = source;
+    EXPECT_FALSE(deserialize_flat_ast(deserialized, bytes));
+}
+
+TEST(AST_Cache, rejects_corrupted_values)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    constexpr std::u8string_view source = u8"\\x{a\\{}\\(12 + 1.5)";
+
+    ast::Pmr_Vector<ast::Markup_Element> expected_tree { &memory };
+    ASSERT_TRUE(lex_and_parse_and_build(expected_tree, source, File_Id::main, &memory));
+    Flat_AST expected { &memory };
+    expected.source = source;
+    flatten_ast(expected, expected_tree);
+
+    const auto find_primary = [&](ast::Primary_Kind kind) -> std::size_t {
+        const auto it = std::ranges::find(expected.primaries, kind, &Flat_Primary::kind);
+        return std::size_t(it - expected.primaries.begin());
+    };
+    const std::size_t text = find_primary(ast::Primary_Kind::text);
+    const std::size_t escape = find_primary(ast::Primary_Kind::escape);
+    const std::size_t integer = find_primary(ast::Primary_Kind::int_literal);
+    const std::size_t floating = find_primary(ast::Primary_Kind::decimal_float_literal);
+    ASSERT_LT(text, expected.primaries.size());
+    ASSERT_LT(escape, expected.primaries.size());
+    ASSERT_LT(integer, expected.primaries.size());
+    ASSERT_LT(floating, expected.primaries.size());
+
+    // Each of these values is used by inflate_ast to construct an AST node,
+    // so a corrupted cache entry must not make it through deserialization,
+    // and building the AST has to fall back to parsing.
+    const auto expect_rejected = [&](std::size_t index, auto corrupt) {
+        Flat_AST flat = expected;
+        corrupt(flat.primaries[index]);
+        std::pmr::vector<std::byte> bytes { &memory };
+        serialize_flat_ast(bytes, flat);
+
+        Flat_AST deserialized { &memory };
+        deserialized.source = source;
+        EXPECT_FALSE(deserialize_flat_ast(deserialized, bytes));
+
+        Memory_AST_Cache cache { &memory };
+        cache.store(ast_cache_key(source).as_string(), bytes);
+        ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+        Parse_Buffers buffers { &memory };
+        ASSERT_TRUE(lex_and_parse_and_build_cached(
+            tree, buffers, source, nullptr, File_Id::main, &cache, &memory, nullptr
+        ));
+        EXPECT_EQ(cache.hits, 1u);
+        Flat_AST actual { &memory };
+        actual.source = source;
+        flatten_ast(actual, tree);
+        expect_flat_equal(expected, actual);
+    };
+
+    expect_rejected(text, [](Flat_Primary& p) { p.code_point = U'a'; });
+    expect_rejected(escape, [](Flat_Primary& p) { p.code_point = 0xD800; });
+    expect_rejected(escape, [](Flat_Primary& p) { p.code_point = 0x110000; });
+    expect_rejected(escape, [](Flat_Primary& p) {
+        ++p.span.begin;
+        --p.span.length;
+    });
+    expect_rejected(integer, [](Flat_Primary& p) { p.span.length += 2; });
+    expect_rejected(integer, [](Flat_Primary& p) {
+        p.kind = ast::Primary_Kind::decimal_float_literal;
+    });
+    expect_rejected(floating, [](Flat_Primary& p) { p.kind = ast::Primary_Kind::int_literal; });
+    expect_rejected(floating, [](Flat_Primary& p) { --p.span.begin; });
+}
+
+TEST(AST_Cache, cached_build_matches_parse)
+{
+    std::pmr::monotonic_buffer_resource memory;
+    constexpr std::u8string_view source = u8"\\a[x = 1, 2, ...]{y \\b{z}} text \\(1 + -2)";
+
+    ast::Pmr_Vector<ast::Markup_Element> expected_tree { &memory };
+    ASSERT_TRUE(lex_and_parse_and_build(expected_tree, source, File_Id::main, &memory));
+    Flat_AST expected { &memory };
+    expected.source = source;
+    flatten_ast(expected, expected_tree);
+
+    Memory_AST_Cache cache { &memory };
+    Parse_Buffers buffers { &memory };
+    for (int i = 0; i < 2; ++i) {
+        ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+        ASSERT_TRUE(lex_and_parse_and_build_cached(
+            tree, buffers, source, nullptr, File_Id::main, &cache, &memory, nullptr
+        ));
+        Flat_AST actual { &memory };
+        actual.source = source;
+        flatten_ast(actual, tree);
+        expect_flat_equal(expected, actual);
+    }
+    EXPECT_EQ(cache.entries.size(), 1u);
+    EXPECT_EQ(cache.loads, 2u);
+    EXPECT_EQ(cache.hits, 1u);
+
+    // Documents with syntax errors are never stored.
+    ast::Pmr_Vector<ast::Markup_Element> tree { &memory };
+    EXPECT_FALSE(lex_and_parse_and_build_cached(
+        tree, buffers, u8"\\a{", nullptr, File_Id::main, &cache, &memory, nullptr
+    ));
+    EXPECT_EQ(cache.entries.size(), 1u);
+}
+
 TEST(Parse_And_Build, empty)
 {
     static std::pmr::monotonic_buffer_resource memory;
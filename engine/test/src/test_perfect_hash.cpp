@@ -0,0 +1,78 @@
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cowel/util/html_entities.hpp"
+#include "cowel/util/perfect_hash.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+constexpr std::u8string_view fruits[] {
+    u8"apple"sv, u8"banana"sv, u8"cherry"sv, u8"date"sv, u8""sv, u8"elderberry"sv, u8"fig"sv,
+};
+
+constexpr Perfect_Hash_Table fruits_table { fruits };
+
+static_assert(fruits_table.find(u8"cherry") == fruits + 2);
+static_assert(fruits_table.find(u8"grape") == nullptr);
+
+struct Entry {
+    std::u8string_view name;
+    int value;
+};
+
+constexpr Entry entries_with_duplicates[] {
+    { u8"x"sv, 0 }, { u8"y"sv, 1 }, { u8"x"sv, 2 }, { u8"z"sv, 3 }, { u8"y"sv, 4 },
+};
+
+constexpr Perfect_Hash_Table entries_table { entries_with_duplicates, &Entry::name };
+
+TEST(Perfect_Hash, finds_all_keys)
+{
+    for (const std::u8string_view& fruit : fruits) {
+        EXPECT_EQ(fruits_table.find(fruit), &fruit);
+    }
+}
+
+TEST(Perfect_Hash, rejects_other_keys)
+{
+    EXPECT_EQ(fruits_table.find(u8"appl"), nullptr);
+    EXPECT_EQ(fruits_table.find(u8"apples"), nullptr);
+    EXPECT_EQ(fruits_table.find(u8"Apple"), nullptr);
+    EXPECT_EQ(fruits_table.find(std::u8string_view { u8"fig\0", 4 }), nullptr);
+
+    for (std::size_t i = 0; i < 1000; ++i) {
+        const std::u8string key = u8"key" + std::u8string(i % 10, u8'a') + char8_t(i);
+        EXPECT_EQ(fruits_table.find(key), nullptr);
+    }
+}
+
+TEST(Perfect_Hash, duplicates_find_first)
+{
+    EXPECT_EQ(entries_table.find(u8"x")->value, 0);
+    EXPECT_EQ(entries_table.find(u8"y")->value, 1);
+    EXPECT_EQ(entries_table.find(u8"z")->value, 3);
+    EXPECT_EQ(entries_table.find(u8"w"), nullptr);
+}
+
+TEST(Perfect_Hash, html_character_references)
+{
+    for (const std::u8string_view name : html_character_names) {
+        EXPECT_FALSE(string_by_character_reference_name(name).empty());
+    }
+    // Legacy references such as "sup" without a trailing semicolon are listed multiple times;
+    // the first one has to be found.
+    EXPECT_EQ(string_by_character_reference_name(u8"sup"), U"²");
+    EXPECT_EQ(string_by_character_reference_name(u8"amp"), U"&");
+    EXPECT_EQ(string_by_character_reference_name(u8"caps"), U"∩︀");
+    EXPECT_EQ(string_by_character_reference_name(u8"ampp"), U"");
+    EXPECT_EQ(string_by_character_reference_name(u8""), U"");
+}
+
+} // namespace
+} // namespace cowel
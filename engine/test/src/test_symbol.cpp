@@ -0,0 +1,71 @@
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cowel/fwd.hpp"
+#include "cowel/symbol.hpp"
+
+using namespace std::string_view_literals;
+
+namespace cowel {
+namespace {
+
+TEST(Symbol_Table, intern_is_idempotent)
+{
+    Symbol_Table symbols { std::pmr::get_default_resource() };
+    const Symbol x = symbols.intern(u8"x"sv);
+    const Symbol y = symbols.intern(u8"y"sv);
+    EXPECT_NE(x, y);
+    EXPECT_EQ(symbols.intern(u8"x"sv), x);
+    EXPECT_EQ(symbols.intern(u8"y"sv), y);
+    EXPECT_EQ(symbols.size(), 2u);
+}
+
+TEST(Symbol_Table, find_does_not_intern)
+{
+    Symbol_Table symbols { std::pmr::get_default_resource() };
+    EXPECT_EQ(symbols.find(u8"x"sv), std::nullopt);
+    EXPECT_EQ(symbols.size(), 0u);
+
+    const Symbol x = symbols.intern(u8"x"sv);
+    EXPECT_EQ(symbols.find(u8"x"sv), x);
+    EXPECT_EQ(symbols.find(u8"xx"sv), std::nullopt);
+}
+
+TEST(Symbol_Table, names_are_copied)
+{
+    Symbol_Table symbols { std::pmr::get_default_resource() };
+    std::u8string name = u8"awoo";
+    const Symbol awoo = symbols.intern(name);
+    name = u8"xxxx";
+    EXPECT_EQ(symbols.get_name(awoo), u8"awoo"sv);
+    EXPECT_EQ(symbols.find(u8"awoo"sv), awoo);
+    EXPECT_EQ(symbols.find(u8"xxxx"sv), std::nullopt);
+    EXPECT_EQ(symbols.get_name(symbols.intern(u8""sv)), u8""sv);
+}
+
+TEST(Symbol_Table, intern_joined_parts)
+{
+    Symbol_Table symbols { std::pmr::get_default_resource() };
+    const Symbol xy = symbols.intern(u8"x.y"sv);
+
+    const std::u8string_view parts[] { u8"x"sv, u8"."sv, u8"y"sv };
+    EXPECT_EQ(symbols.intern(parts), xy);
+    EXPECT_EQ(symbols.size(), 1u);
+
+    const std::u8string_view other_parts[] { u8"x"sv, u8""sv, u8"z"sv };
+    const Symbol xz = symbols.intern(other_parts);
+    EXPECT_NE(xz, xy);
+    EXPECT_EQ(symbols.get_name(xz), u8"xz"sv);
+    // The joined name does not refer to the buffer in which the parts were joined.
+    EXPECT_EQ(symbols.intern(parts), xy);
+    EXPECT_EQ(symbols.get_name(xz), u8"xz"sv);
+    EXPECT_EQ(symbols.intern(std::span<const std::u8string_view> {}), symbols.intern(u8""sv));
+}
+
+} // namespace
+} // namespace cowel
@@ -1,5 +1,8 @@
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -7,6 +10,7 @@
 
 #include "cowel/util/strings.hpp"
 
+#include "cowel/gc.hpp"
 #include "cowel/regexp.hpp"
 #include "cowel/type.hpp"
 #include "cowel/value.hpp"
@@ -84,6 +88,92 @@ TEST(Value, string)
     EXPECT_FALSE(dynamic_string.is_static_string());
 
     EXPECT_EQ(static_string, dynamic_string);
+
+}
+
+TEST(Value, string_inline_boundary)
+{
+    GC_Heap heap;
+    const Scoped_GC_Heap scope { heap };
+
+    // The longest string that is stored inline, and the shortest one that is not.
+    constexpr std::u8string_view inline_max = u8"abcdefghijklmnopqrstuvwx"sv;
+    static_assert(inline_max.size() == Inline_String_Value::max_size_v);
+    const Value inline_string = Value::string(inline_max, String_Kind::ascii);
+    EXPECT_EQ(inline_string.as_string(), inline_max);
+    EXPECT_EQ(inline_string.get_string_length(), inline_max.size());
+    EXPECT_EQ(heap.get_statistics().total_nodes, 0u);
+
+    constexpr std::u8string_view not_inline = u8"abcdefghijklmnopqrstuvwxy"sv;
+    const Value dynamic_string = Value::string(not_inline, String_Kind::ascii);
+    EXPECT_EQ(dynamic_string.as_string(), not_inline);
+    EXPECT_EQ(dynamic_string.get_string_length(), not_inline.size());
+    EXPECT_EQ(heap.get_statistics().total_nodes, 1u);
+
+    // Copying a dynamic string shares its storage.
+    const Value copy = dynamic_string; // NOLINT(performance-unnecessary-copy-initialization)
+    EXPECT_EQ(copy.as_string().data(), dynamic_string.as_string().data());
+    EXPECT_EQ(heap.get_statistics().total_nodes, 1u);
+}
+
+TEST(Value, string_concat)
+{
+    const auto awoo = Value::static_string(u8"awoo"sv, String_Kind::ascii);
+    const Value short_concat = Value::string_concat(awoo, awoo);
+    EXPECT_EQ(short_concat.as_string(), u8"awooawoo"sv);
+    EXPECT_EQ(short_concat.get_string_length(), 8);
+    EXPECT_EQ(short_concat.get_string_kind(), String_Kind::ascii);
+
+    EXPECT_EQ(Value::string_concat(Value::empty_string, awoo).as_string(), u8"awoo"sv);
+    EXPECT_EQ(Value::string_concat(awoo, Value::empty_string).as_string(), u8"awoo"sv);
+
+    const auto unicode = Value::static_string(u8"ü"sv, String_Kind::unicode);
+    EXPECT_EQ(Value::string_concat(awoo, unicode).get_string_kind(), String_Kind::unicode);
+}
+
+TEST(Value, string_concat_accumulate)
+{
+    const auto piece = Value::static_string(u8"0123456789"sv, String_Kind::ascii);
+    std::u8string expected;
+    Value accumulated = Value::empty_string;
+    for (int i = 0; i < 10'000; ++i) {
+        accumulated = Value::string_concat(accumulated, piece);
+        expected += piece.as_string();
+    }
+    EXPECT_EQ(accumulated.get_string_length(), expected.size());
+    EXPECT_EQ(accumulated.get_type(), Type::str);
+    EXPECT_EQ(accumulated.as_string(), expected);
+    // Flattening is cached, so the characters remain stable.
+    EXPECT_EQ(accumulated.as_string().data(), accumulated.as_string().data());
+}
+
+TEST(Value, string_concat_long_pieces)
+{
+    // These pieces are too long to be merged, so every append creates a rope node.
+    constexpr std::size_t piece_count = 20'000;
+    constexpr std::size_t piece_length = 300;
+
+    GC_Heap heap;
+    const Scoped_GC_Heap scope { heap };
+
+    std::u8string expected;
+    Value accumulated = Value::empty_string;
+    std::size_t max_depth = 0;
+    for (std::size_t i = 0; i < piece_count; ++i) {
+        const std::u8string piece(piece_length, char8_t(u8'a' + (i % 26)));
+        accumulated = Value::string_concat(accumulated, Value::string(piece, String_Kind::ascii));
+        expected += piece;
+        max_depth = std::max(max_depth, accumulated.get_rope_depth());
+    }
+    // The rope is kept balanced, so its depth is logarithmic in the amount of pieces,
+    // and rebalancing only revisits recently appended nodes,
+    // so the amount of nodes created is linear in the amount of pieces.
+    EXPECT_LE(max_depth, 48u);
+    EXPECT_LE(heap.get_statistics().total_nodes, 8 * piece_count);
+
+    EXPECT_EQ(accumulated.get_string_length(), expected.size());
+    EXPECT_EQ(accumulated.as_string(), expected);
+    EXPECT_EQ(accumulated.get_rope_depth(), 0u);
 }
 
 // =============================================================================